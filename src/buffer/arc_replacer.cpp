@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ArcReplacer::ArcReplacer(size_t num_frames) : capacity_(num_frames) {}
+
+auto ArcReplacer::PreferT1() const -> bool { return !t1_.empty() && t1_.size() >= std::max<size_t>(p_, 1); }
+
+auto ArcReplacer::FirstEvictable(const std::list<frame_id_t> &list) const -> frame_id_t {
+  for (auto frame_id : list) {
+    if (entries_.at(frame_id).evictable_) {
+      return frame_id;
+    }
+  }
+  return -1;
+}
+
+auto ArcReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  bool from_t1 = PreferT1();
+  frame_id_t victim = FirstEvictable(from_t1 ? t1_ : t2_);
+  if (victim == -1) {
+    from_t1 = !from_t1;
+    victim = FirstEvictable(from_t1 ? t1_ : t2_);
+  }
+  BUSTUB_ASSERT(victim != -1, "evictable frame must exist");
+  auto entry = entries_[victim];
+  (from_t1 ? t1_ : t2_).erase(entry.pos_);
+  entries_.erase(victim);
+  curr_size_--;
+  if (from_t1) {
+    AddGhost(&b1_, &b1_index_, entry.page_id_);
+  } else {
+    AddGhost(&b2_, &b2_index_, entry.page_id_);
+  }
+  TrimGhosts();
+  *frame_id = victim;
+  return true;
+}
+
+void ArcReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  auto it = entries_.find(frame_id);
+  if (it != entries_.end()) {
+    // Hit: the frame has now been seen at least twice and moves to the MRU end of T2.
+    auto &entry = it->second;
+    (entry.in_t2_ ? t2_ : t1_).erase(entry.pos_);
+    entry.in_t2_ = true;
+    entry.pos_ = t2_.insert(t2_.end(), frame_id);
+    return;
+  }
+
+  bool in_t2 = false;
+  if (auto ghost = b1_index_.find(page_id); ghost != b1_index_.end()) {
+    // T1 evicted this page too early: grow its target.
+    p_ = std::min(capacity_, p_ + std::max<size_t>(b2_.size() / b1_.size(), 1));
+    b1_.erase(ghost->second);
+    b1_index_.erase(ghost);
+    in_t2 = true;
+  } else if (auto ghost = b2_index_.find(page_id); ghost != b2_index_.end()) {
+    // T2 evicted this page too early: shrink T1's target.
+    size_t delta = std::max<size_t>(b1_.size() / b2_.size(), 1);
+    p_ = p_ > delta ? p_ - delta : 0;
+    b2_.erase(ghost->second);
+    b2_index_.erase(ghost);
+    in_t2 = true;
+  }
+  auto &list = in_t2 ? t2_ : t1_;
+  entries_[frame_id] = FrameEntry{page_id, in_t2, false, list.insert(list.end(), frame_id)};
+  TrimGhosts();
+}
+
+void ArcReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end() || it->second.evictable_ == set_evictable) {
+    return;
+  }
+  it->second.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  if (!it->second.evictable_) {
+    throw Exception("remove a non-evictable frame");
+  }
+  (it->second.in_t2_ ? t2_ : t1_).erase(it->second.pos_);
+  entries_.erase(it);
+  curr_size_--;
+}
+
+auto ArcReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  bool t1_first = PreferT1();
+  for (const auto *list : {t1_first ? &t1_ : &t2_, t1_first ? &t2_ : &t1_}) {
+    for (auto it = list->begin(); it != list->end() && candidates.size() < max_count; ++it) {
+      if (entries_.at(*it).evictable_) {
+        candidates.push_back(*it);
+      }
+    }
+  }
+  return candidates;
+}
+
+auto ArcReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+void ArcReplacer::AddGhost(std::list<page_id_t> *ghosts,
+                           std::unordered_map<page_id_t, std::list<page_id_t>::iterator> *index, page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || index->count(page_id) != 0) {
+    return;
+  }
+  (*index)[page_id] = ghosts->insert(ghosts->end(), page_id);
+}
+
+void ArcReplacer::TrimGhosts() {
+  while (!b1_.empty() && t1_.size() + b1_.size() > capacity_) {
+    b1_index_.erase(b1_.front());
+    b1_.pop_front();
+  }
+  while (!b2_.empty() && t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_) {
+    b2_index_.erase(b2_.front());
+    b2_.pop_front();
+  }
+}
+
+}  // namespace bustub
@@ -12,48 +12,674 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <new>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+                                                     LogManager *log_manager, ReplacerPolicy policy)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, policy) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerPolicy policy)
+    : pool_size_(pool_size),
+      page_size_(disk_manager->GetPageSize()),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      policy_(policy),
+      replacer_k_(replacer_k),
+      scan_ring_size_(std::max<size_t>(1, std::min(SCAN_RING_SIZE, pool_size / 2))) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
+  // The page data lives in one huge page aligned arena and the frame metadata in a separate array. The shards of a
+  // parallel buffer pool spread over the NUMA nodes of the machine.
+  int num_numa_nodes = FrameArena::NumaNodeCount();
+  int numa_node = num_instances > 1 && num_numa_nodes > 1 ? static_cast<int>(instance_index) % num_numa_nodes : -1;
+  frame_arena_ = new FrameArena(pool_size_, page_size_, true, numa_node);
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_->GetFrame(i), page_size_);
+  }
+  page_table_ = new StripedHashTable<page_id_t, frame_id_t>();
+  replacer_ = MakeFrameReplacer(policy, pool_size, replacer_k);
+
+  // New pages go past the ones already on disk, and past deallocated ones, which are reused through the free page map.
+  auto num_pages = static_cast<page_id_t>(disk_manager_->GetNumPages());
+  auto stride = static_cast<page_id_t>(num_instances_);
+  next_page_id_ = num_pages + (static_cast<page_id_t>(instance_index_) - num_pages % stride + stride) % stride;
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
-
-  // TODO(students): remove this line after you have implemented the buffer pool manager
-  throw NotImplementedException(
-      "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
-      "exception line in `buffer_pool_manager_instance.cpp`.");
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopPageCleaner();
+  StopPrefetcher();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+  delete frame_arena_;
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { return nullptr; }
+auto BufferPoolManagerInstance::TryClaim(Page *page) -> bool {
+  int expected = 0;
+  return page->pin_count_.compare_exchange_strong(expected, -1);
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id) -> bool {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    // A latch-free reader holding a stale frame id may pin a free frame for an instant before backing off.
+    while (!TryClaim(&pages_[*frame_id])) {
+    }
+    return true;
+  }
+  // Hits on the latch-free path only set the reference bit. Report them to the replacer for the frames at the front
+  // of its queue before picking a victim, so that policies keyed on access history see them with that history intact.
+  for (auto candidate : replacer_->EvictionCandidates(REPLACER_REFERENCE_SYNC_BATCH)) {
+    Page *page = &pages_[candidate];
+    if (!page->is_referenced_.exchange(false)) {
+      break;
+    }
+    replacer_->RecordAccess(candidate, page->page_id_);
+  }
+  // Look at the next victim before evicting it. A referenced one has its hit recorded, a pinned one is hidden from
+  // the replacer until a victim is found, so that neither loses its history to an eviction that does not happen. Two
+  // rounds over the replacer are enough to clear every reference bit and see every frame once more.
+  std::vector<frame_id_t> pinned;
+  bool found = false;
+  for (size_t attempts = 2 * replacer_->Size(); attempts > 0 && !found; attempts--) {
+    auto candidates = replacer_->EvictionCandidates(1);
+    if (candidates.empty()) {
+      break;
+    }
+    Page *victim = &pages_[candidates[0]];
+    if (victim->is_referenced_.exchange(false)) {
+      replacer_->RecordAccess(candidates[0], victim->page_id_);
+    } else if (!TryClaim(victim)) {
+      replacer_->SetEvictable(candidates[0], false);
+      pinned.push_back(candidates[0]);
+    } else {
+      found = replacer_->Evict(frame_id);
+      BUSTUB_ASSERT(found && *frame_id == candidates[0], "the replacer must evict its first candidate");
+      EvictPage(victim);
+    }
+  }
+  for (auto pinned_frame_id : pinned) {
+    replacer_->SetEvictable(pinned_frame_id, true);
+  }
+  return found;
+}
+
+auto BufferPoolManagerInstance::AcquireScanFrame(frame_id_t *frame_id) -> bool {
+  while (scan_ring_.size() >= scan_ring_size_) {
+    auto [ring_frame_id, ring_page_id] = scan_ring_.front();
+    scan_ring_.pop_front();
+    Page *victim = &pages_[ring_frame_id];
+    // Frames are only reassigned under latch_, so the page id is stable here. A frame that was reassigned, referenced
+    // by a non-scan access or is still pinned simply leaves the ring and is handled by the replacer from now on.
+    if (victim->page_id_ != ring_page_id || victim->is_referenced_ || !TryClaim(victim)) {
+      continue;
+    }
+    replacer_->Remove(ring_frame_id);
+    EvictPage(victim);
+    *frame_id = ring_frame_id;
+    return true;
+  }
+  return AcquireFrame(frame_id);
+}
+
+void BufferPoolManagerInstance::EvictPage(Page *victim) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  if (victim->IsDirty()) {
+    auto start = std::chrono::steady_clock::now();
+    WriteBackPage(victim);
+    eviction_write_latency_.Record(std::chrono::steady_clock::now() - start);
+    dirty_evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  page_table_->Remove(victim->GetPageId());
+}
+
+void BufferPoolManagerInstance::InstallFrame(frame_id_t frame_id, page_id_t page_id, bool pin,
+                                             AccessType access_type) {
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->is_referenced_ = false;
+  page_table_->Insert(page_id, frame_id);
+  page->pin_count_.store(pin ? 1 : 0);
+  replacer_->RecordAccess(frame_id, page_id);
+  replacer_->SetEvictable(frame_id, true);
+  if (access_type == AccessType::Scan) {
+    scan_ring_.emplace_back(frame_id, page_id);
+  }
+}
+
+void BufferPoolManagerInstance::ReadIntoFrame(frame_id_t frame_id, page_id_t page_id,
+                                              std::unique_lock<std::mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  // The claimed frame is in neither the page table nor the replacer. Without a page id, the walks over all frames
+  // under latch_ (flushing, stats, the page cleaner) skip it too while its data is being overwritten.
+  page->page_id_ = INVALID_PAGE_ID;
+  reads_in_flight_.insert(page_id);
+  lock->unlock();
+  try {
+    WaitForWriteBack(page_id);
+    disk_manager_->ReadPage(page_id, page->GetData());
+  } catch (...) {
+    // Whatever the disk manager throws, the frame and the waiters on this read must not be left behind.
+    lock->lock();
+    reads_in_flight_.erase(page_id);
+    read_cv_.notify_all();
+    page->ResetMemory();
+    page->pin_count_.store(0);
+    free_list_.emplace_back(frame_id);
+    throw;
+  }
+  lock->lock();
+  // The waiters need latch_ to wake up, so they find the page installed by the time they do.
+  reads_in_flight_.erase(page_id);
+  read_cv_.notify_all();
+}
+
+auto BufferPoolManagerInstance::TryPinResident(page_id_t page_id, AccessType access_type) -> Page * {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return nullptr;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // The frame may have been reassigned between the lookup and the pin. Once pinned it cannot change any more, so
+  // checking the page id now is enough.
+  if (page->page_id_ != page_id) {
+    page->pin_count_.fetch_sub(1);
+    return nullptr;
+  }
+  if (access_type != AccessType::Scan) {
+    page->is_referenced_.store(true, std::memory_order_relaxed);
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  return NewPgImp(page_id, AccessType::Unknown, INVALID_PAGE_ID);
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, AccessType access_type, page_id_t near_page_id)
+    -> Page * {
+  std::scoped_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!(access_type == AccessType::Scan ? AcquireScanFrame(&frame_id) : AcquireFrame(&frame_id))) {
+    return nullptr;
+  }
+  *page_id = AllocatePage(near_page_id);
+  [[maybe_unused]] frame_id_t resident_frame_id;
+  BUSTUB_ASSERT(!page_table_->Find(*page_id, resident_frame_id), "a newly allocated page cannot be resident already");
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  InstallFrame(frame_id, *page_id, true, access_type);
+  new_pages_.fetch_add(1, std::memory_order_relaxed);
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgImp(page_id, AccessType::Unknown);
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  if (Page *page = TryPinResident(page_id, access_type); page != nullptr) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return page;
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(latch_);
+  read_cv_.wait(lock, [&] { return reads_in_flight_.count(page_id) == 0; });
+  frame_id_t frame_id;
+  if (page_table_->Find(page_id, frame_id)) {
+    // Frames are only claimed under latch_, so a resident page can be pinned directly here.
+    pages_[frame_id].pin_count_.fetch_add(1);
+    if (access_type != AccessType::Scan) {
+      pages_[frame_id].is_referenced_ = true;
+      replacer_->RecordAccess(frame_id, page_id);
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return &pages_[frame_id];
+  }
+  if (!(access_type == AccessType::Scan ? AcquireScanFrame(&frame_id) : AcquireFrame(&frame_id))) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  ReadIntoFrame(frame_id, page_id, &lock);
+  InstallFrame(frame_id, page_id, true, access_type);
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  miss_latency_.Record(std::chrono::steady_clock::now() - start);
+  return page;
+}
+
+auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  Page *page = &pages_[frame_id];
+  // The caller holds a pin, so the frame cannot be reassigned underneath us. The page id check only guards against
+  // unpinning a page that is no longer pinned at all.
+  if (page->page_id_ != page_id) {
+    return false;
+  }
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+    // Mark dirty before dropping the pin so that whoever evicts the frame afterwards sees the flag.
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  return true;
+}
+
+auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  WriteBackPage(&pages_[frame_id]);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPgsImp() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // One batch, so the disk manager coalesces consecutive pages and flushes or syncs once for the whole pool.
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->GetPageId() != INVALID_PAGE_ID) {
+      WaitForWriteBack(page->GetPageId());
+      page->is_dirty_ = false;
+      batch.emplace_back(page->GetPageId(), page->GetData());
+    }
+  }
+  foreground_writes_ += batch.size();
+  disk_manager_->WritePageBatch(std::move(batch));
+}
+
+auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // A page being read in is about to be pinned by its reader.
+  if (reads_in_flight_.count(page_id) > 0) {
+    return false;
+  }
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    DeallocatePage(page_id);
+    return true;
+  }
+  Page *page = &pages_[frame_id];
+  if (!TryClaim(page)) {
+    return false;
+  }
+  page_table_->Remove(page_id);
+  replacer_->Remove(frame_id);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->is_referenced_ = false;
+  page->pin_count_.store(0);
+  free_list_.emplace_back(frame_id);
+  DeallocatePage(page_id);
+  return true;
+}
+
+auto BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> bool {
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_latch_);
+    for (auto page_id : page_ids) {
+      if (prefetch_queue_.size() >= pool_size_) {
+        break;
+      }
+      prefetch_queue_.emplace_back(page_id, access_type);
+    }
+    if (!prefetcher_running_) {
+      prefetcher_running_ = true;
+      prefetcher_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(prefetch_latch_);
+        while (true) {
+          prefetch_cv_.wait(lock, [this] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+          if (!prefetcher_running_) {
+            return;
+          }
+          auto [page_id, access_type] = prefetch_queue_.front();
+          prefetch_queue_.pop_front();
+          lock.unlock();
+          PrefetchPage(page_id, access_type);
+          lock.lock();
+        }
+      });
+    }
+  }
+  prefetch_cv_.notify_one();
+  return true;
+}
+
+auto BufferPoolManagerInstance::GetStats(BufferPoolStats *stats) -> bool {
+  *stats = BufferPoolStats();
+  stats->pool_size_ = pool_size_;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stats->free_frames_ = free_list_.size();
+    for (size_t i = 0; i < pool_size_; i++) {
+      if (pages_[i].page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      if (pages_[i].GetPinCount() > 0) {
+        stats->pinned_frames_++;
+      }
+      if (pages_[i].IsDirty()) {
+        stats->dirty_frames_++;
+      }
+    }
+  }
+  stats->hits_ = hits_.load(std::memory_order_relaxed);
+  stats->misses_ = misses_.load(std::memory_order_relaxed);
+  stats->new_pages_ = new_pages_.load(std::memory_order_relaxed);
+  stats->evictions_ = evictions_.load(std::memory_order_relaxed);
+  stats->dirty_evictions_ = dirty_evictions_.load(std::memory_order_relaxed);
+  stats->foreground_writes_ = foreground_writes_;
+  stats->background_writes_ = background_writes_;
+  stats->prefetched_pages_ = prefetched_pages_;
+  miss_latency_.AddTo(&stats->miss_latency_);
+  eviction_write_latency_.AddTo(&stats->eviction_write_latency_);
+  return true;
+}
+
+auto BufferPoolManagerInstance::SetReplacerPolicy(ReplacerPolicy policy) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto *replacer = MakeFrameReplacer(policy, pool_size_, replacer_k_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      replacer->RecordAccess(frame_id, pages_[i].page_id_);
+      replacer->SetEvictable(frame_id, true);
+    }
+  }
+  delete replacer_;
+  replacer_ = replacer;
+  policy_ = policy;
+  return true;
+}
+
+auto BufferPoolManagerInstance::GetReplacerPolicy() -> ReplacerPolicy {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return policy_;
+}
+
+auto BufferPoolManagerInstance::IsPageResident(page_id_t page_id) -> bool {
+  frame_id_t frame_id;
+  return page_table_->Find(page_id, frame_id);
+}
+
+void BufferPoolManagerInstance::PrefetchPage(page_id_t page_id, AccessType access_type) {
+  std::unique_lock<std::mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (reads_in_flight_.count(page_id) > 0 || page_table_->Find(page_id, frame_id)) {
+    return;
+  }
+  // A page that was never allocated, or was deallocated since, holds no data. Made resident, it would still be there
+  // when NewPage hands its id out, leaving the page in two frames.
+  if (page_id < 0 || page_id >= next_page_id_ || disk_manager_->IsPageFree(page_id)) {
+    return;
+  }
+  if (access_type == AccessType::Scan ? !AcquireScanFrame(&frame_id) : !AcquireFrame(&frame_id)) {
+    return;
+  }
+  try {
+    ReadIntoFrame(frame_id, page_id, &lock);
+  } catch (...) {
+    // Leave it to whoever fetches the page to see the error. Nothing may escape the prefetch thread.
+    return;
+  }
+  InstallFrame(frame_id, page_id, false, access_type);
+  prefetched_pages_++;
+}
+
+auto BufferPoolManagerInstance::GetResidentPages() -> std::vector<page_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Report the hits taken on the latch-free path first, or pages that are only ever hit would look cold.
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_referenced_.exchange(false)) {
+      replacer_->RecordAccess(static_cast<frame_id_t>(i), pages_[i].page_id_);
+    }
+  }
+  auto candidates = replacer_->EvictionCandidates(pool_size_);
+  std::vector<bool> is_candidate(pool_size_, false);
+  for (auto frame_id : candidates) {
+    is_candidate[frame_id] = true;
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (!is_candidate[i] && pages_[i].GetPageId() != INVALID_PAGE_ID) {
+      page_ids.push_back(pages_[i].GetPageId());
+    }
+  }
+  for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+    page_ids.push_back(pages_[*it].GetPageId());
+  }
+  return page_ids;
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  {
+    std::scoped_lock<std::mutex> lock(prefetch_latch_);
+    if (!prefetcher_running_) {
+      return;
+    }
+    prefetcher_running_ = false;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  prefetcher_.join();
+}
+
+void BufferPoolManagerInstance::WaitForWriteBack(page_id_t page_id) {
+  std::unique_lock<std::mutex> lock(write_back_latch_);
+  write_back_cv_.wait(lock, [&] { return write_back_in_flight_.count(page_id) == 0; });
+}
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return nullptr; }
+void BufferPoolManagerInstance::WriteBackPage(Page *page) {
+  WaitForWriteBack(page->GetPageId());
+  page->is_dirty_ = false;
+  disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  foreground_writes_++;
+}
 
-auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool { return false; }
+void BufferPoolManagerInstance::RunPageCleaner(double target_clean_ratio, size_t max_batch_size) {
+  std::scoped_lock<std::mutex> lock(page_cleaner_latch_);
+  if (page_cleaner_running_) {
+    return;
+  }
+  target_clean_ratio_ = target_clean_ratio;
+  max_batch_size_ = max_batch_size;
+  page_cleaner_running_ = true;
+  page_cleaner_ = std::thread([this] {
+    std::unique_lock<std::mutex> lock(page_cleaner_latch_);
+    while (!page_cleaner_cv_.wait_for(lock, page_cleaner_interval, [this] { return !page_cleaner_running_; })) {
+      lock.unlock();
+      CleanPages();
+      lock.lock();
+    }
+  });
+}
 
-auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool { return false; }
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock<std::mutex> lock(page_cleaner_latch_);
+    if (!page_cleaner_running_) {
+      return;
+    }
+    page_cleaner_running_ = false;
+  }
+  page_cleaner_cv_.notify_all();
+  page_cleaner_.join();
+}
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {}
+auto BufferPoolManagerInstance::CleanPages() -> size_t {
+  std::vector<page_id_t> page_ids;
+  std::vector<char> buffer;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto target_clean = static_cast<size_t>(target_clean_ratio_ * static_cast<double>(pool_size_));
+    size_t clean = free_list_.size();
+    for (size_t i = 0; i < pool_size_; i++) {
+      if (pages_[i].GetPageId() != INVALID_PAGE_ID && pages_[i].GetPinCount() == 0 && !pages_[i].IsDirty()) {
+        clean++;
+      }
+    }
+    if (clean >= target_clean) {
+      return 0;
+    }
+    size_t batch_size = std::min(max_batch_size_, target_clean - clean);
+    buffer.resize(batch_size * page_size_);
+    for (auto frame_id : replacer_->EvictionCandidates(pool_size_)) {
+      if (page_ids.size() == batch_size) {
+        break;
+      }
+      Page *page = &pages_[frame_id];
+      if (!page->IsDirty() || !TryClaim(page)) {
+        continue;
+      }
+      // The claim keeps the page from being pinned, and so from being modified, while it is copied out.
+      memcpy(buffer.data() + page_ids.size() * page_size_, page->GetData(), page_size_);
+      page->is_dirty_ = false;
+      page_ids.push_back(page->GetPageId());
+      page->pin_count_.store(0);
+    }
+    std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+    write_back_in_flight_.insert(page_ids.begin(), page_ids.end());
+  }
 
-auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool { return false; }
+  // Write the copies in page id order, one DiskManager call per run of consecutive page ids. The runs are issued
+  // asynchronously, so a disk manager that supports it has them all in flight at once.
+  std::vector<size_t> order(page_ids.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<char> runs(buffer.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    memcpy(runs.data() + i * page_size_, buffer.data() + order[i] * page_size_, page_size_);
+  }
+  std::vector<std::future<void>> writes;
+  for (size_t begin = 0; begin < order.size();) {
+    size_t end = begin + 1;
+    while (end < order.size() && page_ids[order[end]] == page_ids[order[end - 1]] + 1) {
+      end++;
+    }
+    writes.push_back(
+        disk_manager_->WritePagesAsync(page_ids[order[begin]], runs.data() + begin * page_size_, end - begin));
+    begin = end;
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+  background_writes_ += page_ids.size();
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+  {
+    std::scoped_lock<std::mutex> write_back_lock(write_back_latch_);
+    for (auto page_id : page_ids) {
+      write_back_in_flight_.erase(page_id);
+    }
+  }
+  write_back_cv_.notify_all();
+  return page_ids.size();
+}
+
+auto BufferPoolManagerInstance::AllocatePage(page_id_t near_page_id) -> page_id_t {
+  const auto extent_pages = static_cast<page_id_t>(extent_size_ * num_instances_);
+  bool hinted = extent_size_ > 1 && near_page_id >= 0 &&
+                static_cast<uint32_t>(near_page_id) % num_instances_ == instance_index_;
+  if (hinted) {
+    // A page of the object's extent, a deallocated one first, so that its pages stay together. An object that started
+    // in the shared extent, or filled its extent, gets a new one.
+    const page_id_t first = ExtentOf(near_page_id);
+    page_id_t page_id = INVALID_PAGE_ID;
+    if (first != shared_extent_) {
+      page_id = disk_manager_->AllocatePageIn(num_instances_, instance_index_, first, first + extent_pages);
+    }
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = ReserveExtent();
+    }
+    ValidatePageId(page_id);
+    return page_id;
+  }
+
+  // Without a hint, any deallocated page, then the next page of the shared extent.
+  page_id_t page_id = disk_manager_->AllocatePage(num_instances_, instance_index_, near_page_id);
+  if (page_id == INVALID_PAGE_ID && shared_extent_ != INVALID_PAGE_ID) {
+    page_id = disk_manager_->AllocatePageIn(num_instances_, instance_index_, shared_extent_,
+                                            shared_extent_ + extent_pages);
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    page_id = shared_extent_ = ReserveExtent();
+  }
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+auto BufferPoolManagerInstance::ReserveExtent() -> page_id_t {
+  // Extents start at multiples of the extent size in this instance's own sequence of page ids. The pages skipped to
+  // get there are free, and the rest of the extent is reserved for it in the disk manager.
+  const auto stride = static_cast<page_id_t>(num_instances_);
+  const auto extent_size = static_cast<page_id_t>(extent_size_);
+  page_id_t local = (next_page_id_ - static_cast<page_id_t>(instance_index_)) / stride;
+  local = (local + extent_size - 1) / extent_size * extent_size;
+  const page_id_t first = local * stride + static_cast<page_id_t>(instance_index_);
+  for (page_id_t page_id = next_page_id_; page_id < first; page_id += stride) {
+    disk_manager_->DeallocatePage(page_id);
+  }
+  next_page_id_ = first + extent_size * stride;
+  for (page_id_t page_id = first + stride; page_id < next_page_id_; page_id += stride) {
+    disk_manager_->ReservePage(page_id);
+  }
+  return first;
+}
+
+auto BufferPoolManagerInstance::ExtentOf(page_id_t page_id) const -> page_id_t {
+  const auto stride = static_cast<page_id_t>(num_instances_);
+  const auto extent_size = static_cast<page_id_t>(extent_size_);
+  page_id_t local = (page_id - static_cast<page_id_t>(instance_index_)) / stride;
+  return local / extent_size * extent_size * stride + static_cast<page_id_t>(instance_index_);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
 }  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_mmap.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_mmap.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_mmap.h"
+
+namespace bustub {
+
+BufferPoolManagerMmap::BufferPoolManagerMmap(DiskManagerMmap *disk_manager)
+    : disk_manager_(disk_manager), views_(disk_manager->GetNumMappedPages()) {}
+
+BufferPoolManagerMmap::~BufferPoolManagerMmap() {
+  for (auto &view : views_) {
+    delete view.load();
+  }
+}
+
+auto BufferPoolManagerMmap::FetchPgImp(page_id_t page_id) -> Page * {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= views_.size()) {
+    return nullptr;
+  }
+  auto &view = views_[page_id];
+  Page *page = view.load(std::memory_order_acquire);
+  if (page == nullptr) {
+    // The checksum is verified once, when the view is made. If two threads race to make it, one view is dropped.
+    const char *data = disk_manager_->MapPage(page_id);
+    auto *made = new Page(const_cast<char *>(data), disk_manager_->GetPageSize());
+    made->page_id_ = page_id;
+    if (view.compare_exchange_strong(page, made, std::memory_order_acq_rel)) {
+      page = made;
+    } else {
+      delete made;
+    }
+  }
+  page->pin_count_.fetch_add(1);
+  return page;
+}
+
+auto BufferPoolManagerMmap::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= views_.size()) {
+    return false;
+  }
+  Page *page = views_[page_id].load(std::memory_order_acquire);
+  if (page == nullptr) {
+    return false;
+  }
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  return true;
+}
+
+auto BufferPoolManagerMmap::FlushPgImp(page_id_t page_id) -> bool { return IsPageResident(page_id); }
+
+auto BufferPoolManagerMmap::NewPgImp(page_id_t *page_id) -> Page * {
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+auto BufferPoolManagerMmap::DeletePgImp(page_id_t page_id) -> bool { return false; }
+
+auto BufferPoolManagerMmap::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type) -> bool {
+  for (size_t begin = 0; begin < page_ids.size();) {
+    size_t end = begin + 1;
+    while (end < page_ids.size() && page_ids[end] == page_ids[end - 1] + 1) {
+      end++;
+    }
+    disk_manager_->WillNeed(page_ids[begin], end - begin);
+    begin = end;
+  }
+  return true;
+}
+
+auto BufferPoolManagerMmap::IsPageResident(page_id_t page_id) -> bool {
+  return page_id >= 0 && static_cast<size_t>(page_id) < views_.size() &&
+         views_[page_id].load(std::memory_order_acquire) != nullptr;
+}
+
+}  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+void BufferPoolStats::Merge(const BufferPoolStats &other) {
+  pool_size_ += other.pool_size_;
+  free_frames_ += other.free_frames_;
+  pinned_frames_ += other.pinned_frames_;
+  dirty_frames_ += other.dirty_frames_;
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  new_pages_ += other.new_pages_;
+  evictions_ += other.evictions_;
+  dirty_evictions_ += other.dirty_evictions_;
+  foreground_writes_ += other.foreground_writes_;
+  background_writes_ += other.background_writes_;
+  prefetched_pages_ += other.prefetched_pages_;
+  for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+    miss_latency_[i] += other.miss_latency_[i];
+    eviction_write_latency_[i] += other.eviction_write_latency_[i];
+  }
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  auto fetches = hits_ + misses_;
+  return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::ToStrings() const -> std::vector<std::pair<std::string, std::string>> {
+  // Quantiles are bucket upper bounds, so they are reported as "at most" in microseconds.
+  auto quantiles = [](const LatencyHistogram::Buckets &buckets) -> std::string {
+    if (LatencyHistogram::Quantile(buckets, 0.5) == 0) {
+      return "-";
+    }
+    return fmt::format("p50<={:.1f}us p99<={:.1f}us", LatencyHistogram::Quantile(buckets, 0.5) / 1000.0,
+                       LatencyHistogram::Quantile(buckets, 0.99) / 1000.0);
+  };
+  return {
+      {"pool_size", std::to_string(pool_size_)},
+      {"free_frames", std::to_string(free_frames_)},
+      {"pinned_frames", std::to_string(pinned_frames_)},
+      {"dirty_frames", std::to_string(dirty_frames_)},
+      {"hits", std::to_string(hits_)},
+      {"misses", std::to_string(misses_)},
+      {"hit_ratio", fmt::format("{:.4f}", HitRatio())},
+      {"new_pages", std::to_string(new_pages_)},
+      {"evictions", std::to_string(evictions_)},
+      {"dirty_evictions", std::to_string(dirty_evictions_)},
+      {"foreground_writes", std::to_string(foreground_writes_)},
+      {"background_writes", std::to_string(background_writes_)},
+      {"prefetched_pages", std::to_string(prefetched_pages_)},
+      {"miss_latency", quantiles(miss_latency_)},
+      {"eviction_write_latency", quantiles(eviction_write_latency_)},
+  };
+}
+
+}  // namespace bustub
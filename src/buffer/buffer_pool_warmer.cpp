@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.cpp
+//
+// Identification: src/buffer/buffer_pool_warmer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_warmer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+namespace bustub {
+
+BufferPoolWarmer::BufferPoolWarmer(BufferPoolManager *bpm, std::string file_name, uint64_t db_file_id)
+    : bpm_(bpm), file_name_(std::move(file_name)), db_file_id_(db_file_id) {}
+
+BufferPoolWarmer::~BufferPoolWarmer() { Stop(); }
+
+auto BufferPoolWarmer::FileNameFor(const std::string &db_file_name) -> std::string {
+  auto n = db_file_name.rfind('.');
+  return (n == std::string::npos ? db_file_name : db_file_name.substr(0, n)) + ".warm";
+}
+
+auto BufferPoolWarmer::WarmUp() -> size_t {
+  std::vector<page_id_t> page_ids;
+  uint64_t db_file_id;
+  // A file saved for another database, such as one deleted and created again under the same name, lists pages that
+  // may not exist in this one.
+  if (!ReadFile(file_name_, &db_file_id, &page_ids) || db_file_id != db_file_id_) {
+    return 0;
+  }
+  // The file lists the hottest pages first; keep what fits, then read it in file order.
+  page_ids.resize(std::min(page_ids.size(), bpm_->GetPoolSize()));
+  std::sort(page_ids.begin(), page_ids.end());
+  if (page_ids.empty() || !bpm_->PrefetchPages(page_ids, AccessType::Lookup)) {
+    return 0;
+  }
+  return page_ids.size();
+}
+
+auto BufferPoolWarmer::Save() -> bool {
+  auto page_ids = bpm_->GetResidentPages();
+  if (page_ids.empty()) {
+    return false;
+  }
+  auto tmp_file_name = file_name_ + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto count = static_cast<uint32_t>(page_ids.size());
+    out.write(reinterpret_cast<const char *>(&MAGIC), sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(&db_file_id_), sizeof(db_file_id_));
+    out.write(reinterpret_cast<const char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    if (!out.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name_.c_str()) == 0;
+}
+
+auto BufferPoolWarmer::ReadFile(const std::string &file_name, uint64_t *db_file_id, std::vector<page_id_t> *page_ids)
+    -> bool {
+  std::ifstream in(file_name, std::ios::binary | std::ios::ate);
+  auto file_size = static_cast<uint64_t>(std::max<std::streamoff>(in.tellg(), 0));
+  in.seekg(0);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  in.read(reinterpret_cast<char *>(db_file_id), sizeof(*db_file_id));
+  // The count of a corrupt file is not trusted with an allocation larger than the file.
+  constexpr uint64_t header_size = sizeof(magic) + sizeof(count) + sizeof(*db_file_id);
+  if (!in.good() || magic != MAGIC || count > (file_size - header_size) / sizeof(page_id_t)) {
+    return false;
+  }
+  page_ids->resize(count);
+  in.read(reinterpret_cast<char *>(page_ids->data()), count * sizeof(page_id_t));
+  if (in.gcount() != static_cast<std::streamsize>(count * sizeof(page_id_t))) {
+    page_ids->clear();
+    return false;
+  }
+  return true;
+}
+
+void BufferPoolWarmer::Start(std::chrono::milliseconds interval) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  saver_ = std::thread([this, interval] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cv_.wait_for(lock, interval, [this] { return !running_; })) {
+      lock.unlock();
+      Save();
+      lock.lock();
+    }
+  });
+}
+
+void BufferPoolWarmer::Stop() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  cv_.notify_all();
+  saver_.join();
+  Save();
+}
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** MPOL_BIND from <numaif.h>, spelled out so that we do not depend on libnuma. */
+constexpr int MPOL_BIND_MODE = 2;
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, size_t frame_size, bool huge_pages, int numa_node)
+    : frame_size_(frame_size) {
+  size_ = (num_frames * frame_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (size_ == 0) {
+    size_ = HUGE_PAGE_SIZE;
+  }
+  // Over-allocate by one huge page and trim, since mmap only guarantees base page alignment.
+  size_t mapped_size = size_ + HUGE_PAGE_SIZE;
+  void *mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the buffer pool frame arena");
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapped);
+  auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (aligned > start) {
+    munmap(mapped, aligned - start);
+  }
+  if (start + mapped_size > aligned + size_) {
+    munmap(reinterpret_cast<void *>(aligned + size_), start + mapped_size - aligned - size_);
+  }
+  data_ = reinterpret_cast<char *>(aligned);
+
+  // Both are hints: without THP support, or on a single node machine, the arena is simply backed by base pages.
+  madvise(data_, size_, huge_pages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#ifdef SYS_mbind
+  if (numa_node >= 0 && numa_node < static_cast<int>(8 * sizeof(unsigned long))) {  // NOLINT
+    unsigned long node_mask = 1UL << numa_node;                                       // NOLINT
+    numa_bound_ = syscall(SYS_mbind, data_, size_, MPOL_BIND_MODE, &node_mask, 8 * sizeof(node_mask), 0) == 0;
+    if (!numa_bound_) {
+      LOG_WARN("cannot bind the frame arena to NUMA node %d", numa_node);
+    }
+  }
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+auto FrameArena::NumaNodeCount() -> int {
+  // The file holds a range list such as "0" or "0-3"; the highest node id bounds the node count.
+  std::ifstream in("/sys/devices/system/node/online");
+  std::string online;
+  if (!(in >> online) || online.empty()) {
+    return 1;
+  }
+  auto last = online.find_last_of("-,");
+  try {
+    return std::stoi(last == std::string::npos ? online : online.substr(last + 1)) + 1;
+  } catch (const std::exception &) {
+    return 1;
+  }
+}
+
+}  // namespace bustub
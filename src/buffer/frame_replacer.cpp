@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_replacer.cpp
+//
+// Identification: src/buffer/frame_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto MakeFrameReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> FrameReplacer * {
+  switch (policy) {
+    case ReplacerPolicy::LRU_K:
+      return new LRUKReplacer(num_frames, k);
+    case ReplacerPolicy::LRU:
+      // LRU is LRU-K with a lookback window of a single access.
+      return new LRUKReplacer(num_frames, 1);
+    case ReplacerPolicy::ARC:
+      return new ArcReplacer(num_frames);
+    case ReplacerPolicy::TWO_Q:
+      return new TwoQueueReplacer(num_frames);
+  }
+  throw Exception("unknown replacer policy");
+}
+
+auto ReplacerPolicyFromString(const std::string &name, ReplacerPolicy *policy) -> bool {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "lru_k" || lower == "lruk") {
+    *policy = ReplacerPolicy::LRU_K;
+  } else if (lower == "lru") {
+    *policy = ReplacerPolicy::LRU;
+  } else if (lower == "arc") {
+    *policy = ReplacerPolicy::ARC;
+  } else if (lower == "2q" || lower == "two_q") {
+    *policy = ReplacerPolicy::TWO_Q;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRU_K:
+      return "lru_k";
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::ARC:
+      return "arc";
+    case ReplacerPolicy::TWO_Q:
+      return "2q";
+  }
+  return "unknown";
+}
+
+}  // namespace bustub
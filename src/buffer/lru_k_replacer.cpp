@@ -12,18 +12,92 @@
 
 #include "buffer/lru_k_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames), k_(k), entries_(num_frames), history_(num_frames * k) {}
+
+auto LRUKReplacer::KeyOf(frame_id_t frame_id) const -> EvictionKey {
+  const auto &entry = entries_[frame_id];
+  return {entry.count_ >= k_, history_[frame_id * k_ + entry.head_], frame_id};
+}
+
+auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  entries_[*frame_id] = FrameEntry{};
+  curr_size_--;
+  return true;
+}
 
-auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool { return false; }
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  auto &entry = entries_[frame_id];
+  if (entry.evictable_) {
+    evictable_.erase(KeyOf(frame_id));
+  }
+  size_t *ring = &history_[frame_id * k_];
+  if (entry.count_ < k_) {
+    ring[(entry.head_ + entry.count_) % k_] = current_timestamp_++;
+    entry.count_++;
+  } else {
+    ring[entry.head_] = current_timestamp_++;
+    entry.head_ = (entry.head_ + 1) % k_;
+  }
+  if (entry.evictable_) {
+    evictable_.insert(KeyOf(frame_id));
+  }
+}
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id) {}
+void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < replacer_size_, "invalid frame id");
+  auto &entry = entries_[frame_id];
+  if (entry.count_ == 0 || entry.evictable_ == set_evictable) {
+    return;
+  }
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
+    evictable_.insert(KeyOf(frame_id));
+    curr_size_++;
+  } else {
+    evictable_.erase(KeyOf(frame_id));
+    curr_size_--;
+  }
+}
 
-void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {}
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (static_cast<size_t>(frame_id) >= replacer_size_ || entries_[frame_id].count_ == 0) {
+    return;
+  }
+  if (!entries_[frame_id].evictable_) {
+    throw Exception("remove a non-evictable frame");
+  }
+  evictable_.erase(KeyOf(frame_id));
+  entries_[frame_id] = FrameEntry{};
+  curr_size_--;
+}
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {}
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = evictable_.begin(); it != evictable_.end() && candidates.size() < max_count; ++it) {
+    candidates.push_back(std::get<2>(*it));
+  }
+  return candidates;
+}
 
-auto LRUKReplacer::Size() -> size_t { return 0; }
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
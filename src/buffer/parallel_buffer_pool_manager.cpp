@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager, ReplacerPolicy policy)
+    : pool_size_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, replacer_k,
+                                                          log_manager, policy));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t { return instances_.size() * pool_size_; }
+
+auto ParallelBufferPoolManager::GetPageSize() -> size_t { return instances_[0]->GetPageSize(); }
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+auto ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> bool {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (auto page_id : page_ids) {
+    per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i], access_type);
+    }
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::GetResidentPages() -> std::vector<page_id_t> {
+  std::vector<std::vector<page_id_t>> per_instance;
+  size_t longest = 0;
+  for (auto *instance : instances_) {
+    per_instance.push_back(instance->GetResidentPages());
+    longest = std::max(longest, per_instance.back().size());
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < longest; rank++) {
+    for (const auto &instance_page_ids : per_instance) {
+      if (rank < instance_page_ids.size()) {
+        page_ids.push_back(instance_page_ids[rank]);
+      }
+    }
+  }
+  return page_ids;
+}
+
+auto ParallelBufferPoolManager::SetReplacerPolicy(ReplacerPolicy policy) -> bool {
+  for (auto *instance : instances_) {
+    instance->SetReplacerPolicy(policy);
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::SetExtentSize(size_t extent_size) {
+  for (auto *instance : instances_) {
+    instance->SetExtentSize(extent_size);
+  }
+}
+
+auto ParallelBufferPoolManager::GetStats(BufferPoolStats *stats) -> bool {
+  *stats = BufferPoolStats();
+  for (auto *instance : instances_) {
+    BufferPoolStats instance_stats;
+    instance->GetStats(&instance_stats);
+    stats->Merge(instance_stats);
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::IsPageResident(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->IsPageResident(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgImp(page_id, AccessType::Unknown);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  return NewPgImp(page_id, AccessType::Unknown, INVALID_PAGE_ID);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, AccessType access_type, page_id_t near_page_id)
+    -> Page * {
+  // A page that belongs with another one can only go to the extent of that page in the instance owning it. Only if
+  // that instance has no frame to spare does it go elsewhere, like a page without a hint.
+  BufferPoolManagerInstance *owner = nullptr;
+  if (near_page_id != INVALID_PAGE_ID) {
+    owner = GetBufferPoolManager(near_page_id);
+    if (Page *page = owner->NewPage(page_id, access_type, near_page_id); page != nullptr) {
+      return page;
+    }
+  }
+  const size_t num_instances = instances_.size();
+  const size_t start = start_index_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *instance = instances_[(start + i) % num_instances];
+    if (instance == owner) {
+      continue;
+    }
+    if (Page *page = instance->NewPage(page_id, access_type, near_page_id); page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : capacity_(num_frames), kin_(std::max<size_t>(num_frames / 4, 1)), kout_(std::max<size_t>(num_frames / 2, 1)) {}
+
+auto TwoQueueReplacer::FirstEvictable(const std::list<frame_id_t> &list) const -> frame_id_t {
+  for (auto frame_id : list) {
+    if (entries_.at(frame_id).evictable_) {
+      return frame_id;
+    }
+  }
+  return -1;
+}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  bool from_a1in = a1in_.size() > kin_ || am_.empty();
+  frame_id_t victim = FirstEvictable(from_a1in ? a1in_ : am_);
+  if (victim == -1) {
+    from_a1in = !from_a1in;
+    victim = FirstEvictable(from_a1in ? a1in_ : am_);
+  }
+  BUSTUB_ASSERT(victim != -1, "evictable frame must exist");
+  auto entry = entries_[victim];
+  (from_a1in ? a1in_ : am_).erase(entry.pos_);
+  entries_.erase(victim);
+  curr_size_--;
+  if (from_a1in && entry.page_id_ != INVALID_PAGE_ID && a1out_index_.count(entry.page_id_) == 0) {
+    a1out_index_[entry.page_id_] = a1out_.insert(a1out_.end(), entry.page_id_);
+    if (a1out_.size() > kout_) {
+      a1out_index_.erase(a1out_.front());
+      a1out_.pop_front();
+    }
+  }
+  *frame_id = victim;
+  return true;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  auto it = entries_.find(frame_id);
+  if (it != entries_.end()) {
+    // Accesses to a page in A1in are treated as correlated with the first one and leave it in place.
+    auto &entry = it->second;
+    if (entry.in_am_) {
+      am_.splice(am_.end(), am_, entry.pos_);
+    }
+    return;
+  }
+
+  bool in_am = false;
+  if (auto ghost = a1out_index_.find(page_id); ghost != a1out_index_.end()) {
+    a1out_.erase(ghost->second);
+    a1out_index_.erase(ghost);
+    in_am = true;
+  }
+  auto &list = in_am ? am_ : a1in_;
+  entries_[frame_id] = FrameEntry{page_id, in_am, false, list.insert(list.end(), frame_id)};
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < capacity_, "invalid frame id");
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end() || it->second.evictable_ == set_evictable) {
+    return;
+  }
+  it->second.evictable_ = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = entries_.find(frame_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  if (!it->second.evictable_) {
+    throw Exception("remove a non-evictable frame");
+  }
+  (it->second.in_am_ ? am_ : a1in_).erase(it->second.pos_);
+  entries_.erase(it);
+  curr_size_--;
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  bool a1in_first = a1in_.size() > kin_ || am_.empty();
+  for (const auto *list : {a1in_first ? &a1in_ : &am_, a1in_first ? &am_ : &a1in_}) {
+    for (auto it = list->begin(); it != list->end() && candidates.size() < max_count; ++it) {
+      if (entries_.at(*it).evictable_) {
+        candidates.push_back(*it);
+      }
+    }
+  }
+  return candidates;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+}  // namespace bustub
@@ -70,17 +70,21 @@ void TableGenerator::FillTable(TableInfo *info, TableInsertMeta *table_meta) {
     for (auto &col_meta : table_meta->col_meta_) {
       values.emplace_back(MakeValues(&col_meta, num_values));
     }
+    std::vector<Tuple> tuples;
+    tuples.reserve(num_values);
     for (uint32_t i = 0; i < num_values; i++) {
       std::vector<Value> entry;
       entry.reserve(values.size());
       for (const auto &col : values) {
         entry.emplace_back(col[i]);
       }
-      RID rid;
-      bool inserted = info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction());
-      BUSTUB_ENSURE(inserted, "Sequential insertion cannot fail");
-      num_inserted++;
+      tuples.emplace_back(entry, &info->schema_);
     }
+    // The whole batch goes in at once, a page at a time.
+    std::vector<RID> rids;
+    bool inserted = info->table_->InsertTuples(tuples, &rids, exec_ctx_->GetTransaction());
+    BUSTUB_ENSURE(inserted, "Sequential insertion cannot fail");
+    num_inserted += num_values;
   }
 }
 
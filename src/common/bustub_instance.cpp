@@ -12,6 +12,7 @@
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_warmer.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -41,23 +42,30 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t page_size, size_t pool_size) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  disk_manager_ = new DiskManager(db_file_name, page_size);
+  disk_manager_->SetChecksumMode(ChecksumMode::VERIFY);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, the default is BUSTUB_INSTANCE_POOL_SIZE instead of
+  // the default buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_warmer_ = new BufferPoolWarmer(buffer_pool_manager_, BufferPoolWarmer::FileNameFor(db_file_name),
+                                               disk_manager_->GetFileId());
+    buffer_pool_warmer_->WarmUp();
+    buffer_pool_warmer_->Start();
+  }
 
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
@@ -73,19 +81,19 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t page_size, size_t pool_size) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManagerUnlimitedMemory();
+  disk_manager_ = new DiskManagerUnlimitedMemory(page_size);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // We need more frames for GenerateTestTable to work. Therefore, the default is BUSTUB_INSTANCE_POOL_SIZE instead of
+  // the default buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -146,6 +154,25 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::DisplayBufferPoolStats(ResultWriter &writer) {
+  BufferPoolStats stats;
+  if (buffer_pool_manager_ == nullptr || !buffer_pool_manager_->GetStats(&stats)) {
+    throw bustub::Exception("buffer pool does not keep statistics");
+  }
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("stat");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : stats.ToStrings()) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -251,12 +278,45 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
+        if (show_stmt.variable_ == "buffer_pool_stats") {
+          DisplayBufferPoolStats(writer);
+          continue;
+        }
         auto content = GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        if (set_stmt.variable_ == "buffer_pool_policy") {
+          ReplacerPolicy policy;
+          if (!ReplacerPolicyFromString(set_stmt.value_, &policy)) {
+            throw bustub::Exception(fmt::format("unknown buffer pool policy: {}", set_stmt.value_));
+          }
+          if (buffer_pool_manager_ == nullptr || !buffer_pool_manager_->SetReplacerPolicy(policy)) {
+            throw bustub::Exception("buffer pool does not support switching policies");
+          }
+          session_variables_[set_stmt.variable_] = ReplacerPolicyToString(policy);
+          continue;
+        }
+        if (set_stmt.variable_ == "durability_mode") {
+          DurabilityMode mode;
+          if (!DurabilityModeFromString(set_stmt.value_, &mode)) {
+            throw bustub::Exception(fmt::format("unknown durability mode: {}", set_stmt.value_));
+          }
+          disk_manager_->SetDurabilityMode(mode);
+          session_variables_[set_stmt.variable_] = DurabilityModeToString(mode);
+          continue;
+        }
+        if (set_stmt.variable_ == "checksum_mode") {
+          ChecksumMode mode;
+          if (!ChecksumModeFromString(set_stmt.value_, &mode)) {
+            throw bustub::Exception(fmt::format("unknown checksum mode: {}", set_stmt.value_));
+          }
+          disk_manager_->SetChecksumMode(mode);
+          session_variables_[set_stmt.variable_] = ChecksumModeToString(mode);
+          continue;
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
@@ -395,6 +455,7 @@ BustubInstance::~BustubInstance() {
   delete catalog_;
   delete checkpoint_manager_;
   delete log_manager_;
+  delete buffer_pool_warmer_;
   delete buffer_pool_manager_;
   delete lock_manager_;
   delete txn_manager_;
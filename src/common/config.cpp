@@ -20,4 +20,8 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+std::chrono::milliseconds buffer_pool_warmup_interval = std::chrono::seconds(10);
+
 }  // namespace bustub
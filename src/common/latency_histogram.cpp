@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.cpp
+//
+// Identification: src/common/latency_histogram.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/latency_histogram.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void LatencyHistogram::Record(std::chrono::nanoseconds latency) {
+  auto nanos = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 1));
+  auto bucket = std::min<size_t>(63 - __builtin_clzll(nanos), NUM_BUCKETS - 1);
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::AddTo(Buckets *buckets) const {
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    (*buckets)[i] += buckets_[i].load(std::memory_order_relaxed);
+  }
+}
+
+auto LatencyHistogram::Quantile(const Buckets &buckets, double quantile) -> uint64_t {
+  uint64_t total = 0;
+  for (auto count : buckets) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * static_cast<double>(total) + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return uint64_t{1} << (i + 1);
+    }
+  }
+  return uint64_t{1} << NUM_BUCKETS;
+}
+
+}  // namespace bustub
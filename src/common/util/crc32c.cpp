@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+/** The Castagnoli polynomial, bit reversed. */
+static constexpr uint32_t CRC32C_POLYNOMIAL = 0x82f63b78;
+
+/** table[i] is the checksum update for the byte i. */
+static constexpr auto MakeTable() -> std::array<uint32_t, 256> {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+static constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeTable();
+
+#if defined(__x86_64__)
+/**
+ * The crc32 instruction has a latency of three cycles but can start every cycle, so the hardware path runs three
+ * streams over consecutive blocks of INTERLEAVE_BLOCK bytes and then combines them.
+ */
+static constexpr size_t INTERLEAVE_BLOCK = 680;
+
+/**
+ * A CRC register shifted over length zero bytes, precomputed for each byte of the register: the checksum of x
+ * followed by y is the checksum of x shifted over the length of y, xor the checksum of y started from 0.
+ */
+class CrcShift {
+ public:
+  explicit CrcShift(size_t length) {
+    for (uint32_t k = 0; k < 4; k++) {
+      for (uint32_t b = 0; b < 256; b++) {
+        uint32_t crc = b << (8 * k);
+        for (size_t i = 0; i < length; i++) {
+          crc = (crc >> 8) ^ CRC32C_TABLE[crc & 0xff];
+        }
+        table_[k][b] = crc;
+      }
+    }
+  }
+
+  auto operator()(uint32_t crc) const -> uint32_t {
+    return table_[0][crc & 0xff] ^ table_[1][(crc >> 8) & 0xff] ^ table_[2][(crc >> 16) & 0xff] ^
+           table_[3][crc >> 24];
+  }
+
+ private:
+  std::array<std::array<uint32_t, 256>, 4> table_;
+};
+
+__attribute__((target("sse4.2"))) static auto ComputeHardware(const char *data, size_t size, uint32_t crc)
+    -> uint32_t {
+  static const CrcShift shift_one_block(INTERLEAVE_BLOCK);
+  static const CrcShift shift_two_blocks(2 * INTERLEAVE_BLOCK);
+  auto load = [](const char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+  };
+  uint64_t crc64 = ~crc;
+  for (; size >= 3 * INTERLEAVE_BLOCK; data += 3 * INTERLEAVE_BLOCK, size -= 3 * INTERLEAVE_BLOCK) {
+    uint64_t crc_b = 0;
+    uint64_t crc_c = 0;
+    for (size_t i = 0; i < INTERLEAVE_BLOCK; i += sizeof(uint64_t)) {
+      crc64 = _mm_crc32_u64(crc64, load(data + i));
+      crc_b = _mm_crc32_u64(crc_b, load(data + INTERLEAVE_BLOCK + i));
+      crc_c = _mm_crc32_u64(crc_c, load(data + 2 * INTERLEAVE_BLOCK + i));
+    }
+    crc64 = shift_two_blocks(static_cast<uint32_t>(crc64)) ^ shift_one_block(static_cast<uint32_t>(crc_b)) ^
+            static_cast<uint32_t>(crc_c);
+  }
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    crc64 = _mm_crc32_u64(crc64, load(data));
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; size > 0; data++, size--) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+#endif
+
+auto Crc32c::IsHardwareAccelerated() -> bool {
+#if defined(__x86_64__)
+  static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+
+auto Crc32c::Compute(const char *data, size_t size, uint32_t crc) -> uint32_t {
+#if defined(__x86_64__)
+  if (IsHardwareAccelerated()) {
+    return ComputeHardware(data, size, crc);
+  }
+#endif
+  return ComputeSoftware(data, size, crc);
+}
+
+auto Crc32c::ComputeSoftware(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xff];
+  }
+  return ~crc;
+}
+
+}  // namespace bustub
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.cpp
+//
+// Identification: src/common/util/lz4.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace bustub {
+
+/** The shortest match worth a sequence. */
+static constexpr size_t MIN_MATCH = 4;
+/** The format ends every block with at least this many literals... */
+static constexpr size_t LAST_LITERALS = 5;
+/** ...and starts no match closer than this to its end. */
+static constexpr size_t MATCH_FIND_LIMIT = 12;
+/** The furthest a match can look back, the range of its two byte offset. */
+static constexpr size_t MAX_OFFSET = 65535;
+/** A length nibble of 15 is continued by bytes of 255 and a last one below. */
+static constexpr uint32_t RUN_MASK = 15;
+static constexpr int HASH_LOG = 12;
+/** The decompressor copies runs eight bytes at a time when there is this much room past their end. */
+static constexpr size_t WILD_COPY_MARGIN = 8;
+/** After 2^SKIP_TRIGGER positions without a match, the search steps over more and more of the input. */
+static constexpr int SKIP_TRIGGER = 6;
+
+static auto Load32(const uint8_t *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/**
+ * Copy eight bytes at a time from src to dst until dst_end, writing up to WILD_COPY_MARGIN - 1 bytes past it. The
+ * chunks are copied in order, so src may overlap dst from at least eight bytes behind.
+ */
+static void WildCopy(uint8_t *dst, const uint8_t *src, const uint8_t *dst_end) {
+  do {
+    memcpy(dst, src, WILD_COPY_MARGIN);
+    dst += WILD_COPY_MARGIN;
+    src += WILD_COPY_MARGIN;
+  } while (dst < dst_end);
+}
+
+static auto Hash(uint32_t sequence) -> uint32_t { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+/** @return false if the length does not fit before out_end */
+static auto WriteLength(size_t length, uint8_t **out, const uint8_t *out_end) -> bool {
+  for (; length >= 255; length -= 255) {
+    if (*out >= out_end) {
+      return false;
+    }
+    *(*out)++ = 255;
+  }
+  if (*out >= out_end) {
+    return false;
+  }
+  *(*out)++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+/** @return false if the length runs past in_end */
+static auto ReadLength(size_t *length, const uint8_t **in, const uint8_t *in_end) -> bool {
+  uint8_t byte;
+  do {
+    if (*in >= in_end) {
+      return false;
+    }
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Write a sequence: num_literals literals, then, unless match_length is 0, a match of match_length bytes offset back.
+ * @return false if it does not fit before out_end
+ */
+static auto WriteSequence(const uint8_t *literals, size_t num_literals, size_t offset, size_t match_length,
+                          uint8_t **out, const uint8_t *out_end) -> bool {
+  if (*out >= out_end) {
+    return false;
+  }
+  uint8_t *token = (*out)++;
+  *token = static_cast<uint8_t>(std::min<size_t>(num_literals, RUN_MASK) << 4);
+  if (num_literals >= RUN_MASK && !WriteLength(num_literals - RUN_MASK, out, out_end)) {
+    return false;
+  }
+  if (static_cast<size_t>(out_end - *out) < num_literals) {
+    return false;
+  }
+  memcpy(*out, literals, num_literals);
+  *out += num_literals;
+  if (match_length == 0) {
+    return true;
+  }
+  if (out_end - *out < 2) {
+    return false;
+  }
+  *(*out)++ = static_cast<uint8_t>(offset);
+  *(*out)++ = static_cast<uint8_t>(offset >> 8);
+  auto length = match_length - MIN_MATCH;
+  *token |= static_cast<uint8_t>(std::min<size_t>(length, RUN_MASK));
+  return length < RUN_MASK || WriteLength(length - RUN_MASK, out, out_end);
+}
+
+auto Lz4::Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *out_end = out + capacity;
+  size_t anchor = 0;
+  if (size > MATCH_FIND_LIMIT) {
+    // positions of the last occurrence of every hashed four byte prefix; 0 is a fine default, as it is checked too
+    std::array<uint32_t, 1 << HASH_LOG> table{};
+    const size_t match_limit = size - MATCH_FIND_LIMIT;
+    const size_t match_end_limit = size - LAST_LITERALS;
+    size_t pos = 1;
+    while (pos < match_limit) {
+      auto sequence = Load32(in + pos);
+      auto hash = Hash(sequence);
+      size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(pos);
+      if (candidate >= pos || pos - candidate > MAX_OFFSET || Load32(in + candidate) != sequence) {
+        pos += 1 + ((pos - anchor) >> SKIP_TRIGGER);
+        continue;
+      }
+      // the match may start before the prefix that found it...
+      while (pos > anchor && candidate > 0 && in[pos - 1] == in[candidate - 1]) {
+        pos--;
+        candidate--;
+      }
+      // ...and goes on as long as it matches, short of the last literals
+      size_t length = MIN_MATCH;
+      while (pos + length < match_end_limit && in[pos + length] == in[candidate + length]) {
+        length++;
+      }
+      if (!WriteSequence(in + anchor, pos - anchor, pos - candidate, length, &out, out_end)) {
+        return 0;
+      }
+      pos += length;
+      anchor = pos;
+      if (pos < match_limit) {
+        table[Hash(Load32(in + pos - 2))] = static_cast<uint32_t>(pos - 2);
+      }
+    }
+  }
+  if (!WriteSequence(in + anchor, size - anchor, 0, 0, &out, out_end)) {
+    return 0;
+  }
+  return out - reinterpret_cast<uint8_t *>(dst);
+}
+
+auto Lz4::Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool {
+  const auto *in = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *in_end = in + size;
+  auto *out = reinterpret_cast<uint8_t *>(dst);
+  const uint8_t *out_end = out + dst_size;
+  while (in < in_end) {
+    uint8_t token = *in++;
+    size_t num_literals = token >> 4;
+    if (num_literals == RUN_MASK && !ReadLength(&num_literals, &in, in_end)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(in_end - in) || num_literals > static_cast<size_t>(out_end - out)) {
+      return false;
+    }
+    if (static_cast<size_t>(in_end - in) >= num_literals + WILD_COPY_MARGIN &&
+        static_cast<size_t>(out_end - out) >= num_literals + WILD_COPY_MARGIN) {
+      WildCopy(out, in, out + num_literals);
+    } else {
+      memcpy(out, in, num_literals);
+    }
+    in += num_literals;
+    out += num_literals;
+    if (in == in_end) {
+      // the last sequence has no match
+      break;
+    }
+    if (in_end - in < 2) {
+      return false;
+    }
+    size_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    size_t length = token & RUN_MASK;
+    if (length == RUN_MASK && !ReadLength(&length, &in, in_end)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(out - reinterpret_cast<uint8_t *>(dst)) ||
+        length > static_cast<size_t>(out_end - out)) {
+      return false;
+    }
+    uint8_t *copy_end = out + length;
+    const uint8_t *match = out - offset;
+    if (offset < WILD_COPY_MARGIN) {
+      // A short offset repeats the last few bytes. Copy them one at a time until a whole number of repetitions of at
+      // least eight bytes is behind, then copy from that far back.
+      auto period = offset * ((WILD_COPY_MARGIN + offset - 1) / offset);
+      for (size_t i = 0; i < period && out < copy_end; i++) {
+        *out++ = *match++;
+      }
+      match = out - period;
+    }
+    if (static_cast<size_t>(out_end - copy_end) >= WILD_COPY_MARGIN) {
+      WildCopy(out, match, copy_end);
+    } else {
+      while (out < copy_end) {
+        *out++ = *match++;
+      }
+    }
+    out = copy_end;
+  }
+  return out == out_end;
+}
+
+}  // namespace bustub
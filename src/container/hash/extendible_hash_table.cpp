@@ -23,7 +23,9 @@ namespace bustub {
 
 template <typename K, typename V>
 ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {}
+    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
+  dir_.emplace_back(std::make_shared<Bucket>(bucket_size_, 0));
+}
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
@@ -66,18 +68,58 @@ auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  UNREACHABLE("not implemented");
+  std::scoped_lock<std::mutex> lock(latch_);
+  return dir_[IndexOf(key)]->Find(key, value);
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  UNREACHABLE("not implemented");
+  std::scoped_lock<std::mutex> lock(latch_);
+  return dir_[IndexOf(key)]->Remove(key);
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  int a=1;
-  UNREACHABLE("not implemented");
+  std::scoped_lock<std::mutex> lock(latch_);
+  while (!dir_[IndexOf(key)]->Insert(key, value)) {
+    auto bucket = dir_[IndexOf(key)];
+    if (bucket->GetDepth() == global_depth_) {
+      // Double the directory; the upper half mirrors the lower half.
+      size_t old_size = dir_.size();
+      dir_.reserve(old_size * 2);
+      for (size_t i = 0; i < old_size; i++) {
+        dir_.emplace_back(dir_[i]);
+      }
+      global_depth_++;
+    }
+    RedistributeBucket(bucket);
+  }
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void {
+  int old_depth = bucket->GetDepth();
+  bucket->IncrementDepth();
+  auto sibling = std::make_shared<Bucket>(bucket_size_, bucket->GetDepth());
+  num_buckets_++;
+
+  // Move every pair whose new distinguishing bit is set into the sibling bucket.
+  size_t high_bit = static_cast<size_t>(1) << old_depth;
+  auto &items = bucket->GetItems();
+  for (auto it = items.begin(); it != items.end();) {
+    if ((std::hash<K>()(it->first) & high_bit) != 0) {
+      sibling->GetItems().emplace_back(std::move(*it));
+      it = items.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (size_t i = 0; i < dir_.size(); i++) {
+    if (dir_[i] == bucket && (i & high_bit) != 0) {
+      dir_[i] = sibling;
+    }
+  }
 }
 
 //===--------------------------------------------------------------------===//
@@ -88,17 +130,39 @@ ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  UNREACHABLE("not implemented");
+  for (const auto &[k, v] : list_) {
+    if (k == key) {
+      value = v;
+      return true;
+    }
+  }
+  return false;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  UNREACHABLE("not implemented");
+  for (auto it = list_.begin(); it != list_.end(); ++it) {
+    if (it->first == key) {
+      list_.erase(it);
+      return true;
+    }
+  }
+  return false;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  UNREACHABLE("not implemented");
+  for (auto &[k, v] : list_) {
+    if (k == key) {
+      v = value;
+      return true;
+    }
+  }
+  if (IsFull()) {
+    return false;
+  }
+  list_.emplace_back(key, value);
+  return true;
 }
 
 template class ExtendibleHashTable<page_id_t, Page *>;
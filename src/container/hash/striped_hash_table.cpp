@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// striped_hash_table.cpp
+//
+// Identification: src/container/hash/striped_hash_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+#include "container/hash/striped_hash_table.h"
+
+namespace bustub {
+
+template <typename K, typename V>
+auto StripedHashTable<K, V>::StripeOf(const K &key) -> Stripe & {
+  // Mix the hash so that sequential integer keys (e.g. page ids) spread over all stripes.
+  size_t hash = std::hash<K>()(key) * 0x9E3779B97F4A7C15ULL;
+  return stripes_[(hash >> 32) & (NUM_STRIPES - 1)];
+}
+
+template <typename K, typename V>
+auto StripedHashTable<K, V>::Find(const K &key, V &value) -> bool {
+  auto &stripe = StripeOf(key);
+  std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+  auto it = stripe.map_.find(key);
+  if (it == stripe.map_.end()) {
+    return false;
+  }
+  value = it->second;
+  return true;
+}
+
+template <typename K, typename V>
+void StripedHashTable<K, V>::Insert(const K &key, const V &value) {
+  auto &stripe = StripeOf(key);
+  std::unique_lock<std::shared_mutex> lock(stripe.latch_);
+  stripe.map_[key] = value;
+}
+
+template <typename K, typename V>
+auto StripedHashTable<K, V>::Remove(const K &key) -> bool {
+  auto &stripe = StripeOf(key);
+  std::unique_lock<std::shared_mutex> lock(stripe.latch_);
+  return stripe.map_.erase(key) > 0;
+}
+
+template <typename K, typename V>
+auto StripedHashTable<K, V>::Size() const -> size_t {
+  size_t size = 0;
+  for (const auto &stripe : stripes_) {
+    std::shared_lock<std::shared_mutex> lock(stripe.latch_);
+    size += stripe.map_.size();
+  }
+  return size;
+}
+
+template class StripedHashTable<page_id_t, frame_id_t>;
+// test purpose
+template class StripedHashTable<int, std::string>;
+
+}  // namespace bustub
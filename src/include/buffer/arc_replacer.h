@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/frame_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident frames live in T1 (seen once recently) or T2 (seen at least twice). The pages of frames evicted from T1
+ * and T2 are remembered in the ghost lists B1 and B2. A miss on a page in B1 means T1 was too small, a miss on a page
+ * in B2 means T2 was too small, and the target size p of T1 adapts accordingly. Pinned frames are skipped, so the
+ * victim is the least recently used evictable frame of the list the policy picks.
+ */
+class ArcReplacer : public FrameReplacer {
+ public:
+  /**
+   * @brief Create a new ArcReplacer.
+   * @param num_frames the number of frames in the buffer pool
+   */
+  explicit ArcReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ArcReplacer);
+
+  ~ArcReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+ private:
+  /** A resident frame, kept in T1 or T2. */
+  struct FrameEntry {
+    page_id_t page_id_;
+    bool in_t2_;
+    bool evictable_;
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** @return whether the next victim should come from T1. Caller must hold latch_. */
+  auto PreferT1() const -> bool;
+
+  /** @return the least recently used evictable frame of the list, or -1. Caller must hold latch_. */
+  auto FirstEvictable(const std::list<frame_id_t> &list) const -> frame_id_t;
+
+  /** Remember page_id in the ghost list, dropping the oldest ghosts beyond the directory size. */
+  void AddGhost(std::list<page_id_t> *ghosts, std::unordered_map<page_id_t, std::list<page_id_t>::iterator> *index,
+                page_id_t page_id);
+
+  /** Forget the ghosts exceeding the ARC directory bounds, |T1| + |B1| <= c and the total <= 2c. */
+  void TrimGhosts();
+
+  size_t capacity_;
+  /** Target size of T1. */
+  size_t p_{0};
+  size_t curr_size_{0};
+  /** Resident frames, least recently used first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  std::unordered_map<frame_id_t, FrameEntry> entries_;
+  /** Ghost pages, least recently evicted first. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> b1_index_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> b2_index_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
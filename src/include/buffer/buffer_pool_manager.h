@@ -15,14 +15,24 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/**
+ * How a page is about to be used, passed as a hint to FetchPage and NewPage. Scan accesses touch each page once and
+ * are kept from evicting the pages other accesses keep coming back to.
+ */
+enum class AccessType { Unknown = 0, Lookup, Scan, Index };
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -45,6 +55,14 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page, telling the buffer pool how it is going to be used.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type) -> Page * { return FetchPgImp(page_id, access_type); }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -69,6 +87,60 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Create a new page, telling the buffer pool how it is going to be used.
+   * @param[out] page_id id of created page
+   * @param access_type the kind of access
+   * @param near_page_id a page the new one belongs with, which it should be placed close to on disk, if any
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, AccessType access_type, page_id_t near_page_id = INVALID_PAGE_ID) -> Page * {
+    return NewPgImp(page_id, access_type, near_page_id);
+  }
+
+  /**
+   * Fetch a page and wrap its pin in a guard, which unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return a guard holding the page, empty if page_id cannot be fetched
+   */
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard {
+    return {this, FetchPgImp(page_id, access_type)};
+  }
+
+  /**
+   * Fetch a page and read latch it. The guard releases the latch and the pin when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return a guard holding the latched page, empty if page_id cannot be fetched
+   */
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard {
+    return FetchPageBasic(page_id, access_type).UpgradeRead();
+  }
+
+  /**
+   * Fetch a page and write latch it. The guard releases the latch and the pin when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return a guard holding the latched page, empty if page_id cannot be fetched
+   */
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard {
+    return FetchPageBasic(page_id, access_type).UpgradeWrite();
+  }
+
+  /**
+   * Create a new page and wrap its pin in a guard. Like any page, it is only unpinned as dirty if it is modified
+   * through the guard or marked with SetDirty().
+   * @param[out] page_id id of created page
+   * @param access_type the kind of access
+   * @param near_page_id a page the new one belongs with, which it should be placed close to on disk, if any
+   * @return a guard holding the new page, empty if no new pages could be created
+   */
+  auto NewPageGuarded(page_id_t *page_id, AccessType access_type = AccessType::Unknown,
+                      page_id_t near_page_id = INVALID_PAGE_ID) -> BasicPageGuard {
+    return {this, NewPgImp(page_id, access_type, near_page_id)};
+  }
+
   /** Grading function. Do not modify! */
   auto DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -87,6 +159,50 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return the size in bytes of the data of every page in the buffer pool */
+  virtual auto GetPageSize() -> size_t { return BUSTUB_PAGE_SIZE; }
+
+  /**
+   * Hint that the given pages will be fetched soon. Implementations may start reading them in the background, so
+   * that the later FetchPage calls hit the pool; the pages are not pinned. The default implementation ignores the hint.
+   * @param page_ids ids of the pages to read ahead, in the order they will be fetched
+   * @param access_type how the pages will be used once fetched
+   * @return true if the hint is acted upon, false if this buffer pool does not prefetch
+   */
+  virtual auto PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Scan)
+      -> bool {
+    return false;
+  }
+
+  /**
+   * List the pages currently in the buffer pool, the ones the replacement policy would keep longest first. Like
+   * IsPageResident, the answer is only a hint.
+   * @return ids of the resident pages, or nothing if this buffer pool cannot tell
+   */
+  virtual auto GetResidentPages() -> std::vector<page_id_t> { return {}; }
+
+  /**
+   * Check, without blocking on I/O, whether a page is currently in the buffer pool. The answer may be stale by the time
+   * the caller acts on it, so it should only be used as a hint.
+   * @param page_id id of the page to check
+   * @return true if the page is resident
+   */
+  virtual auto IsPageResident(page_id_t page_id) -> bool { return false; }
+
+  /**
+   * Switch the replacement policy. Resident pages stay resident, but their access history is not carried over.
+   * @param policy the new policy
+   * @return false if this buffer pool does not support switching policies
+   */
+  virtual auto SetReplacerPolicy(ReplacerPolicy policy) -> bool { return false; }
+
+  /**
+   * Take a snapshot of the buffer pool's counters.
+   * @param[out] stats the snapshot
+   * @return false if this buffer pool does not keep statistics
+   */
+  virtual auto GetStats(BufferPoolStats *stats) -> bool { return false; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +224,14 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool with an access hint. The default implementation ignores the hint.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * { return FetchPgImp(page_id); }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +254,18 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Creates a new page in the buffer pool with an access hint and a placement hint. The default implementation ignores
+   * the hints.
+   * @param[out] page_id id of created page
+   * @param access_type the kind of access
+   * @param near_page_id a page to place the new one close to on disk, or INVALID_PAGE_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgImp(page_id_t *page_id, AccessType access_type, page_id_t near_page_id) -> Page * {
+    return NewPgImp(page_id);
+  }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -12,14 +12,21 @@
 
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/frame_replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
+#include "container/hash/striped_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -37,9 +44,25 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param policy the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerPolicy policy = ReplacerPolicy::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM; it only allocates page ids where
+   * page_id % num_instances == instance_index
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerPolicy policy = ReplacerPolicy::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,9 +72,87 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @return the page size of the disk manager's database */
+  auto GetPageSize() -> size_t override { return page_size_; }
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Queue the given pages to be read into the pool by a background prefetch thread, which is started on first
+   * use. Pages already resident when their turn comes are skipped, and prefetched pages are left unpinned. Requests
+   * beyond pool_size_ outstanding pages are dropped, since they would only evict each other.
+   * @param page_ids ids of the pages to read ahead
+   * @param access_type how the pages will be used; scan pages are read into the scan ring like scan misses
+   * @return true
+   */
+  auto PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Scan)
+      -> bool override;
+
+  /**
+   * @brief List the resident pages under latch_: pages the replacer cannot evict first, then the evictable ones in
+   * reverse eviction order. Pending latch-free hits are reported to the replacer first.
+   * @return ids of the resident pages
+   */
+  auto GetResidentPages() -> std::vector<page_id_t> override;
+
+  /**
+   * @brief Replace the replacer with a new one running the given policy, registering every resident frame with it.
+   * @param policy the new policy
+   * @return true
+   */
+  auto SetReplacerPolicy(ReplacerPolicy policy) -> bool override;
+
+  /** @return the replacement policy currently in use */
+  auto GetReplacerPolicy() -> ReplacerPolicy;
+
+  /** @return true if page_id is in the page table */
+  auto IsPageResident(page_id_t page_id) -> bool override;
+
+  /** @return the number of pages read into the pool by the prefetch thread */
+  auto GetPrefetchedPages() const -> size_t { return prefetched_pages_; }
+
+  /**
+   * @brief Start the background page cleaner. Every page_cleaner_interval it runs CleanPages(), so that frames the
+   * replacer is about to evict are already clean and eviction does not write on the query thread.
+   * @param target_clean_ratio the fraction of frames the cleaner tries to keep free or clean
+   * @param max_batch_size the maximum number of pages the cleaner writes back per round
+   */
+  void RunPageCleaner(double target_clean_ratio = PAGE_CLEANER_TARGET_CLEAN_RATIO,
+                      size_t max_batch_size = PAGE_CLEANER_MAX_BATCH_SIZE);
+
+  /** @brief Stop the background page cleaner and wait for its current round to finish. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Write back dirty, unpinned frames in the order the replacer would evict them, until the target clean
+   * ratio is met or max_batch_size pages are written. Pages are copied out under latch_ and written afterwards, with
+   * runs of consecutive page ids coalesced into one DiskManager::WritePages call. Normally called by the cleaner.
+   * @return the number of pages written back
+   */
+  auto CleanPages() -> size_t;
+
+  /**
+   * @brief Set how many pages are reserved at once for an object that grows with placement hints, see AllocatePage.
+   * An extent size of 1 turns extents off. Call before the first page is created.
+   * @param extent_size pages per extent
+   */
+  void SetExtentSize(size_t extent_size) { extent_size_ = std::max<size_t>(1, extent_size); }
+
+  /** @return the number of pages written back on query threads, by evictions and explicit flushes */
+  auto GetForegroundWrites() const -> size_t { return foreground_writes_; }
+
+  /** @return the number of pages written back by the page cleaner */
+  auto GetBackgroundWrites() const -> size_t { return background_writes_; }
+
+  /**
+   * @brief Take a snapshot of this instance's counters. The frame counts are gathered under latch_, the rest are read
+   * from atomic counters maintained on the query path.
+   * @param[out] stats the snapshot
+   * @return true
+   */
+  auto GetStats(BufferPoolStats *stats) -> bool override;
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -72,6 +173,16 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Create a new page like NewPgImp(page_id), taking the frame from the scan ring for AccessType::Scan and
+   * reusing the deallocated page of this instance closest to near_page_id, if any.
+   * @param[out] page_id id of created page
+   * @param access_type the kind of access
+   * @param near_page_id a page to place the new one close to on disk, or INVALID_PAGE_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, AccessType access_type, page_id_t near_page_id) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -90,6 +201,16 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch a page like FetchPgImp(page_id). A page read in for AccessType::Scan takes its frame from the scan
+   * ring, and a scan hit does not count as a reference, so a large scan cycles through a few frames instead of
+   * evicting the pages other accesses keep using.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -142,40 +263,227 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
+  /** Size of every page, as chosen by the disk manager. */
+  const size_t page_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** The first page id of the next extent to be reserved. Every page below it is allocated, reserved or free. */
   std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /** Pages per extent, see AllocatePage. */
+  size_t extent_size_{EXTENT_SIZE};
+  /** First page of the extent shared by allocations without a placement hint. */
+  page_id_t shared_extent_{INVALID_PAGE_ID};
 
-  /** Array of buffer pool pages. */
+  /** Page data of every frame. */
+  FrameArena *frame_arena_;
+  /** Array of buffer pool pages, i.e. the metadata of each frame. Their data is in frame_arena_. */
   Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups are latch-free with respect to latch_. */
+  StripedHashTable<page_id_t, frame_id_t> *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  FrameReplacer *replacer_;
+  /** Policy run by replacer_, and the LRU-K lookback it was created with. */
+  ReplacerPolicy policy_;
+  const size_t replacer_k_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the free list, the replacer and every change of which page a frame holds. Pinning and
+   * unpinning a resident page does not take it: a frame can only be reassigned after the latch holder claims it by
+   * moving its pin count from 0 to -1, which fails while anyone has the page pinned. Pages are read from disk with the
+   * latch released, see reads_in_flight_.
+   */
   std::mutex latch_;
+  /**
+   * Pages being read from disk into a claimed frame, which happens with latch_ released. A fetch of one of them waits
+   * on read_cv_ until the read is done instead of reading the page into a second frame. Protected by latch_.
+   */
+  std::unordered_set<page_id_t> reads_in_flight_;
+  std::condition_variable read_cv_;
+
+  /** Page cleaner thread, if running. */
+  std::thread page_cleaner_;
+  /** Protects page_cleaner_running_ and wakes the cleaner up early when it is stopped. */
+  std::mutex page_cleaner_latch_;
+  std::condition_variable page_cleaner_cv_;
+  bool page_cleaner_running_{false};
+  /** Fraction of frames the page cleaner keeps free or clean. */
+  double target_clean_ratio_{PAGE_CLEANER_TARGET_CLEAN_RATIO};
+  /** Maximum number of pages the page cleaner writes back per round. */
+  size_t max_batch_size_{PAGE_CLEANER_MAX_BATCH_SIZE};
+
+  /**
+   * Pages the page cleaner has copied out and not yet written. Reading such a page from disk, or writing a newer
+   * version of it, has to wait for the write to land. Lock order is latch_, then write_back_latch_.
+   */
+  std::unordered_set<page_id_t> write_back_in_flight_;
+  std::mutex write_back_latch_;
+  std::condition_variable write_back_cv_;
+
+  /**
+   * Frames most recently filled by scan accesses, oldest first, with the page each was filled with. Once it holds
+   * scan_ring_size_ entries, the next scan miss reuses the oldest frame if nothing else has touched it since.
+   * Protected by latch_.
+   */
+  std::deque<std::pair<frame_id_t, page_id_t>> scan_ring_;
+  const size_t scan_ring_size_;
+
+  /** Prefetch thread, started by the first PrefetchPages call. */
+  std::thread prefetcher_;
+  /** Protects prefetch_queue_ and prefetcher_running_. */
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  std::deque<std::pair<page_id_t, AccessType>> prefetch_queue_;
+  bool prefetcher_running_{false};
+  /** Pages read in by the prefetch thread. */
+  std::atomic<size_t> prefetched_pages_{0};
+
+  /** Pages written back on query threads and by the page cleaner. */
+  std::atomic<size_t> foreground_writes_{0};
+  std::atomic<size_t> background_writes_{0};
+
+  /** Counters and latency histograms reported by GetStats. */
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> new_pages_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> dirty_evictions_{0};
+  LatencyHistogram miss_latency_;
+  LatencyHistogram eviction_write_latency_;
+
+  /**
+   * @brief Block until the page cleaner has no write of page_id in flight. Caller must hold latch_, unless page_id is
+   * being read in: the cleaner only starts writes of resident pages, under latch_.
+   * @param page_id the page about to be read from or written to disk
+   */
+  void WaitForWriteBack(page_id_t page_id);
+
+  /**
+   * @brief Write a page back on the calling (query) thread. Caller must hold latch_.
+   * @param page the frame to write back
+   */
+  void WriteBackPage(Page *page);
+
+  /**
+   * @brief Drop the page of a claimed victim frame from the pool, writing it back first if it is dirty. Caller must
+   * hold latch_ and have removed the frame from the replacer, or have gotten it from Evict.
+   * @param victim the claimed frame
+   */
+  void EvictPage(Page *victim);
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   *
+   * Pages are handed out from extents of extent_size_ pages of this instance. A page that belongs with near_page_id
+   * goes into the extent of near_page_id if the extent has a page left, and otherwise starts a new extent for it, so
+   * that a table heap or index grows in runs of consecutive pages instead of interleaving with every other object.
+   * Pages without a hint share one extent. A deallocated page is reused first, if there is one in the right extent
+   * (or anywhere, without a hint). The unused pages of an extent are reserved in the disk manager, which frees the
+   * ones left at shut down, so that they are not lost when page ids start over from the end of the file.
+   * @param near_page_id a page the new one belongs with, or INVALID_PAGE_ID
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * @brief Reserve the next extent of this instance, and take its first page. Caller must hold latch_.
+   * @return the first page of the extent
+   */
+  auto ReserveExtent() -> page_id_t;
+
+  /** @return the first page of the extent holding page_id, which this instance owns */
+  auto ExtentOf(page_id_t page_id) const -> page_id_t;
+
+  /**
+   * @brief Check that a page id allocated by this instance maps back to it in the parallel BPM.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
 
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  void DeallocatePage(page_id_t page_id) {
+    // Only pages this instance handed out; anything else would be handed out twice.
+    if (page_id >= 0 && page_id < next_page_id_ && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+      disk_manager_->DeallocatePage(page_id);
+    }
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Pick a frame to hold a new page, first from the free list and then from the replacer. If the victim frame
+   * holds a dirty page, it is written back and its page table entry is removed. Caller must hold latch_.
+   *
+   * Every resident frame stays a candidate in the replacer, because pins taken on the latch-free path are invisible
+   * to it. A candidate that was referenced since the replacer last saw it has its access recorded and gets a second
+   * chance; one that turns out to be pinned is skipped, without being evicted from the replacer, so it keeps its
+   * history.
+   *
+   * @param[out] frame_id the frame that is now free to use; it is returned claimed (pin count -1)
+   * @return false if every frame is pinned, true otherwise
+   */
+  auto AcquireFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Pick a frame for a page read or created by a scan: the oldest scan ring frame if the ring is full and that
+   * frame is unpinned and unreferenced, otherwise whatever AcquireFrame picks. Caller must hold latch_.
+   * @param[out] frame_id the frame that is now free to use; it is returned claimed (pin count -1)
+   * @return false if every frame is pinned, true otherwise
+   */
+  auto AcquireScanFrame(frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Publish a claimed frame that now holds page_id: insert it into the page table, pin it once (unless it is
+   * being prefetched) and record the access in the replacer. Caller must hold latch_.
+   * @param frame_id the claimed frame
+   * @param page_id the page the frame now holds
+   * @param pin whether the caller gets the page pinned
+   * @param access_type the kind of access; scan frames are appended to the scan ring
+   */
+  void InstallFrame(frame_id_t frame_id, page_id_t page_id, bool pin = true,
+                    AccessType access_type = AccessType::Unknown);
+
+  /**
+   * @brief Read page_id from disk into a claimed frame, releasing latch_ for the read so that hits and misses on other
+   * pages go on meanwhile. The page is in reads_in_flight_ until the caller, holding latch_ again, installs it. If the
+   * read throws anything, e.g. the page fails its checksum, the frame goes back to the free list before it propagates.
+   * @param frame_id the claimed frame
+   * @param page_id the page to read, which must not be resident or in flight
+   * @param lock the caller's lock on latch_, held again when this returns or throws
+   */
+  void ReadIntoFrame(frame_id_t frame_id, page_id_t page_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * @brief Read page_id into an unpinned frame if it is not resident yet. Called by the prefetch thread.
+   * @param page_id the page to read ahead
+   * @param access_type how the page will be used
+   */
+  void PrefetchPage(page_id_t page_id, AccessType access_type);
+
+  /** @brief Stop the prefetch thread, dropping any queued requests. */
+  void StopPrefetcher();
+
+  /**
+   * @brief Try to pin page_id without taking latch_. Succeeds only if the page is resident and its frame is not
+   * claimed by the buffer pool manager.
+   * @param page_id the page to pin
+   * @param access_type the kind of access; scan hits do not mark the page referenced
+   * @return the pinned page, or nullptr if the caller has to take the slow path
+   */
+  auto TryPinResident(page_id_t page_id, AccessType access_type) -> Page *;
+
+  /**
+   * @brief Claim an unpinned frame by moving its pin count from 0 to -1, so it cannot be pinned while it is reassigned.
+   * @param page the frame to claim
+   * @return false if the frame is pinned
+   */
+  static auto TryClaim(Page *page) -> bool;
 };
 }  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_mmap.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_mmap.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerMmap serves the pages of a read only database straight out of the mapping of a DiskManagerMmap.
+ * A fetched Page is a view whose data points into the mapping: nothing is copied, there are no frames to allocate and
+ * nothing is ever evicted, as the OS page cache does the caching. The view of a page is made on its first fetch and
+ * kept until the buffer pool is destroyed, so a page fetched twice is the same Page.
+ *
+ * The pages are read only. New and deleted pages are refused, being unpinned dirty is ignored, and writing to the
+ * data of a page faults, so pages must only be fetched for reading.
+ */
+class BufferPoolManagerMmap : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a buffer pool over every page of a mapped database file.
+   * @param disk_manager the disk manager, which must outlive the buffer pool
+   */
+  explicit BufferPoolManagerMmap(DiskManagerMmap *disk_manager);
+
+  ~BufferPoolManagerMmap() override;
+
+  /** @return the number of pages of the database, which can all be fetched at once */
+  auto GetPoolSize() -> size_t override { return views_.size(); }
+
+  auto GetPageSize() -> size_t override { return disk_manager_->GetPageSize(); }
+
+  /** Ask the OS to read the pages in, in runs of consecutive page ids. */
+  auto PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Scan)
+      -> bool override;
+
+  /** @return true if the page has been fetched before, whether or not the OS still has it in memory */
+  auto IsPageResident(page_id_t page_id) -> bool override;
+
+ protected:
+  /**
+   * Fetch a view of a page, pinned.
+   * @param page_id id of page to be fetched
+   * @return the view, or nullptr if the page is not in the file
+   * @throw Exception of type IO if the page fails its checksum
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Unpin a view. The page is never dirty, whatever is_dirty says.
+   * @return false if the page is not pinned
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /** There is nothing to flush. @return true if the page has a view */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /** The database is read only. @return nullptr */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /** The database is read only. @return false */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  void FlushAllPgsImp() override {}
+
+ private:
+  DiskManagerMmap *disk_manager_;
+  /** The view of every page of the file, nullptr until it is first fetched. */
+  std::vector<std::atomic<Page *>> views_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/latency_histogram.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolStats is a snapshot of the counters of a buffer pool. The snapshots of the shards of a parallel buffer
+ * pool add up to the snapshot of the whole pool.
+ */
+struct BufferPoolStats {
+  /** Frames in the pool, frames holding no page, and resident frames that are pinned or dirty at snapshot time. */
+  uint64_t pool_size_{0};
+  uint64_t free_frames_{0};
+  uint64_t pinned_frames_{0};
+  uint64_t dirty_frames_{0};
+
+  /** FetchPage calls served from the pool and calls that had to read the page. */
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  /** Pages created by NewPage. */
+  uint64_t new_pages_{0};
+  /** Pages evicted to make room, and how many of them had to be written back first. */
+  uint64_t evictions_{0};
+  uint64_t dirty_evictions_{0};
+  /** Pages written back on query threads (evictions and flushes) and by the page cleaner. */
+  uint64_t foreground_writes_{0};
+  uint64_t background_writes_{0};
+  /** Pages read in by the prefetch thread. */
+  uint64_t prefetched_pages_{0};
+
+  /** Latency of FetchPage misses, from taking the pool latch to returning the page read from disk. */
+  LatencyHistogram::Buckets miss_latency_{};
+  /** Latency of writing back a dirty victim before its frame is reused. */
+  LatencyHistogram::Buckets eviction_write_latency_{};
+
+  /** @brief Add the counters of another shard to these. */
+  void Merge(const BufferPoolStats &other);
+
+  /** @return the fraction of FetchPage calls served from the pool, 0 if there were none */
+  auto HitRatio() const -> double;
+
+  /** @return every statistic as a (name, value) pair, for display */
+  auto ToStrings() const -> std::vector<std::pair<std::string, std::string>>;
+};
+
+}  // namespace bustub
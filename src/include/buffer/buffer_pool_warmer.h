@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer.h
+//
+// Identification: src/include/buffer/buffer_pool_warmer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolWarmer carries the working set of a buffer pool across restarts. While the database runs, it saves the ids
+ * of the resident pages, hottest first, to a small file next to the database file. On startup, WarmUp() reads them
+ * back and has the buffer pool prefetch them in page id order, so the pool fills with mostly sequential reads in the
+ * background instead of one random miss at a time. The file records the id of the database file it was saved for, and
+ * is ignored by a warmer of any other.
+ */
+class BufferPoolWarmer {
+ public:
+  /**
+   * @brief Create a warmer for a buffer pool. Nothing is read or written until WarmUp, Save or Start is called.
+   * @param bpm the buffer pool to save and warm up
+   * @param file_name the warm-up file, see FileNameFor
+   * @param db_file_id the id of the database file the pages are in, see DiskManager::GetFileId; a warm-up file saved
+   * with another id is ignored
+   */
+  BufferPoolWarmer(BufferPoolManager *bpm, std::string file_name, uint64_t db_file_id = 0);
+
+  /** @brief Stop the periodic saves, saving one last time if they were running. */
+  ~BufferPoolWarmer();
+
+  /** @return the warm-up file of a database file: foo.db keeps its resident page set in foo.warm */
+  static auto FileNameFor(const std::string &db_file_name) -> std::string;
+
+  /**
+   * @brief Queue the pages listed in the warm-up file for prefetching, at most a pool's worth of the hottest ones,
+   * sorted by page id. Returns without waiting for them to be read.
+   * @return the number of pages queued, 0 if there is no usable file or the buffer pool does not prefetch
+   */
+  auto WarmUp() -> size_t;
+
+  /**
+   * @brief Write the current resident page set to the warm-up file. The file is replaced atomically, so a crash
+   * while saving leaves the previous set in place.
+   * @return false if the buffer pool cannot list its pages or the file cannot be written
+   */
+  auto Save() -> bool;
+
+  /**
+   * @brief Start a background thread that calls Save() every interval.
+   * @param interval time between saves
+   */
+  void Start(std::chrono::milliseconds interval = buffer_pool_warmup_interval);
+
+  /** @brief Stop the background thread, then save one last time. Does nothing if it is not running. */
+  void Stop();
+
+  /**
+   * @brief Read a warm-up file.
+   * @param file_name the file to read
+   * @param[out] db_file_id the id of the database file the pages were saved for
+   * @param[out] page_ids the saved page ids, hottest first
+   * @return false if the file is missing or malformed
+   */
+  static auto ReadFile(const std::string &file_name, uint64_t *db_file_id, std::vector<page_id_t> *page_ids) -> bool;
+
+ private:
+  /** Written at the start of the file, to recognize it. */
+  static constexpr uint32_t MAGIC = 0x32574242;  // "BBW2"
+
+  BufferPoolManager *bpm_;
+  std::string file_name_;
+  uint64_t db_file_id_;
+
+  std::thread saver_;
+  /** Protects running_ and wakes the saver up early when it is stopped. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool running_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the page data of every frame of a buffer pool in one contiguous anonymous mapping, aligned to and
+ * rounded up to 2 MB so the kernel can back it with transparent huge pages. Frame metadata lives elsewhere, which
+ * keeps the data of neighbouring frames densely packed and lets a large pool be covered by few TLB entries.
+ */
+class FrameArena {
+ public:
+  /** Alignment and granularity of the mapping: the x86-64 huge page size. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * @brief Map a new arena. The frames start out zeroed.
+   * @param num_frames number of frames
+   * @param frame_size size of each frame in bytes
+   * @param huge_pages whether to ask the kernel for transparent huge pages
+   * @param numa_node NUMA node to bind the memory to, or -1 to leave placement to the kernel
+   */
+  explicit FrameArena(size_t num_frames, size_t frame_size = BUSTUB_PAGE_SIZE, bool huge_pages = true,
+                      int numa_node = -1);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @brief Unmap the arena. */
+  ~FrameArena();
+
+  /** @return the data of the given frame */
+  inline auto GetFrame(size_t frame_id) -> char * { return data_ + frame_id * frame_size_; }
+
+  /** @return the size of the mapping in bytes */
+  inline auto GetSize() const -> size_t { return size_; }
+
+  /** @return true if the memory was successfully bound to a NUMA node */
+  inline auto IsNumaBound() const -> bool { return numa_bound_; }
+
+  /** @return the number of online NUMA nodes, 1 if it cannot be determined */
+  static auto NumaNodeCount() -> int;
+
+ private:
+  char *data_;
+  size_t size_;
+  size_t frame_size_;
+  bool numa_bound_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_replacer.h
+//
+// Identification: src/include/buffer/frame_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Replacement policies the buffer pool can run with. */
+enum class ReplacerPolicy { LRU_K = 0, LRU, ARC, TWO_Q };
+
+/**
+ * FrameReplacer is the interface between BufferPoolManagerInstance and its replacement policy. The buffer pool
+ * records every access to a frame together with the page the frame holds, so that policies which remember recently
+ * evicted pages (ARC, 2Q) can recognize them when they come back.
+ */
+class FrameReplacer {
+ public:
+  FrameReplacer() = default;
+  virtual ~FrameReplacer() = default;
+
+  /**
+   * @brief Pick an evictable frame according to the policy and stop tracking it.
+   * @param[out] frame_id id of the evicted frame
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * @brief Record an access to a frame. The first access after the frame was evicted or removed starts tracking it.
+   * @param frame_id the accessed frame
+   * @param page_id the page the frame holds
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id) = 0;
+
+  /**
+   * @brief Mark a tracked frame as evictable or not. Untracked frames are ignored.
+   * @param frame_id the frame to update
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * @brief Stop tracking an evictable frame without treating it as an eviction. Throws if the frame is not evictable.
+   * @param frame_id the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
+  /**
+   * @brief List evictable frames in the order Evict() would pick them, without evicting anything.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count evictable frames, next victim first
+   */
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
+
+  /** @return the number of evictable frames */
+  virtual auto Size() -> size_t = 0;
+};
+
+/**
+ * @brief Create a replacer running the given policy.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames in the buffer pool
+ * @param k the lookback window, used by LRU_K only
+ * @return the new replacer, owned by the caller
+ */
+auto MakeFrameReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> FrameReplacer *;
+
+/**
+ * @brief Parse a policy name: lru_k, lru, arc or 2q, case insensitive.
+ * @param name the policy name
+ * @param[out] policy the parsed policy
+ * @return false if the name is unknown
+ */
+auto ReplacerPolicyFromString(const std::string &name, ReplacerPolicy *policy) -> bool;
+
+/** @return the name of the policy, as accepted by ReplacerPolicyFromString */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
+}  // namespace bustub
@@ -13,11 +13,12 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <tuple>
 #include <vector>
 
+#include "buffer/frame_replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -33,8 +34,11 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Evictable frames are kept in a set ordered by eviction priority, so Evict, RecordAccess, SetEvictable and Remove
+ * are all O(log n). The access history of each frame is a fixed ring of k timestamps, allocated once for all frames.
  */
-class LRUKReplacer {
+class LRUKReplacer : public FrameReplacer {
  public:
   /**
    *
@@ -52,7 +56,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -70,7 +74,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -85,6 +89,9 @@ class LRUKReplacer {
    */
   void RecordAccess(frame_id_t frame_id);
 
+  /** @brief Record an access to a frame; LRU-K does not care which page the frame holds. */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override { RecordAccess(frame_id); }
+
   /**
    * TODO(P1): Add implementation
    *
@@ -102,7 +109,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +128,14 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * @brief List evictable frames in the order Evict() would pick them, without evicting anything.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count evictable frames, next victim first
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   /**
    * TODO(P1): Add implementation
@@ -130,15 +144,36 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
+  /** Access history and eviction state tracked for a single frame. */
+  struct FrameEntry {
+    /** Number of timestamps in the frame's ring, at most k; 0 if the frame is not tracked. */
+    size_t count_{0};
+    /** Ring index of the oldest timestamp kept, i.e. the k-th most recent access once the ring is full. */
+    size_t head_{0};
+    bool evictable_{false};
+  };
+
+  /**
+   * Eviction order of an evictable frame: frames with fewer than k accesses (+inf backward k-distance) come first,
+   * then the smaller oldest-kept timestamp, which is the earliest access or the k-th most recent one respectively.
+   */
+  using EvictionKey = std::tuple<bool, size_t, frame_id_t>;
+
+  /** @return the eviction key of a tracked frame. Caller must hold latch_. */
+  auto KeyOf(frame_id_t frame_id) const -> EvictionKey;
+
+  size_t current_timestamp_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  size_t k_;
+  std::vector<FrameEntry> entries_;
+  /** Access timestamps, k per frame: the ring of frame f is history_[f * k, (f + 1) * k). */
+  std::vector<size_t> history_;
+  /** Evictable frames, next victim first. */
+  std::set<EvictionKey> evictable_;
   std::mutex latch_;
 };
 
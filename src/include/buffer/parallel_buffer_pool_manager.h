@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager partitions the buffer pool into several independent BufferPoolManagerInstances, each
+ * with its own latch, page table, replacer and free list. A page always lives in the instance given by
+ * page_id % num_instances, so threads working on different pages rarely contend on the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerPolicy policy = ReplacerPolicy::LRU_K);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the total number of frames across all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return the page size shared by all instances */
+  auto GetPageSize() -> size_t override;
+
+  /**
+   * Forward the prefetch hint to the instances owning the pages.
+   * @param page_ids ids of the pages to read ahead
+   * @param access_type how the pages will be used
+   * @return true
+   */
+  auto PrefetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Scan)
+      -> bool override;
+
+  /**
+   * Interleave the resident pages of all instances, so that the hottest pages of every instance come first.
+   * @return ids of the resident pages
+   */
+  auto GetResidentPages() -> std::vector<page_id_t> override;
+
+  /**
+   * Switch the replacement policy of every instance.
+   * @param policy the new policy
+   * @return true
+   */
+  auto SetReplacerPolicy(ReplacerPolicy policy) -> bool override;
+
+  /**
+   * Add up the statistics of all instances.
+   * @param[out] stats the snapshot of the whole pool
+   * @return true
+   */
+  auto GetStats(BufferPoolStats *stats) -> bool override;
+
+  /** @return true if page_id is resident in the instance owning it */
+  auto IsPageResident(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Set the extent size of every instance, see BufferPoolManagerInstance::SetExtentSize. Call before the first
+   * page is created.
+   * @param extent_size pages per extent
+   */
+  void SetExtentSize(size_t extent_size);
+
+  /** @return the number of instances the pool is partitioned into */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Fetch the requested page from the instance owning it, passing the access hint along.
+   * @param page_id id of page to be fetched
+   * @param access_type the kind of access
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried in round-robin order, starting one past the instance
+   * that was tried first on the previous call, so new pages spread evenly across the pool.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Creates a new page like NewPgImp(page_id), passing the hints to the instance that creates it. A page with a
+   * near_page_id is created by the instance owning that page first, where its extent is, and only falls back to the
+   * round-robin order if that instance has no frame to spare.
+   * @param[out] page_id id of created page
+   * @param access_type the kind of access
+   * @param near_page_id a page to place the new one close to on disk, or INVALID_PAGE_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id, AccessType access_type, page_id_t near_page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The individual buffer pool shards; a page id maps to instances_[page_id % instances_.size()]. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Number of frames in each instance. */
+  const size_t pool_size_;
+  /** The instance NewPgImp tries first on its next call. */
+  std::atomic<size_t> start_index_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/frame_replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy (Johnson and Shasha, VLDB '94).
+ *
+ * A page read in for the first time enters the FIFO queue A1in, and repeated accesses while it is there do not move
+ * it, so a scan passes through A1in without disturbing anything else. Pages evicted from A1in are remembered in the
+ * ghost queue A1out; a page that comes back while it is still remembered was re-referenced over a longer period and
+ * goes to the LRU list Am. A1in is kept at about a quarter of the pool and A1out remembers half a pool of pages.
+ */
+class TwoQueueReplacer : public FrameReplacer {
+ public:
+  /**
+   * @brief Create a new TwoQueueReplacer.
+   * @param num_frames the number of frames in the buffer pool
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+ private:
+  /** A resident frame, kept in A1in or Am. */
+  struct FrameEntry {
+    page_id_t page_id_;
+    bool in_am_;
+    bool evictable_;
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** @return the least recently queued evictable frame of the list, or -1. Caller must hold latch_. */
+  auto FirstEvictable(const std::list<frame_id_t> &list) const -> frame_id_t;
+
+  size_t capacity_;
+  /** Target size of A1in. */
+  size_t kin_;
+  /** Number of pages A1out remembers. */
+  size_t kout_;
+  size_t curr_size_{0};
+  /** Resident frames, oldest first. */
+  std::list<frame_id_t> a1in_;
+  std::list<frame_id_t> am_;
+  std::unordered_map<frame_id_t, FrameEntry> entries_;
+  /** Pages evicted from A1in, oldest first. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -34,6 +34,7 @@ class Transaction;
 class ExecutorContext;
 class DiskManager;
 class BufferPoolManager;
+class BufferPoolWarmer;
 class LockManager;
 class TransactionManager;
 class LogManager;
@@ -211,9 +212,22 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance backed by a database file. The buffer pool is warmed up from the pages that were
+   * resident when the database was last shut down, and the resident page set is saved periodically from then on.
+   * @param db_file_name the database file
+   * @param page_size the page size of the database, a power of two between BUSTUB_PAGE_SIZE and BUSTUB_MAX_PAGE_SIZE
+   * @param pool_size the number of frames in the buffer pool
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t page_size = BUSTUB_PAGE_SIZE,
+                          size_t pool_size = BUSTUB_INSTANCE_POOL_SIZE);
 
-  BustubInstance();
+  /**
+   * Create an in-memory BusTub instance.
+   * @param page_size the page size of the database
+   * @param pool_size the number of frames in the buffer pool
+   */
+  explicit BustubInstance(size_t page_size = BUSTUB_PAGE_SIZE, size_t pool_size = BUSTUB_INSTANCE_POOL_SIZE);
 
   ~BustubInstance();
 
@@ -250,6 +264,8 @@ class BustubInstance {
   TransactionManager *txn_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  /** Saves and restores the resident page set of a file backed instance, nullptr for an in-memory one. */
+  BufferPoolWarmer *buffer_pool_warmer_{nullptr};
   Catalog *catalog_;
   ExecutionEngine *execution_engine_;
   std::shared_mutex catalog_lock_;
@@ -270,6 +286,7 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void DisplayBufferPoolStats(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
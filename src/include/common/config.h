@@ -27,15 +27,32 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running page cleaner wakes up every PAGE_CLEANER_INTERVAL to write back dirty frames. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** A running buffer pool warmer saves the resident page set every BUFFER_POOL_WARMUP_INTERVAL. */
+extern std::chrono::milliseconds buffer_pool_warmup_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // default page size in byte
+static constexpr int BUSTUB_MAX_PAGE_SIZE = 65536;                                   // largest page size in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr int BUSTUB_INSTANCE_POOL_SIZE = 128;                                // default BustubInstance pool size
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr double PAGE_CLEANER_TARGET_CLEAN_RATIO = 0.25;  // fraction of frames the page cleaner keeps clean
+static constexpr size_t PAGE_CLEANER_MAX_BATCH_SIZE = 32;        // max pages written back per page cleaner round
+static constexpr size_t REPLACER_REFERENCE_SYNC_BATCH = 8;  // replacer candidates checked for hits before evicting
+static constexpr size_t SCAN_RING_SIZE = 16;                 // max frames scans recycle before using the replacer
+static constexpr size_t TABLE_SCAN_READ_AHEAD = 4;           // table pages a sequential scan prefetches ahead
+static constexpr size_t DISK_IO_QUEUE_DEPTH = 32;            // async I/Os a DiskManagerDirect keeps in flight
+static constexpr size_t EXTENT_SIZE = 64;                    // pages reserved at a time for a growing object
+static constexpr size_t PAGE_IMAGE_LOG_CAPACITY = 256;       // pages the full page image log of a DiskManager holds
+static constexpr size_t COMPRESSED_SLOT_UNIT = 256;          // bytes DiskManagerCompressed rounds stored pages up to
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -49,6 +49,8 @@ enum class ExceptionType {
   NOT_IMPLEMENTED = 11,
   /** Execution exception. */
   EXECUTION = 12,
+  /** Unreadable or corrupted data on disk. */
+  IO = 13,
 };
 
 class Exception : public std::runtime_error {
@@ -104,6 +106,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::IO:
+        return "I/O";
       default:
         return "Unknown";
     }
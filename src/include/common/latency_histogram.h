@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/common/latency_histogram.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * LatencyHistogram counts latencies in power of two buckets: bucket i holds latencies in [2^i, 2^(i+1)) nanoseconds.
+ * Recording is a single relaxed atomic increment, so it can sit on the query path.
+ */
+class LatencyHistogram {
+ public:
+  /** Enough buckets for latencies up to about 18 minutes. */
+  static constexpr size_t NUM_BUCKETS = 40;
+  using Buckets = std::array<uint64_t, NUM_BUCKETS>;
+
+  /** @brief Record one latency. */
+  void Record(std::chrono::nanoseconds latency);
+
+  /** @brief Add the current bucket counts to buckets. */
+  void AddTo(Buckets *buckets) const;
+
+  /**
+   * @param buckets bucket counts of a histogram
+   * @param quantile the quantile, in [0, 1]
+   * @return an upper bound of the given quantile in nanoseconds, or 0 if the histogram is empty
+   */
+  static auto Quantile(const Buckets &buckets, double quantile) -> uint64_t;
+
+ private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+};
+
+}  // namespace bustub
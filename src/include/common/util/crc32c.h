@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli) checksums, the ones used by iSCSI, ext4 and most storage engines. On x86 CPUs
+ * with SSE4.2 it uses the crc32 instruction, eight bytes at a time; elsewhere it falls back to a table driven
+ * implementation that produces the same checksums.
+ */
+class Crc32c {
+ public:
+  /**
+   * @brief Compute the checksum of data, or extend a checksum with more data.
+   * @param crc the checksum of the data that came before, 0 to start a new checksum
+   * @return the checksum of everything up to and including data
+   */
+  static auto Compute(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** @brief Same as Compute, but always without the crc32 instruction. */
+  static auto ComputeSoftware(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Compute uses the crc32 instruction on this CPU */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.h
+//
+// Identification: src/include/common/util/lz4.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Lz4 compresses and decompresses blocks in the LZ4 block format: a sequence of literal runs, each followed by a copy
+ * of up to 64 KB back in the output. The compressor is the greedy single pass one of the reference implementation,
+ * which finds matches through a hash table of the last position of every four byte prefix. It trades ratio for speed,
+ * and decompression is little more than a memcpy per run, which makes it suitable for pages on their way to and from
+ * disk.
+ */
+class Lz4 {
+ public:
+  /** @return the largest compressed size of size bytes: input that does not compress grows a little */
+  static constexpr auto MaxCompressedSize(size_t size) -> size_t { return size + size / 255 + 16; }
+
+  /**
+   * @brief Compress a block.
+   * @param src the data to compress
+   * @param size the size of src
+   * @param[out] dst the output buffer
+   * @param capacity the size of dst
+   * @return the compressed size, or 0 if it would be larger than capacity
+   */
+  static auto Compress(const char *src, size_t size, char *dst, size_t capacity) -> size_t;
+
+  /**
+   * @brief Decompress a block.
+   * @param src the compressed data
+   * @param size the size of src
+   * @param[out] dst the output buffer
+   * @param dst_size the exact size of the decompressed block
+   * @return false if src is not a block of dst_size bytes, in which case dst holds garbage
+   */
+  static auto Decompress(const char *src, size_t size, char *dst, size_t dst_size) -> bool;
+};
+
+}  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// striped_hash_table.h
+//
+// Identification: src/include/container/hash/striped_hash_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+/**
+ * striped_hash_table.h
+ *
+ * Implementation of a concurrent in-memory hash table using lock striping
+ */
+
+#pragma once
+
+#include <array>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "container/hash/hash_table.h"
+
+namespace bustub {
+
+/**
+ * StripedHashTable splits its keys over a fixed number of independent stripes, each guarded by its own
+ * reader-writer latch. Lookups take the shared latch of one stripe, and taking even a shared latch writes to it,
+ * so contention is per stripe: readers of keys in different stripes touch no common cache line, while readers of
+ * keys in the same stripe, the same key included, do not block each other but still bounce that stripe's latch
+ * between their cores.
+ * @tparam K key type
+ * @tparam V value type
+ */
+template <typename K, typename V>
+class StripedHashTable : public HashTable<K, V> {
+ public:
+  /** Number of stripes. Must be a power of two. */
+  static constexpr size_t NUM_STRIPES = 64;
+
+  StripedHashTable() = default;
+
+  /**
+   * @brief Find the value associated with the given key.
+   * @param key The key to be searched.
+   * @param[out] value The value associated with the key.
+   * @return True if the key is found, false otherwise.
+   */
+  auto Find(const K &key, V &value) -> bool override;
+
+  /**
+   * @brief Insert the given key-value pair into the hash table. If the key already exists, the value is updated.
+   * @param key The key to be inserted.
+   * @param value The value to be inserted.
+   */
+  void Insert(const K &key, const V &value) override;
+
+  /**
+   * @brief Given the key, remove the corresponding key-value pair in the hash table.
+   * @param key The key to be deleted.
+   * @return True if the key exists, false otherwise.
+   */
+  auto Remove(const K &key) -> bool override;
+
+  /** @return the number of key-value pairs in the hash table */
+  auto Size() const -> size_t;
+
+ private:
+  /** One stripe of the table. Stripes are cache-line aligned so that latching one never invalidates another. */
+  struct alignas(64) Stripe {
+    mutable std::shared_mutex latch_;
+    std::unordered_map<K, V> map_;
+  };
+
+  /** @return the stripe responsible for the given key */
+  auto StripeOf(const K &key) -> Stripe &;
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -24,7 +24,8 @@ namespace bustub {
 
 /**
  * InsertExecutor executes an insert on a table.
- * Inserted values are always pulled from a child executor.
+ * Inserted values are always pulled from a child executor. When there are many of them, such as the rows of a
+ * ValuesExecutor, they can be gathered and inserted in batches with TableHeap::InsertTuples, a page at a time.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
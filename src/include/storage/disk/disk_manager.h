@@ -12,37 +12,100 @@
 
 #pragma once
 
+#include <sys/uio.h>
+
+#include <algorithm>
 #include <atomic>
-#include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/latency_histogram.h"
+#include "storage/disk/free_page_map.h"
 
 namespace bustub {
 
+/**
+ * How far a DiskManager pushes every write before returning. NONE leaves the data in the OS page cache, FLUSH also
+ * starts writing it back to the device, and FDATASYNC waits until it is on the device, which makes it durable.
+ */
+enum class DurabilityMode { NONE = 0, FLUSH, FDATASYNC };
+
+/**
+ * @brief Parse a durability mode name: none, flush or fdatasync, case insensitive.
+ * @param name the mode name
+ * @param[out] mode the parsed mode
+ * @return false if the name is unknown
+ */
+auto DurabilityModeFromString(const std::string &name, DurabilityMode *mode) -> bool;
+
+/** @return the name of the mode, as accepted by DurabilityModeFromString */
+auto DurabilityModeToString(DurabilityMode mode) -> std::string;
+
+/**
+ * What a DiskManager does with page checksums. NONE writes and reads pages as they are. VERIFY sets the CRC32C of
+ * every page written in its header, at Page::OFFSET_CHECKSUM, and fails reads of pages that do not match it, such as
+ * pages torn by a crash in the middle of their write. REPAIR also logs a full image of every page before writing it
+ * in place, and puts back the logged image of a page that fails its checksum.
+ */
+enum class ChecksumMode { NONE = 0, VERIFY, REPAIR };
+
+/**
+ * @brief Parse a checksum mode name: none, verify or repair, case insensitive.
+ * @param name the mode name
+ * @param[out] mode the parsed mode
+ * @return false if the name is unknown
+ */
+auto ChecksumModeFromString(const std::string &name, ChecksumMode *mode) -> bool;
+
+/** @return the name of the mode, as accepted by ChecksumModeFromString */
+auto ChecksumModeToString(ChecksumMode mode) -> std::string;
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O (pread/pwrite) on the database file, so there is no shared file
+ * cursor and I/Os from different threads, or different buffer pool instances, proceed concurrently without a latch.
+ * Every synchronous write of the database or log file is followed by whatever its DurabilityMode asks for; the batch
+ * writes pay for that once for the whole batch.
+ *
+ * The first page of the database file is its header page, which records the format version and the page size the file
+ * was created with, and a random id that tells it from other files, and page i is stored right after it. Opening a
+ * file of another format version or page size throws, instead of reading every page wrong.
+ *
+ * The disk manager also keeps the map of deallocated pages, which it loads when it opens the database file and saves
+ * when it shuts down, so that deleted pages are reused across restarts.
+ *
+ * In REPAIR checksum mode, page writes are serialized through the page image log, a ring of the last
+ * PAGE_IMAGE_LOG_CAPACITY page images kept next to the database file. A write logs the images of its pages, pushed
+ * as far as the durability mode asks, before it writes them in place, so a page torn by a crash can be put back from
+ * the log. The log is checked for torn pages when the database file is opened again, and removed on shut down.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database, see IsValidPageSize
+   * @throw Exception if the file exists but is not a database file, has another format version, or was created with
+   * another page size
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
-  DiskManager() = default;
+  explicit DiskManager(size_t page_size = BUSTUB_PAGE_SIZE);
 
   virtual ~DiskManager() = default;
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -52,12 +115,107 @@ class DiskManager {
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Write a run of consecutive pages to the database file with a single sequential write.
+   * @param first_page_id id of the first page of the run
+   * @param page_data raw data of num_pages pages, back to back
+   * @param num_pages number of pages in the run
+   */
+  virtual void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages);
+
+  /**
+   * Read a page from the database file. With checksums on, a page that fails its checksum is repaired from the page
+   * image log in REPAIR mode, and otherwise throws an Exception of type IO.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write a batch of pages, in any order, with one vectored write per run of consecutive page ids and a single flush
+   * or sync for the whole batch.
+   * @param pages id and raw data of every page, each page at most once
+   */
+  virtual void WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages);
+
+  /**
+   * Start reading a page. The default implementation reads it before returning.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the returned future is ready
+   * @return a future that becomes ready once page_data holds the page
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Start writing a page. The default implementation writes it before returning.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the returned future is ready
+   * @return a future that becomes ready once the page is written
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+    return WritePagesAsync(page_id, page_data, 1);
+  }
+
+  /**
+   * Start writing a run of consecutive pages. The default implementation writes them before returning.
+   * @param first_page_id id of the first page of the run
+   * @param page_data raw data of num_pages pages, which must stay valid and unchanged until the future is ready
+   * @param num_pages number of pages in the run
+   * @return a future that becomes ready once the pages are written
+   */
+  virtual auto WritePagesAsync(page_id_t first_page_id, const char *page_data, size_t num_pages) -> std::future<void>;
+
+  /**
+   * Take a deallocated page for reuse.
+   * @param stride the number of buffer pool instances sharing the page id space
+   * @param offset the index of the allocating instance; only pages with page_id % stride == offset are taken
+   * @param near_page_id a page the new one belongs with, to allocate close to, or INVALID_PAGE_ID
+   * @return the page to reuse, or INVALID_PAGE_ID if there is none and the file has to grow
+   */
+  auto AllocatePage(uint32_t stride, uint32_t offset, page_id_t near_page_id = INVALID_PAGE_ID) -> page_id_t {
+    return free_page_map_.Allocate(stride, offset, near_page_id);
+  }
+
+  /**
+   * Take the lowest deallocated page in [begin, end), or failing that the lowest page reserved in it by ReservePage.
+   * @param stride the number of buffer pool instances sharing the page id space
+   * @param offset the index of the allocating instance; only pages with page_id % stride == offset are taken
+   * @param begin the first page of the range, usually an extent of the buffer pool
+   * @param end one past the last page of the range
+   * @return the page to use, or INVALID_PAGE_ID if the range has no deallocated or reserved page left
+   */
+  auto AllocatePageIn(uint32_t stride, uint32_t offset, page_id_t begin, page_id_t end) -> page_id_t {
+    auto page_id = free_page_map_.AllocateIn(stride, offset, begin, end);
+    return page_id != INVALID_PAGE_ID ? page_id : reserved_page_map_.AllocateIn(stride, offset, begin, end);
+  }
+
+  /**
+   * Set a page that was never used aside for the extent it belongs to: only AllocatePageIn hands it out. The reserved
+   * pages still unused at ShutDown become free pages, so they are reused after a restart instead of being lost.
+   * @param page_id id of the page
+   */
+  void ReservePage(page_id_t page_id) { reserved_page_map_.Deallocate(page_id); }
+
+  /**
+   * Make a deleted page available for reuse by AllocatePage.
+   * @param page_id id of the page, which must no longer be in use
+   */
+  virtual void DeallocatePage(page_id_t page_id) { free_page_map_.Deallocate(page_id); }
+
+  /** @return the number of page ids in use, reserved or waiting to be reused: new pages get ids from there on */
+  auto GetNumPages() -> size_t {
+    auto data_size = std::max<int64_t>(db_file_size_.load() - data_offset_, 0);
+    auto file_pages = (static_cast<size_t>(data_size) + page_size_ - 1) / page_size_;
+    return std::max({file_pages, free_page_map_.GetEnd(), reserved_page_map_.GetEnd()});
+  }
+
+  /** @return the number of deallocated pages waiting to be reused */
+  auto GetNumFreePages() -> size_t { return free_page_map_.GetNumFreePages(); }
+
+  /** @return true if the page is deallocated, or reserved for an extent and not used yet: it holds no data */
+  auto IsPageFree(page_id_t page_id) -> bool {
+    return free_page_map_.IsFree(page_id) || reserved_page_map_.IsFree(page_id);
+  }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -74,6 +232,46 @@ class DiskManager {
    */
   auto ReadLog(char *log_data, int size, int offset) -> bool;
 
+  /**
+   * Append several log buffers with a single vectored write and a single flush or sync, so that the transactions
+   * committing with them share its cost.
+   * @param buffers raw data and size of every log buffer, in log order
+   */
+  void WriteLogBatch(const std::vector<std::pair<const char *, int>> &buffers);
+
+  /** @brief Set how far every subsequent write is pushed before it returns. */
+  inline void SetDurabilityMode(DurabilityMode mode) { durability_mode_ = mode; }
+
+  /** @return the current durability mode */
+  inline auto GetDurabilityMode() const -> DurabilityMode { return durability_mode_.load(); }
+
+  /** @brief Set what is done with the checksums of every subsequent read and write. Leaving REPAIR drops the log. */
+  void SetChecksumMode(ChecksumMode mode);
+
+  /** @return the current checksum mode */
+  inline auto GetChecksumMode() const -> ChecksumMode { return checksum_mode_.load(); }
+
+  /** @return the number of pages read that failed their checksum, repaired or not */
+  inline auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /** @return the number of pages put back from the page image log, when reading them or when opening the file */
+  inline auto GetNumRepairedPages() const -> int { return num_repaired_pages_; }
+
+  /** @return the checksum of a page, computed with its checksum field zeroed */
+  static auto ComputeChecksum(const char *page_data, size_t page_size) -> uint32_t;
+
+  /** @return the size in bytes of every page of this database */
+  inline auto GetPageSize() const -> size_t { return page_size_; }
+
+  /**
+   * @return the id drawn at random when the database file was created, which tells it from a file created since
+   * under the same name; 0 for the managers without a file
+   */
+  inline auto GetFileId() const -> uint64_t { return file_id_; }
+
+  /** @return true if page_size is a power of two between BUSTUB_PAGE_SIZE and BUSTUB_MAX_PAGE_SIZE */
+  static auto IsValidPageSize(size_t page_size) -> bool;
+
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
 
@@ -83,6 +281,15 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of fdatasync calls made on the database and log files */
+  auto GetNumSyncs() const -> int;
+
+  /** @brief Add the latencies of the flushes or syncs that followed writes of the database file to buckets. */
+  void GetDbSyncLatency(LatencyHistogram::Buckets *buckets) const { db_sync_latency_.AddTo(buckets); }
+
+  /** @brief Add the latencies of the flushes or syncs that followed writes of the log file to buckets. */
+  void GetLogSyncLatency(LatencyHistogram::Buckets *buckets) const { log_sync_latency_.AddTo(buckets); }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,19 +300,110 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
-  auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+  /** @return the offset of a page in the database file */
+  inline auto PageOffset(page_id_t page_id) const -> int64_t {
+    return data_offset_ + static_cast<int64_t>(page_id) * static_cast<int64_t>(page_size_);
+  }
+
+  /**
+   * @brief Check the header page of the database file open in db_fd_, or write it if the file is empty and writable.
+   * @throw Exception if the file is not a database file, has another format version, or was created with another page
+   * size
+   */
+  void OpenFileHeader(bool writable);
+
+  /** @brief Record that the database file now extends at least to end, the offset just past a write. */
+  void ExtendFileSize(int64_t end);
+
+  /**
+   * @brief Write iovcnt buffers back to back at offset of fd, retrying short writes.
+   * @return the number of bytes written, less than asked for only on error
+   */
+  static auto WriteFully(int fd, struct iovec *iov, int iovcnt, int64_t offset) -> size_t;
+
+  /**
+   * @brief Push the size bytes just written at offset of fd as far as the durability mode asks, and time it.
+   * @param latency the histogram of the file written
+   */
+  void ApplyDurability(int fd, int64_t offset, size_t size, LatencyHistogram *latency);
+
+  /**
+   * @brief Get a run of pages ready to be written under the checksum mode. With checksums on, the pages are copied to
+   * a buffer of the calling thread, aligned for direct I/O, and their checksums set. In REPAIR mode their images are
+   * also logged, and lock is left holding the page image latch until the caller has written them in place.
+   * @return the data to write, page_data itself if checksums are off
+   */
+  auto PrepareWrite(page_id_t first_page_id, const char *page_data, size_t num_pages,
+                    std::unique_lock<std::mutex> *lock) -> const char *;
+
+  /**
+   * @brief Same as PrepareWrite for a batch of pages, whose data pointers are replaced with the ones to write.
+   */
+  void PrepareWrite(std::vector<std::pair<page_id_t, const char *>> *pages, std::unique_lock<std::mutex> *lock);
+
+  /** @brief Set the checksum in the header of a page. */
+  void SetChecksum(char *page_data) const;
+
+  /** @return true if the page matches its checksum, or is all zeros, as pages never written are */
+  auto IsChecksumValid(const char *page_data) const -> bool;
+
+  /**
+   * @brief Check a page just read against its checksum, and repair it from the page image log if it does not match.
+   * @throw Exception of type IO if the page does not match and cannot be repaired
+   */
+  void CheckPage(page_id_t page_id, char *page_data);
+
+  /** @brief Append the images of pages, already checksummed, to the page image log. Needs page_image_latch_. */
+  void LogPageImages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /** @brief Read the last logged image of a page. @return false if it is no longer in the log */
+  auto ReadPageImage(page_id_t page_id, char *page_data) -> bool;
+
+  /** @brief Put back the pages left torn by a crash from the page image log of the last run, then drop it. */
+  void RepairTornPages();
+
+  /** @brief Close and remove the page image log. Needs page_image_latch_. */
+  void DropPageImageLog();
+
+  size_t page_size_;
+  // descriptor of the log file, appended to with write and read with pread
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  int64_t log_file_size_{0};
+  // descriptor of the db file, read and written with pread/pwrite
+  int db_fd_{-1};
   std::string file_name_;
+  // where page 0 starts in the db file, past its header page; 0 for the managers without a file
+  int64_t data_offset_{0};
+  // the id recorded in the header page of the db file, 0 for the managers without a file
+  uint64_t file_id_{0};
+  // size of the db file, kept up to date by the writes instead of stat()-ing the file on every read
+  std::atomic<int64_t> db_file_size_{0};
+  // deallocated pages, saved next to the db file
+  FreePageMap free_page_map_;
+  // pages reserved for buffer pool extents and not used yet, freed at shut down
+  FreePageMap reserved_page_map_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
+  std::atomic<DurabilityMode> durability_mode_{DurabilityMode::NONE};
+  std::atomic<ChecksumMode> checksum_mode_{ChecksumMode::NONE};
+  std::atomic<int> num_checksum_failures_{0};
+  std::atomic<int> num_repaired_pages_{0};
+  // the page image log: a ring of slots, each holding a header and a page image, opened by the first REPAIR write
+  std::mutex page_image_latch_;
+  int page_image_fd_{-1};
+  std::string page_image_name_;
+  size_t page_image_num_slots_{PAGE_IMAGE_LOG_CAPACITY};
+  size_t page_image_next_slot_{0};
+  uint64_t page_image_next_seq_{0};
+  // where the last image of every page still in the log is, and the page in every slot
+  std::unordered_map<page_id_t, size_t> page_image_slot_of_;
+  std::vector<page_id_t> page_image_page_of_;
+  LatencyHistogram db_sync_latency_;
+  LatencyHistogram log_sync_latency_;
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
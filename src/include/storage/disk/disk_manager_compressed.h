@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.h
+//
+// Identification: src/include/storage/disk/disk_manager_compressed.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerCompressed stores every page LZ4 compressed, in a slot of the database file just large enough for it,
+ * rounded up to COMPRESSED_SLOT_UNIT bytes. Pages that do not compress by at least a unit are stored as they are. An
+ * indirection map from page id to slot finds them again; ReadPage reads the slot and decompresses it into the frame.
+ * Tables of small, repetitive tuples take a fraction of the space, and each cold read transfers less data, at the cost
+ * of decompressing it.
+ *
+ * A page is never overwritten in place: every write goes to a free slot, and frees the slot the page had before only
+ * once it is written, so a crash never tears a page. That makes the page image log of REPAIR mode unnecessary, and
+ * REPAIR behaves like VERIFY. Every slot starts with a header naming its page, a sequence number and a checksum of
+ * the slot. The map is saved next to the database file on shut down; after a crash it is rebuilt from the slot
+ * headers, taking the last written slot of every page.
+ *
+ * A database file is either compressed or not: a file written by DiskManager cannot be read by this one.
+ */
+class DiskManagerCompressed : public DiskManager {
+ public:
+  /**
+   * Creates a new compressing disk manager.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database
+   */
+  explicit DiskManagerCompressed(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  /** Save the map of the slots, then close the files. */
+  void ShutDown() override;
+
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+  void WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  /** Free the slot of the page along with its page id. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return the bytes of the database file in use or free for reuse, its header page included */
+  auto GetFileSize() -> size_t;
+
+  /** @return the bytes of the slots in use, headers and rounding included */
+  auto GetStoredSize() -> size_t;
+
+  /** @return the number of pages stored compressed, as opposed to as they are */
+  auto GetNumCompressedPages() -> size_t;
+
+  /** @return the file the slot map of a database file is saved in: foo.db keeps it in foo.cpm */
+  static auto MapFileNameFor(const std::string &db_file_name) -> std::string;
+
+ private:
+  /** Where a page is stored. */
+  struct Slot {
+    /** The first unit of the slot. */
+    uint64_t unit_;
+    /** Orders the slots written for a page, the last one being its current one. */
+    uint64_t seq_;
+    /** The size of the stored page, page_size_ if stored as it is, 0 if the page has no slot. */
+    uint32_t size_;
+  };
+
+  /** @return the first unit after the header page of the file, where the slots start */
+  auto FirstUnit() const -> uint64_t { return static_cast<uint64_t>(data_offset_) / COMPRESSED_SLOT_UNIT; }
+
+  /** @return the number of units a slot storing size bytes spans */
+  static auto NumUnits(size_t size) -> uint64_t;
+
+  /** @brief Take num_units consecutive free units, growing the file if none fit. Needs latch_. */
+  auto AllocateUnits(uint64_t num_units) -> uint64_t;
+
+  /** @brief Give units back, merging them with their free neighbors. Needs latch_. */
+  void FreeUnits(uint64_t unit, uint64_t num_units);
+
+  /** @brief Make slot the one of page_id, unless a later one already is, and free whichever is not. Needs latch_. */
+  void InstallSlot(page_id_t page_id, const Slot &slot);
+
+  /** @brief Free the units of a slot in use and leave it empty. Needs latch_. */
+  void ReleaseSlot(Slot *slot);
+
+  /** @brief Replace the slot map with the one saved in a file. @return false if it is missing or malformed */
+  auto LoadMap(const std::string &file_name) -> bool;
+
+  /** @brief Save the slot map to a file, atomically. @return false if it cannot be written */
+  auto SaveMap(const std::string &file_name) -> bool;
+
+  /** @brief Rebuild the slot map from the slot headers of the database file, after a crash. */
+  void ScanSlots(int64_t file_size);
+
+  /** @brief Derive the free units and the end of the file from the slot map. */
+  void RebuildFreeUnits();
+
+  /** Protects the slot map and the free units. Reads hold it shared until they have read their slot. */
+  std::shared_mutex latch_;
+  /** The slot of every page id, indexed by page id. */
+  std::vector<Slot> slots_;
+  /** Runs of free units before end_unit_, by first unit. */
+  std::map<uint64_t, uint64_t> free_units_;
+  /** The units from there on are free, and past the end of the file once it is shut down. */
+  uint64_t end_unit_{0};
+  uint64_t next_seq_{1};
+  uint64_t stored_units_{0};
+  size_t num_compressed_pages_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_direct.h
+//
+// Identification: src/include/storage/disk/disk_manager_direct.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerDirect reads and writes the database file with O_DIRECT, so pages are cached once, in the buffer pool,
+ * instead of a second time in the OS page cache. Synchronous calls issue pread/pwrite on the calling thread without
+ * taking a latch, so I/Os from different threads proceed concurrently. Asynchronous calls are queued to an io_uring
+ * that keeps up to queue_depth I/Os in flight or, where io_uring is unavailable, to a pool of queue_depth I/O threads.
+ *
+ * O_DIRECT needs buffers aligned to the file system block size. Frames of the buffer pool arena are; other buffers
+ * are copied through an aligned bounce buffer. If the file system does not support O_DIRECT, the file is opened
+ * without it. The log file is still handled by DiskManager.
+ *
+ * Synchronous writes honor the durability mode like DiskManager's do; asynchronous ones are never flushed or synced.
+ * Checksums are set and verified like DiskManager's, but in REPAIR mode asynchronous writes are done synchronously,
+ * since each has to follow the logging of its page images.
+ */
+class DiskManagerDirect : public DiskManager {
+ public:
+  /** How asynchronous I/Os are carried out. */
+  enum class Backend { IO_URING, THREAD_POOL };
+
+  /**
+   * Creates a new direct I/O disk manager.
+   * @param db_file the file name of the database file to write to
+   * @param page_size the page size of the database
+   * @param queue_depth the maximum number of asynchronous I/Os in flight
+   * @param use_io_uring false to use the thread pool even if io_uring is available
+   */
+  explicit DiskManagerDirect(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE,
+                             size_t queue_depth = DISK_IO_QUEUE_DEPTH, bool use_io_uring = true);
+
+  ~DiskManagerDirect() override;
+
+  /** Wait for the I/Os in flight, stop the backend and close the files. Idempotent. */
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+  void WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+  auto WritePagesAsync(page_id_t first_page_id, const char *page_data, size_t num_pages) -> std::future<void> override;
+
+  /** @return the backend asynchronous I/Os go through */
+  auto GetBackend() const -> Backend { return ring_ != nullptr ? Backend::IO_URING : Backend::THREAD_POOL; }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirect() const -> bool { return is_direct_; }
+
+ private:
+  struct Request;
+  struct IoUring;
+
+  /**
+   * @brief Make a request for num_pages pages starting at page_id, with an aligned buffer to do the I/O on.
+   * @param set_checksums true to write the pages from a copy with their checksums set
+   */
+  auto MakeRequest(bool is_write, page_id_t page_id, char *page_data, size_t num_pages, bool set_checksums = false)
+      -> Request *;
+
+  /** @brief Do the I/O of a request with pread/pwrite. @return the bytes transferred, or -errno */
+  auto DoIo(Request *request) -> int64_t;
+
+  /**
+   * @brief Finish a request given the result of its I/O: copy out of the bounce buffer, check the pages read and
+   * fulfill its promise.
+   */
+  void Complete(Request *request, int64_t result);
+
+  /** @brief Hand a request to the backend. */
+  void Submit(Request *request);
+
+  /** @brief Try to set up an io_uring of queue_depth_ entries and start its completion thread. */
+  auto SetUpIoUring() -> bool;
+
+  /** @brief Put one entry on the submission queue and submit it. A null request is a no-op that stops the reaper. */
+  void SubmitToIoUring(Request *request);
+
+  /** @brief Body of the io_uring completion thread. */
+  void ReapIoUring();
+
+  /** @brief Body of an I/O thread of the thread pool backend. */
+  void RunWorker();
+
+  bool is_direct_{false};
+  const size_t queue_depth_;
+  bool is_shut_down_{false};
+
+  /** The io_uring backend, nullptr if the thread pool is used. */
+  IoUring *ring_{nullptr};
+
+  /** The thread pool backend: its threads and the queue they take requests from. */
+  std::vector<std::thread> workers_;
+  std::deque<Request *> queue_;
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+  bool stopping_{false};
+};
+
+}  // namespace bustub
@@ -9,7 +9,6 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
-#include <array>
 #include <cstring>
 #include <fstream>
 #include <future>  // NOLINT
@@ -34,7 +33,7 @@ namespace bustub {
  */
 class DiskManagerMemory : public DiskManager {
  public:
-  explicit DiskManagerMemory(size_t pages);
+  explicit DiskManagerMemory(size_t pages, size_t page_size = BUSTUB_PAGE_SIZE);
 
   ~DiskManagerMemory() override { delete[] memory_; }
 
@@ -45,6 +44,14 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /**
+   * Write a run of consecutive pages to the database file.
+   * @param first_page_id id of the first page of the run
+   * @param page_data raw data of num_pages pages, back to back
+   * @param num_pages number of pages in the run
+   */
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -62,7 +69,7 @@ class DiskManagerMemory : public DiskManager {
  */
 class DiskManagerUnlimitedMemory : public DiskManager {
  public:
-  DiskManagerUnlimitedMemory() = default;
+  explicit DiskManagerUnlimitedMemory(size_t page_size = BUSTUB_PAGE_SIZE) : DiskManager(page_size) {}
 
   /**
    * Write a page to the database file.
@@ -76,12 +83,27 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     }
     if (data_[page_id] == nullptr) {
       data_[page_id] = std::make_shared<ProtectedPage>();
+      data_[page_id]->first.resize(page_size_);
     }
     std::shared_ptr<ProtectedPage> ptr = data_[page_id];
     std::unique_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+    memcpy(ptr->first.data(), page_data, page_size_);
+    // so that GetNumPages counts the pages written, as it does for a file
+    ExtendFileSize(PageOffset(page_id + 1));
+  }
+
+  /**
+   * Write a run of consecutive pages to the database file.
+   * @param first_page_id id of the first page of the run
+   * @param page_data raw data of num_pages pages, back to back
+   * @param num_pages number of pages in the run
+   */
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override {
+    for (size_t i = 0; i < num_pages; i++) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), page_data + i * page_size_);
+    }
   }
 
   /**
@@ -103,12 +125,12 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     std::shared_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
+    memcpy(page_data, ptr->first.data(), page_size_);
   }
 
  private:
   std::mutex mutex_;
-  using Page = std::array<char, BUSTUB_PAGE_SIZE>;
+  using Page = std::vector<char>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
   std::vector<std::shared_ptr<ProtectedPage>> data_;
 };
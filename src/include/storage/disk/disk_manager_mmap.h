@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap opens a database file read only and maps it into memory, for replicas that only serve reads. Pages
+ * can be read as from any disk manager, copied out of the mapping, or viewed in place with MapPage, which is how
+ * BufferPoolManagerMmap hands them out without copying them into frames. The OS page cache is then the only cache: it
+ * reads pages in on their first access and evicts them under memory pressure.
+ *
+ * The file is mapped as it is when opened. Every write or deallocation throws, and neither the log file, the free page
+ * map nor the page image log is opened or touched. In REPAIR checksum mode there is no image to repair a page from,
+ * so it behaves like VERIFY.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Maps an existing database file.
+   * @param db_file the file name of the database file to map
+   * @param page_size the page size of the database
+   * @throw Exception if the file cannot be opened or mapped, or is not a database file of that page size
+   */
+  explicit DiskManagerMmap(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~DiskManagerMmap() override;
+
+  /** Unmap and close the database file. Idempotent. */
+  void ShutDown() override;
+
+  /** Throws: the database is read only. */
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override;
+  /** Throws: the database is read only. */
+  void WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) override;
+  /** Throws: the database is read only. */
+  void DeallocatePage(page_id_t page_id) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * @brief View a page in place, in the mapping. With checksums on, the page is verified first.
+   * @param page_id id of the page
+   * @return the page data, valid until shut down, or nullptr if the page is not wholly in the file
+   * @throw Exception of type IO if the page fails its checksum
+   */
+  auto MapPage(page_id_t page_id) -> const char *;
+
+  /** @brief Ask the OS to start reading a run of pages into the page cache, without waiting for it. */
+  void WillNeed(page_id_t first_page_id, size_t num_pages);
+
+  /** @return the number of pages wholly in the mapping, which MapPage can view */
+  auto GetNumMappedPages() const -> size_t {
+    auto data_offset = static_cast<size_t>(data_offset_);
+    return mapping_size_ > data_offset ? (mapping_size_ - data_offset) / page_size_ : 0;
+  }
+
+ private:
+  /** @brief Count and throw if a page of the mapping fails its checksum. */
+  void VerifyPage(page_id_t page_id, const char *page_data);
+
+  char *mapping_{nullptr};
+  size_t mapping_size_{0};
+};
+
+}  // namespace bustub
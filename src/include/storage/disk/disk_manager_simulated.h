@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.h
+//
+// Identification: src/include/storage/disk/disk_manager_simulated.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/latency_histogram.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** The devices DiskManagerSimulated has a profile of. */
+enum class SimulatedDevice { HDD = 0, SATA_SSD, NVME };
+
+/**
+ * @brief Parse a simulated device name: hdd, sata_ssd or nvme, case insensitive.
+ * @param name the device name
+ * @param[out] device the parsed device
+ * @return false if the name is unknown
+ */
+auto SimulatedDeviceFromString(const std::string &name, SimulatedDevice *device) -> bool;
+
+/** @return the name of the device, as accepted by SimulatedDeviceFromString */
+auto SimulatedDeviceToString(SimulatedDevice device) -> std::string;
+
+/**
+ * How long a simulated device takes over an I/O. Every I/O waits for a free queue slot, then for its latency, plus the
+ * seek latency if it does not start where the previous one ended; its transfer then takes its size over the bandwidth,
+ * which all I/Os share, so transfers queue behind each other. The default profile is an instant device.
+ */
+struct DeviceProfile {
+  std::chrono::nanoseconds read_latency_{0};
+  std::chrono::nanoseconds write_latency_{0};
+  /** Added to I/Os that are not sequential, the head movement of a disk. */
+  std::chrono::nanoseconds seek_latency_{0};
+  /** Bytes transferred per second, 0 for no limit. */
+  uint64_t bandwidth_{0};
+  /** I/Os in flight at once, 0 for no limit. */
+  size_t queue_depth_{0};
+
+  /** @return the profile of a typical device of the given kind */
+  static auto Of(SimulatedDevice device) -> DeviceProfile;
+};
+
+/** One I/O seen by DiskManagerSimulated. */
+struct IoTraceRecord {
+  bool is_write_;
+  page_id_t page_id_;
+  uint32_t num_pages_;
+  /** When it was issued, since the disk manager was created. */
+  std::chrono::nanoseconds issued_;
+  /** From issue to completion, waiting for a queue slot included. */
+  std::chrono::nanoseconds latency_;
+};
+
+/**
+ * DiskManagerSimulated keeps the pages in memory, like DiskManagerUnlimitedMemory, but makes every I/O take as long as
+ * it would on a device of the given profile, so that the effect of prefetching, write-back or I/O scheduling on a
+ * real disk can be measured without one. Every read, and every run of consecutive pages written, is one I/O.
+ *
+ * With the real clock, an I/O sleeps until the simulated device completes it, and I/Os from different threads overlap
+ * up to the queue depth; sleeps of a few microseconds overshoot by the wake up latency of the OS. With the virtual
+ * clock, nothing sleeps: every I/O starts when the one before completed, as if issued back to back by a single thread,
+ * and the clock only advances by the simulated time. A benchmark then gets the same device time on every run and
+ * every machine, but queue depth has no effect.
+ *
+ * Every I/O can also be recorded, with its latency, in a trace.
+ */
+class DiskManagerSimulated : public DiskManagerUnlimitedMemory {
+ public:
+  /**
+   * Creates a new simulated device.
+   * @param profile how long I/Os take
+   * @param use_virtual_clock true to advance a virtual clock instead of sleeping
+   * @param page_size the page size of the database
+   */
+  explicit DiskManagerSimulated(const DeviceProfile &profile, bool use_virtual_clock = false,
+                                size_t page_size = BUSTUB_PAGE_SIZE);
+
+  void WritePage(page_id_t page_id, const char *page_data) override { WritePages(page_id, page_data, 1); }
+  void WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Write every run of consecutive page ids with one I/O, in page id order. */
+  void WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  /** @return the number of reads */
+  auto GetNumReads() const -> uint64_t { return num_reads_; }
+
+  /**
+   * @return the time from the creation of the disk manager to the completion of its last I/O: the simulated run time
+   * of the I/Os with the virtual clock
+   */
+  auto GetDeviceTime() -> std::chrono::nanoseconds;
+
+  /** @brief Add the latencies of the reads to buckets. */
+  void GetReadLatency(LatencyHistogram::Buckets *buckets) const { read_latency_.AddTo(buckets); }
+
+  /** @brief Add the latencies of the writes to buckets. */
+  void GetWriteLatency(LatencyHistogram::Buckets *buckets) const { write_latency_.AddTo(buckets); }
+
+  /** @brief Start or stop recording every I/O in the trace. */
+  void SetTracing(bool enabled);
+
+  /** @return the I/Os recorded so far, in the order they were issued */
+  auto GetTrace() -> std::vector<IoTraceRecord>;
+
+  /**
+   * @brief Save the trace to a file, one I/O per line: R or W, the first page id, the number of pages, and the issue
+   * time and latency in microseconds.
+   * @return false if the file cannot be written
+   */
+  auto SaveTrace(const std::string &file_name) -> bool;
+
+ private:
+  /** @brief Wait for the simulated device to carry out an I/O of num_pages pages starting at page_id. */
+  void Simulate(bool is_write, page_id_t page_id, size_t num_pages);
+
+  using Clock = std::chrono::steady_clock;
+
+  const DeviceProfile profile_;
+  const bool use_virtual_clock_;
+  const Clock::time_point start_;
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+  /** Times since start_: the virtual clock, when the transfers in flight end, and when the last I/O completes. */
+  std::chrono::nanoseconds virtual_now_{0};
+  std::chrono::nanoseconds transfer_end_{0};
+  std::chrono::nanoseconds last_completion_{0};
+  /** The page just past the last I/O, where the next one is sequential. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  bool tracing_{false};
+  std::vector<IoTraceRecord> trace_;
+
+  std::atomic<uint64_t> num_reads_{0};
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+};
+
+}  // namespace bustub
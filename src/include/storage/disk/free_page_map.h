@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreePageMap is a bitmap of the deallocated pages of a database file, one bit per page id, so that their space is
+ * reused by later allocations instead of growing the file. Allocation can be restricted to the page ids a buffer pool
+ * instance owns (the ones congruent to its index modulo the number of instances), and prefers the free page closest
+ * to a hint, so that pages allocated together for one object stay close together on disk.
+ *
+ * The map is saved to its own file next to the database file, which is replaced atomically. The disk manager saves
+ * it on shutdown and removes it as soon as it is loaded, so a crash leaks the free pages instead of leaving a stale
+ * map that would hand out a page reused since.
+ */
+class FreePageMap {
+ public:
+  FreePageMap() = default;
+
+  /** @brief Mark a page as free. */
+  void Deallocate(page_id_t page_id);
+
+  /**
+   * @brief Take a free page among the ones with page_id % stride == offset.
+   * @param stride the number of buffer pool instances sharing the page id space
+   * @param offset the index of the allocating instance
+   * @param near_page_id the page to allocate close to, or INVALID_PAGE_ID to take the lowest free page
+   * @return the page, no longer free, or INVALID_PAGE_ID if there is no free page to take
+   */
+  auto Allocate(uint32_t stride, uint32_t offset, page_id_t near_page_id = INVALID_PAGE_ID) -> page_id_t;
+
+  /**
+   * @brief Take the lowest free page in [begin, end) among the ones with page_id % stride == offset.
+   * @return the page, no longer free, or INVALID_PAGE_ID if there is no free page in the range
+   */
+  auto AllocateIn(uint32_t stride, uint32_t offset, page_id_t begin, page_id_t end) -> page_id_t;
+
+  /** @brief Mark every page of this map free in another map, and empty this one. */
+  void MoveTo(FreePageMap *other);
+
+  /** @return true if the page is free */
+  auto IsFree(page_id_t page_id) -> bool;
+
+  /** @return one past the highest free page, 0 if there is none */
+  auto GetEnd() -> size_t;
+
+  /** @return the number of free pages */
+  auto GetNumFreePages() -> size_t;
+
+  /** @return the file the map of a database file is saved in: foo.db keeps its free pages in foo.fpm */
+  static auto FileNameFor(const std::string &db_file_name) -> std::string;
+
+  /**
+   * @brief Replace the map with the one saved in a file.
+   * @return false if the file is missing or malformed, in which case the map is left empty
+   */
+  auto Load(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Save the map to a file. A crash while saving leaves the previous map in place.
+   * @return false if the file cannot be written
+   */
+  auto Save(const std::string &file_name) -> bool;
+
+ private:
+  /** Written at the start of the file, to recognize it. */
+  static constexpr uint32_t MAGIC = 0x4650474d;  // "MGPF"
+
+  std::mutex latch_;
+  /** Bit i % 64 of words_[i / 64] is set if page i is free. */
+  std::vector<uint64_t> words_;
+  size_t num_free_pages_{0};
+};
+
+}  // namespace bustub
@@ -39,8 +39,9 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // A max size of 0 sizes the nodes to fill a page of the buffer pool's page size.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = 0, int internal_max_size = 0);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -78,9 +79,9 @@ class BPlusTree {
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
-  void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
+  void ToGraph(const BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
-  void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
+  void ToString(const BPlusTreePage *page, BufferPoolManager *bpm) const;
 
   // member variable
   std::string index_name_;
@@ -31,6 +31,8 @@ namespace bustub {
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
+ *  Every page starts with HASH_TABLE_PAGE_HEADER_SIZE bytes left for the page
+ *  header, which holds the checksum the disk manager sets.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -139,6 +141,11 @@ class HashTableBlockPage {
   void PrintBucket();
 
  private:
+  /** Never called: holds the checks that the fields sit where the page header of every page leaves them room. */
+  static void CheckLayout();
+
+  // The page id and LSN, unused here, and the checksum set by the disk manager, see Page::OFFSET_CHECKSUM.
+  char page_header_[HASH_TABLE_PAGE_HEADER_SIZE] __attribute__((__unused__));
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
@@ -32,6 +32,8 @@ namespace bustub {
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  Every page starts with HASH_TABLE_PAGE_HEADER_SIZE bytes left for the page
+ *  header, which holds the checksum the disk manager sets.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -138,6 +140,11 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** Never called: holds the checks that the fields sit where the page header of every page leaves them room. */
+  static void CheckLayout();
+
+  // The page id and LSN, unused here, and the checksum set by the disk manager, see Page::OFFSET_CHECKSUM.
+  char page_header_[HASH_TABLE_PAGE_HEADER_SIZE] __attribute__((__unused__));
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
@@ -28,7 +28,7 @@ namespace bustub {
  *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * | PageId(4) | LSN (4) | Checksum (4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1520)
  * --------------------------------------------------------------------------------------------
  */
 class HashTableDirectoryPage {
@@ -187,8 +187,13 @@ class HashTableDirectoryPage {
   void PrintDirectory();
 
  private:
+  /** Never called: holds the checks that the fields sit where the page header of every page leaves them room. */
+  static void CheckLayout();
+
   page_id_t page_id_;
   lsn_t lsn_;
+  // set by the disk manager, see Page::OFFSET_CHECKSUM
+  uint32_t checksum_ __attribute__((__unused__));
   uint32_t global_depth_{0};
   uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
@@ -14,6 +14,12 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
+/**
+ * HASH_TABLE_PAGE_HEADER_SIZE is the space block and bucket pages leave at their start for the header every page starts
+ * with: its page id and LSN, unused by these pages, and the checksum the disk manager sets, see Page::OFFSET_CHECKSUM.
+ */
+#define HASH_TABLE_PAGE_HEADER_SIZE 12
+
 /**
  * Linear Probe Hashing Definitions
  */
@@ -26,7 +32,7 @@
  * (MappingType) + 1) = BUSTUB_PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
  * to maintain the occupied and readable flags for a key value pair.
  */
-#define BLOCK_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - HASH_TABLE_PAGE_HEADER_SIZE) / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
@@ -38,12 +44,12 @@
  * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
  * of search, insertion, removal, and helper methods.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - HASH_TABLE_PAGE_HEADER_SIZE) / (4 * sizeof(MappingType) + 1))
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
  * This is 512 because the directory array must grow in powers of 2, and 1024 page_ids leaves zero room for
- * storage of the other member variables: page_id_, lsn_, global_depth_, and the array local_depths_.
+ * storage of the other member variables: page_id_, lsn_, checksum_, global_depth_, and the array local_depths_.
  * Extending the directory implementation to span multiple pages would be a meaningful improvement to the
  * implementation.
  */
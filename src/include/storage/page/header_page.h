@@ -22,9 +22,9 @@ namespace bustub {
  * 32 bytes) and their corresponding root_id
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------------
+ * | RecordCount (4) | Unused (4) | Checksum (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ *  ------------------------------------------------------------------------------------------------
  */
 class HeaderPage : public Page {
  public:
@@ -41,6 +41,9 @@ class HeaderPage : public Page {
   auto GetRecordCount() -> int;
 
  private:
+  /** Records start after the common page header. */
+  static constexpr int OFFSET_RECORDS = SIZE_PAGE_HEADER;
+
   /**
    * helper functions
    */
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +26,26 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data of a buffer pool frame lives in the pool's FrameArena, and the Page only points at it; a Page created on
+ * its own owns its data.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class BufferPoolManagerMmap;
+  // The disk manager sets and verifies the checksum in the page header.
+  friend class DiskManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page that owns its data. Zeros out the page data. */
+  explicit Page(size_t size) : owned_data_(new char[size]), data_(owned_data_.get()), size_(size) { ResetMemory(); }
+
+  /** Constructor for a page of the default size that owns its data. */
+  Page() : Page(BUSTUB_PAGE_SIZE) {}
+
+  /** Constructor for a buffer pool frame. The data is owned by the buffer pool and must be zeroed already. */
+  Page(char *data, size_t size) : data_(data), size_(size) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -39,20 +53,30 @@ class Page {
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
 
+  /** @return the size of the page data in bytes */
+  inline auto GetPageSize() const -> size_t { return size_; }
+
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
-  /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  /** @return the pin count of this page, or -1 while the buffer pool manager is (re)assigning the frame */
+  inline auto GetPinCount() -> int { return pin_count_.load(); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version is odd while a writer holds it. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +84,24 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Begin an optimistic read, which takes no latch and so writes nothing that other readers share. The page must be
+   * pinned. Whatever is read before OptimisticValidate(version) succeeds may be torn by a concurrent writer, so
+   * offsets read from the page must be bounds-checked before they are followed.
+   * @param[out] version the page version to validate against
+   * @return false if a writer holds the latch, in which case take the read latch instead
+   */
+  inline auto TryOptimisticLatch(uint64_t *version) -> bool {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if no writer has latched the page since TryOptimisticLatch returned version */
+  inline auto OptimisticValidate(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -70,24 +112,40 @@ class Page {
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
 
-  static constexpr size_t SIZE_PAGE_HEADER = 8;
+  /**
+   * Every page starts with its id (or type), its LSN and its checksum, which the disk manager sets on the way to disk
+   * and verifies on the way back. Page layouts leave the checksum alone.
+   */
+  static constexpr size_t SIZE_PAGE_HEADER = 12;
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_CHECKSUM = 8;
 
  private:
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, size_); }
 
+  /** Backing storage of a page that owns its data, empty for buffer pool frames. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
+  char *data_;
+  /** The size of the data, the page size of the database the page belongs to. */
+  size_t size_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /**
+   * The pin count of this page. Pins on resident pages are taken without the buffer pool latch, so the count is
+   * atomic; -1 means the frame is claimed by the buffer pool manager and cannot be pinned.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** True if the page was pinned through the latch-free hit path since the replacer last saw it. */
+  std::atomic<bool> is_referenced_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped when the write latch is taken and again when it is released, for optimistic readers. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard owns one pin on a buffer pool page and unpins it when it is dropped or destroyed, marking the page
+ * dirty if it was modified through the guard. Guards are move-only, so a pin has exactly one owner at any time.
+ *
+ * Page layouts come in two flavors: subclasses of Page such as TablePage, reached with GetPage<T>(), and plain structs
+ * overlaid on the page data such as BPlusTreePage, reached with As<T>() and AsMut<T>().
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /**
+   * @brief Take over a pin on page. A null page makes an empty guard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned page, or nullptr
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
+
+  /** @brief Move the pin of that into a new guard, leaving that empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** @brief Drop the pin held by this guard, then move the pin of that into it. */
+  auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard &;
+
+  /** @brief Drop the pin. */
+  ~BasicPageGuard();
+
+  /** @brief Unpin the page, dirty if it was modified through the guard, and empty the guard. Idempotent. */
+  void Drop();
+
+  /**
+   * @brief Take the page's read latch and hand the pin over to a ReadPageGuard, leaving this guard empty.
+   * @return the read guard
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
+  /**
+   * @brief Take the page's write latch and hand the pin over to a WritePageGuard, leaving this guard empty.
+   * @return the write guard
+   */
+  auto UpgradeWrite() -> WritePageGuard;
+
+  /** @return true if the guard holds a pin, false if it is empty (moved from, dropped, or the fetch failed) */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  auto PageId() const -> page_id_t { return page_->GetPageId(); }
+
+  /** @return the guarded page as a Page subclass such as TablePage */
+  template <class T = Page>
+  auto GetPage() const -> T * {
+    return static_cast<T *>(page_);
+  }
+
+  /** @brief Unpin the page as dirty when the guard is dropped. */
+  void SetDirty() { is_dirty_ = true; }
+
+  /** @return the page data, read-only */
+  auto GetData() const -> const char * { return page_->GetData(); }
+
+  /** @return the page data as a struct overlaid on it, read-only */
+  template <class T>
+  auto As() const -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the page data, marking the page dirty */
+  auto GetDataMut() -> char * {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the page data as a struct overlaid on it, marking the page dirty */
+  template <class T>
+  auto AsMut() -> T * {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard owns one pin and the read latch on a page. Dropping it releases the latch, then the pin.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /**
+   * @brief Take over a pin and read latch on page, both already acquired. A null page makes an empty guard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned and read latched page, or nullptr
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
+
+  /** @brief Move the pin and latch of that into a new guard, leaving that empty. */
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** @brief Release the pin and latch held by this guard, then move those of that into it. */
+  auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &;
+
+  /** @brief Release the latch and the pin. */
+  ~ReadPageGuard();
+
+  /** @brief Release the latch, unpin the page, and empty the guard. Idempotent. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  /** @return the guarded page as a Page subclass, which must only be read */
+  template <class T = Page>
+  auto GetPage() const -> T * {
+    return guard_.GetPage<T>();
+  }
+
+  /** @return the page data */
+  auto GetData() const -> const char * { return guard_.GetData(); }
+
+  /** @return the page data as a struct overlaid on it */
+  template <class T>
+  auto As() const -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard owns one pin and the write latch on a page. Dropping it releases the latch, then the pin.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /**
+   * @brief Take over a pin and write latch on page, both already acquired. A null page makes an empty guard.
+   * @param bpm the buffer pool manager the page is pinned in
+   * @param page the pinned and write latched page, or nullptr
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
+
+  /** @brief Move the pin and latch of that into a new guard, leaving that empty. */
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** @brief Release the pin and latch held by this guard, then move those of that into it. */
+  auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard &;
+
+  /** @brief Release the latch and the pin. */
+  ~WritePageGuard();
+
+  /** @brief Release the latch, unpin the page, and empty the guard. Idempotent. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  /** @return the guarded page as a Page subclass. Call SetDirty() if it is modified through it. */
+  template <class T = Page>
+  auto GetPage() const -> T * {
+    return guard_.GetPage<T>();
+  }
+
+  /** @brief Unpin the page as dirty when the guard is dropped. */
+  void SetDirty() { guard_.SetDirty(); }
+
+  /** @return the page data, read-only */
+  auto GetData() const -> const char * { return guard_.GetData(); }
+
+  /** @return the page data as a struct overlaid on it, read-only */
+  template <class T>
+  auto As() const -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return the page data, marking the page dirty */
+  auto GetDataMut() -> char * { return guard_.GetDataMut(); }
+
+  /** @return the page data as a struct overlaid on it, marking the page dirty */
+  template <class T>
+  auto AsMut() -> T * {
+    return guard_.AsMut<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
@@ -33,13 +33,16 @@ namespace bustub {
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
- *  ----------------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| Checksum (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  ----------------------------------------------------------------------------------------------
  *  ----------------------------------------------------------------
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ * Applying a delete only empties the slot of the tuple: the bytes of the tuple are left as a hole among the others,
+ * and the slot is reused by the next insert. Holes are reclaimed by Compact, which an insert or update calls when the
+ * free space alone is too small but the holes make up for it.
  */
 class TablePage : public Page {
  public:
@@ -107,7 +110,10 @@ class TablePage : public Page {
   auto UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                    LockManager *lock_manager, LogManager *log_manager) -> bool;
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert. The slot is emptied, and given
+   * back to the free space if it is the last one.
+   */
   void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
@@ -123,6 +129,15 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Read a tuple from a table without latching the page, validating against a version from TryOptimisticLatch.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param version the page version the read started at
+   * @return true if the tuple exists and was read consistently; otherwise read it again under the read latch
+   */
+  auto GetTupleOptimistic(const RID &rid, Tuple *tuple, uint64_t version) -> bool;
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -138,17 +153,36 @@ class TablePage : public Page {
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
 
+  /**
+   * Move the tuples together at the end of the page, turning the holes left by deleted tuples into free space, and
+   * give the empty slots at the end of the slot array back to it. The rids of the tuples do not change.
+   * @return true if the page changed
+   */
+  auto Compact() -> bool;
+
+  /** @return the bytes of the holes left by deleted tuples, which Compact turns into free space */
+  auto GetFragmentedSpace() -> uint32_t;
+
+  /** @return the size of the largest tuple an insert is sure to fit, compacting the page if it has to */
+  auto GetFreeSpaceForInsert() -> uint32_t;
+
+  /**
+   * @note returned tuple count may be an overestimate because some slots may be empty
+   * @return at least the number of tuples in this page
+   */
+  auto GetTupleCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
-  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-  static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = SIZE_PAGE_HEADER;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 16;
+  static constexpr size_t OFFSET_FREE_SPACE = 20;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
 
   /** @return pointer to the end of the current free space, see header comment */
   auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
@@ -158,12 +192,6 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
-  /**
-   * @note returned tuple count may be an overestimate because some slots may be empty
-   * @return at least the number of tuples in this page
-   */
-  auto GetTupleCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
-
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
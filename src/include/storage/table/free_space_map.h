@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks roughly how much free space each page of a table heap has, so that an insert goes straight to a
+ * page with room instead of walking the pages of the table.
+ *
+ * The free space of a page is kept as one of 256 categories, each a 256th of the page: a page of category c has at
+ * least c / 256 of a page free. The categories are the leaves of a binary tree whose every node holds the largest
+ * category below it, so that the first page, in table order, with room for a tuple is found, and the category of a
+ * page updated, in O(log pages), without touching the pages themselves.
+ *
+ * The map is only a hint: its caller corrects the category of a page that turns out to be too full. It is not saved:
+ * the table heap rebuilds it from its pages when it is opened, one read per page.
+ */
+class FreeSpaceMap {
+ public:
+  /** @param page_size the page size of the database */
+  explicit FreeSpaceMap(size_t page_size);
+
+  /** @brief Add a page at the end of the table, with free_space bytes free. */
+  void AddPage(page_id_t page_id, uint32_t free_space);
+
+  /** @brief Set the free space of a page, if it is in the map. */
+  void Update(page_id_t page_id, uint32_t free_space);
+
+  /** @brief Remove a page deleted from the table. */
+  void RemovePage(page_id_t page_id);
+
+  /** @return the first page with at least size bytes free, according to the map, or INVALID_PAGE_ID if there is none */
+  auto FindPage(uint32_t size) -> page_id_t;
+
+  /** @return the page added last, the last page of the table, or INVALID_PAGE_ID if the map is empty */
+  auto GetLastPageId() -> page_id_t;
+
+  /** @return the number of pages in the map */
+  auto GetNumPages() -> size_t;
+
+ private:
+  static constexpr uint32_t NUM_CATEGORIES = 256;
+
+  /** @return the category of a page with free_space bytes free, rounded down */
+  auto ToCategory(uint32_t free_space) const -> uint8_t;
+
+  void SetCategory(size_t index, uint8_t category);
+
+  const size_t page_size_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** The pages in table order, INVALID_PAGE_ID for a page removed since. */
+  std::vector<page_id_t> pages_;
+  std::unordered_map<page_id_t, size_t> index_;
+  /** The max tree, node i has children 2i and 2i + 1, and leaf capacity_ + i holds the category of pages_[i]. */
+  std::vector<uint8_t> tree_;
+  size_t capacity_{1};
+};
+
+}  // namespace bustub
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -51,7 +54,8 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table, in the first page the free space map finds room in, or in a new page appended to the
+   * table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +63,17 @@ class TableHeap {
    */
   auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
 
+  /**
+   * Insert a batch of tuples into the table, filling each page with as many of them as it takes under a single latch,
+   * instead of looking up, latching and unpinning a page per tuple. If one of the tuples is too large (>= page_size),
+   * none is inserted and false is returned.
+   * @param tuples the tuples to insert
+   * @param[out] rids the rids of the inserted tuples are appended to it, in the order of the tuples
+   * @param txn the transaction performing the insert
+   * @return true iff every tuple is inserted
+   */
+  auto InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool;
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -95,9 +110,20 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param acquire_read_lock whether to latch the page; false if the caller already holds the page latch
+   * @param access_type buffer pool access hint; table iterators pass AccessType::Scan
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true,
+                AccessType access_type = AccessType::Lookup) -> bool;
+
+  /**
+   * Compact every page of the table, and unlink and delete the pages left without tuples, but the first one. Only run
+   * it while no other transaction uses the table: the tuples deleted but not yet applied keep their pages.
+   * @param txn the transaction performing the vacuum
+   * @return the number of pages deleted
+   */
+  auto Vacuum(Transaction *txn) -> size_t;
 
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
@@ -109,10 +135,28 @@ class TableHeap {
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
  private:
+  /**
+   * Insert tuples into the latched page, from begin on, until one does not fit.
+   * @return the index of the first tuple not inserted
+   */
+  auto FillPage(WritePageGuard *guard, const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids,
+                Transaction *txn) -> size_t;
+
+  /**
+   * Move the guard of a page without room to the next page of the table, appending a new page after the last one.
+   * @return false if no page could be appended, the transaction is then aborted
+   */
+  auto NextPageForInsert(WritePageGuard *cur_guard, Transaction *txn) -> bool;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /**
+   * How much room each page of the table has, kept up to date by every change to a page. It lives in memory only, and
+   * is rebuilt from the pages of the table when the table is opened.
+   */
+  FreeSpaceMap free_space_map_;
 };
 
 }  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cassert>
+#include <deque>
 
 #include "common/rid.h"
 #include "concurrency/transaction.h"
@@ -32,7 +33,10 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        read_ahead_(other.read_ahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +58,25 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    read_ahead_ = other.read_ahead_;
     return *this;
   }
 
  private:
+  /**
+   * Called when the scan moves onto a new table page. Asks the buffer pool to prefetch the pages following it, keeping
+   * up to TABLE_SCAN_READ_AHEAD pages of the chain in flight. The window only grows past pages that are already
+   * resident, so the scan never blocks on a read it did not need yet.
+   * @param page_id the page the scan is now on
+   * @param next_page_id the page following it in the table heap
+   */
+  void ReadAhead(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Pages after the current one that have been handed to PrefetchPages, in chain order. */
+  std::deque<page_id_t> read_ahead_;
 };
 
 }  // namespace bustub
@@ -10,27 +10,164 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <random>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/crc32c.h"
+#include "common/util/string_util.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** The header of a slot of the page image log, followed by the page image. */
+struct PageImageHeader {
+  uint32_t magic_;
+  page_id_t page_id_;
+  /** Orders the images of a page, to find its last one after a crash. */
+  uint64_t seq_;
+};
+
+/** Written at the start of every slot of the page image log, to tell slots written from the ones never written. */
+static constexpr uint32_t PAGE_IMAGE_MAGIC = 0x49504750;  // "PGPI"
+
+/** The start of the header page of a database file, the rest of which is zeros. */
+struct FileHeader {
+  uint32_t magic_;
+  /** The layout of the pages. A file of another version is refused when opened, instead of misread. */
+  uint32_t format_version_;
+  uint32_t page_size_;
+  /** Drawn at random when the file is created, to tell it from another file of the same name. */
+  uint64_t file_id_;
+};
+
+/** Written at the start of every database file, to tell it from a file of something else. */
+static constexpr uint32_t FILE_HEADER_MAGIC = 0x42445442;  // "BTDB"
+
+/**
+ * The format version written to new files. Version 1: pages start with a 12 byte header holding their checksum at
+ * Page::OFFSET_CHECKSUM. Older files have no file header at all, and 8 byte page headers without a checksum.
+ */
+static constexpr uint32_t FILE_FORMAT_VERSION = 1;
+
+/** The checksummed copies of pages on their way to disk are aligned for direct I/O. */
+static constexpr size_t SCRATCH_ALIGNMENT = 4096;
+
+auto DurabilityModeFromString(const std::string &name, DurabilityMode *mode) -> bool {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "none") {
+    *mode = DurabilityMode::NONE;
+  } else if (lower == "flush") {
+    *mode = DurabilityMode::FLUSH;
+  } else if (lower == "fdatasync") {
+    *mode = DurabilityMode::FDATASYNC;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+auto DurabilityModeToString(DurabilityMode mode) -> std::string {
+  switch (mode) {
+    case DurabilityMode::NONE:
+      return "none";
+    case DurabilityMode::FLUSH:
+      return "flush";
+    case DurabilityMode::FDATASYNC:
+      return "fdatasync";
+  }
+  return "unknown";
+}
+
+auto ChecksumModeFromString(const std::string &name, ChecksumMode *mode) -> bool {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "none") {
+    *mode = ChecksumMode::NONE;
+  } else if (lower == "verify") {
+    *mode = ChecksumMode::VERIFY;
+  } else if (lower == "repair") {
+    *mode = ChecksumMode::REPAIR;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+auto ChecksumModeToString(ChecksumMode mode) -> std::string {
+  switch (mode) {
+    case ChecksumMode::NONE:
+      return "none";
+    case ChecksumMode::VERIFY:
+      return "verify";
+    case ChecksumMode::REPAIR:
+      return "repair";
+  }
+  return "unknown";
+}
+
+/**
+ * @return a buffer of the calling thread of at least size bytes, valid until its next call
+ */
+static auto ScratchBuffer(size_t size) -> char * {
+  struct Buffer {
+    char *data_{nullptr};
+    size_t size_{0};
+    ~Buffer() { std::free(data_); }
+  };
+  static thread_local Buffer buffer;
+  if (buffer.size_ < size) {
+    std::free(buffer.data_);
+    buffer.size_ = (size + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT * SCRATCH_ALIGNMENT;
+    buffer.data_ = static_cast<char *>(std::aligned_alloc(SCRATCH_ALIGNMENT, buffer.size_));
+  }
+  return buffer.data_;
+}
+
+/**
+ * Open file_name for reading and writing, creating it if it does not exist
+ * @return the descriptor, with the size of the file in *size
+ */
+static auto OpenFile(const std::string &file_name, int64_t *size) -> int {
+  int fd = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+  struct stat stat_buf;
+  if (fd >= 0 && fstat(fd, &stat_buf) == 0) {
+    *size = stat_buf.st_size;
+  }
+  return fd;
+}
+
+/**
+ * Constructor: used by the memory based managers
+ */
+DiskManager::DiskManager(size_t page_size) : page_size_(page_size) {
+  if (!IsValidPageSize(page_size)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid page size " + std::to_string(page_size));
+  }
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of the database
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size) : DiskManager(page_size) {
+  file_name_ = db_file;
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -38,88 +175,178 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  log_fd_ = OpenFile(log_name_, &log_file_size_);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  int64_t db_file_size = 0;
+  db_fd_ = OpenFile(db_file, &db_file_size);
+  if (db_fd_ < 0) {
+    close(log_fd_);
+    throw Exception("can't open db file");
   }
+  db_file_size_ = db_file_size;
+  try {
+    OpenFileHeader(true);
+  } catch (Exception &e) {
+    close(db_fd_);
+    close(log_fd_);
+    throw;
+  }
+  // The saved map is only valid until the first page is reused: drop it once loaded, so that after a crash the free
+  // pages are leaked rather than handed out twice. ShutDown saves it again. A new, empty file has no free pages, so a
+  // map left behind by a deleted file of the same name is ignored.
+  auto free_page_map_file = FreePageMap::FileNameFor(file_name_);
+  if (db_file_size > 0) {
+    free_page_map_.Load(free_page_map_file);
+  }
+  std::remove(free_page_map_file.c_str());
+  page_image_name_ = file_name_.substr(0, n) + ".fpi";
+  RepairTornPages();
   buffer_used = nullptr;
 }
 
 /**
- * Close all file streams
+ * Close all files
  */
 void DiskManager::ShutDown() {
+  if (db_fd_ >= 0) {
+    // the pages still reserved for extents are free from now on; without free pages there is nothing to save
+    reserved_page_map_.MoveTo(&free_page_map_);
+    auto free_page_map_file = FreePageMap::FileNameFor(file_name_);
+    if (free_page_map_.GetNumFreePages() == 0) {
+      std::remove(free_page_map_file.c_str());
+    } else if (!free_page_map_.Save(free_page_map_file)) {
+      LOG_DEBUG("I/O error while saving the free page map");
+    }
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    // every page written is in place by now, so their images are no longer needed
+    std::scoped_lock<std::mutex> lock(page_image_latch_);
+    DropPageImageLog();
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
-  log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+void DiskManager::WritePage(page_id_t page_id, const char *page_data) { WritePages(page_id, page_data, 1); }
+
+/**
+ * Write the contents of num_pages consecutive pages into disk file
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  std::unique_lock<std::mutex> lock(page_image_latch_, std::defer_lock);
+  page_data = PrepareWrite(first_page_id, page_data, num_pages, &lock);
+  auto offset = PageOffset(first_page_id);
+  struct iovec iov = {const_cast<char *>(page_data), num_pages * page_size_};
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  auto written = WriteFully(db_fd_, &iov, 1, offset);
+  if (written < num_pages * page_size_) {
     LOG_DEBUG("I/O error while writing");
+  }
+  ExtendFileSize(offset + static_cast<int64_t>(written));
+  ApplyDurability(db_fd_, offset, written, &db_sync_latency_);
+}
+
+/**
+ * Write a batch of pages, one pwritev per run of consecutive page ids, then flush or sync once
+ */
+void DiskManager::WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) {
+  if (db_fd_ < 0) {
+    // managers without a database file (the in-memory ones) write page by page
+    for (const auto &[page_id, page_data] : pages) {
+      WritePage(page_id, page_data);
+    }
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  if (pages.empty()) {
+    return;
+  }
+  std::sort(pages.begin(), pages.end());
+  std::unique_lock<std::mutex> lock(page_image_latch_, std::defer_lock);
+  PrepareWrite(&pages, &lock);
+  std::vector<struct iovec> iov;
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin;
+    iov.clear();
+    while (end < pages.size() && (end == begin || pages[end].first == pages[end - 1].first + 1) &&
+           iov.size() < IOV_MAX) {
+      iov.push_back({const_cast<char *>(pages[end].second), page_size_});
+      end++;
+    }
+    auto offset = PageOffset(pages[begin].first);
+    num_writes_ += 1;
+    auto written = WriteFully(db_fd_, iov.data(), static_cast<int>(iov.size()), offset);
+    if (written < iov.size() * page_size_) {
+      LOG_DEBUG("I/O error while writing");
+    }
+    ExtendFileSize(offset + static_cast<int64_t>(written));
+    begin = end;
+  }
+  auto first = PageOffset(pages.front().first);
+  auto last = PageOffset(pages.back().first + 1);
+  ApplyDurability(db_fd_, first, last - first, &db_sync_latency_);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  auto offset = PageOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_.load(std::memory_order_acquire)) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < page_size_) {
+    auto result = pread(db_fd_, page_data + read_count, page_size_ - read_count,
+                        offset + static_cast<int64_t>(read_count));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    if (result == 0) {
+      break;
     }
+    read_count += result;
   }
+  // if file ends before reading a whole page
+  if (read_count < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, page_size_ - read_count);
+  }
+  CheckPage(page_id, page_data);
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  std::promise<void> done;
+  try {
+    ReadPage(page_id, page_data);
+    done.set_value();
+  } catch (Exception &e) {
+    done.set_exception(std::current_exception());
+  }
+  return done.get_future();
+}
+
+auto DiskManager::WritePagesAsync(page_id_t first_page_id, const char *page_data, size_t num_pages)
+    -> std::future<void> {
+  WritePages(first_page_id, page_data, num_pages);
+  std::promise<void> done;
+  done.set_value();
+  return done.get_future();
 }
 
 /**
@@ -142,18 +369,38 @@ void DiskManager::WriteLog(char *log_data, int size) {
     assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
   }
 
+  WriteLogBatch({{log_data, size}});
+  flush_log_ = false;
+}
+
+/**
+ * Append log buffers with one pwritev at the end of the log file, then flush or sync once
+ */
+void DiskManager::WriteLogBatch(const std::vector<std::pair<const char *, int>> &buffers) {
+  std::vector<struct iovec> iov;
+  size_t size = 0;
+  for (const auto &[log_data, log_size] : buffers) {
+    if (log_size > 0) {
+      iov.push_back({const_cast<char *>(log_data), static_cast<size_t>(log_size)});
+      size += log_size;
+    }
+  }
+  if (iov.empty()) {
+    return;
+  }
   num_flushes_ += 1;
   // sequence write
-  log_io_.write(log_data, size);
-
+  auto offset = log_file_size_;
+  for (size_t begin = 0; begin < iov.size(); begin += IOV_MAX) {
+    auto count = std::min<size_t>(IOV_MAX, iov.size() - begin);
+    log_file_size_ += static_cast<int64_t>(WriteFully(log_fd_, iov.data() + begin, static_cast<int>(count),
+                                                      log_file_size_));
+  }
   // check for I/O error
-  if (log_io_.bad()) {
+  if (log_file_size_ - offset < static_cast<int64_t>(size)) {
     LOG_DEBUG("I/O error while writing log");
-    return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
-  flush_log_ = false;
+  ApplyDurability(log_fd_, offset, log_file_size_ - offset, &log_sync_latency_);
 }
 
 /**
@@ -162,28 +409,42 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * @return: false means already reach the end
  */
 auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
+  if (offset >= log_file_size_) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+    // LOG_DEBUG("file size is %d", log_file_size_);
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int read_count = 0;
+  while (read_count < size) {
+    auto result = pread(log_fd_, log_data + read_count, size - read_count, offset + read_count);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    if (result == 0) {
+      break;
+    }
+    read_count += result;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
   return true;
 }
 
+/**
+ * Page sizes are powers of two, so pages never straddle file system blocks or huge pages of the frame arena
+ */
+auto DiskManager::IsValidPageSize(size_t page_size) -> bool {
+  return page_size >= static_cast<size_t>(BUSTUB_PAGE_SIZE) && page_size <= static_cast<size_t>(BUSTUB_MAX_PAGE_SIZE) &&
+         (page_size & (page_size - 1)) == 0;
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -194,18 +455,340 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
  */
 auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
 
+/**
+ * Returns number of fdatasyncs made so far
+ */
+auto DiskManager::GetNumSyncs() const -> int { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
 /**
- * Private helper function to get disk file size
+ * Private helper function to check the header page of the db file, or write it to a new file. The header takes a whole
+ * page, so that the pages after it stay aligned for direct I/O and mmap. A file of an older format is refused here,
+ * rather than having every one of its pages fail its checksum.
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+void DiskManager::OpenFileHeader(bool writable) {
+  data_offset_ = static_cast<int64_t>(page_size_);
+  FileHeader header{};
+  if (db_file_size_.load() == 0) {
+    if (!writable) {
+      return;
+    }
+    std::vector<char> page(page_size_, 0);
+    std::random_device random;
+    // odd, so that it is never the 0 of the managers without a file
+    file_id_ = (uint64_t{random()} << 32 | random()) | 1;
+    header = {FILE_HEADER_MAGIC, FILE_FORMAT_VERSION, static_cast<uint32_t>(page_size_), file_id_};
+    memcpy(page.data(), &header, sizeof(header));
+    struct iovec iov = {page.data(), page_size_};
+    if (WriteFully(db_fd_, &iov, 1, 0) < page_size_) {
+      throw Exception(ExceptionType::IO, "can't write the header page of " + file_name_);
+    }
+    ExtendFileSize(data_offset_);
+    return;
+  }
+  if (pread(db_fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+      header.magic_ != FILE_HEADER_MAGIC) {
+    throw Exception(ExceptionType::INVALID, file_name_ + " has no database file header: it is not a database file, " +
+                                                "or has the format of an older version, whose pages cannot be read");
+  }
+  if (header.format_version_ != FILE_FORMAT_VERSION) {
+    throw Exception(ExceptionType::INVALID, file_name_ + " has format version " +
+                                                std::to_string(header.format_version_) + ", only version " +
+                                                std::to_string(FILE_FORMAT_VERSION) + " can be read");
+  }
+  if (header.page_size_ != page_size_) {
+    throw Exception(ExceptionType::INVALID, file_name_ + " was created with a page size of " +
+                                                std::to_string(header.page_size_) + ", opened with " +
+                                                std::to_string(page_size_));
+  }
+  file_id_ = header.file_id_;
+}
+
+/**
+ * Raise the cached db file size to end, unless a concurrent write has already taken it further
+ */
+void DiskManager::ExtendFileSize(int64_t end) {
+  auto size = db_file_size_.load(std::memory_order_relaxed);
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end, std::memory_order_release)) {
+  }
+}
+
+/**
+ * Private helper function to write whole buffers, picking up where a short write stopped
+ */
+auto DiskManager::WriteFully(int fd, struct iovec *iov, int iovcnt, int64_t offset) -> size_t {
+  size_t written = 0;
+  while (iovcnt > 0) {
+    auto result = pwritev(fd, iov, iovcnt, offset + static_cast<int64_t>(written));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    written += result;
+    // skip the buffers written in full and trim the one written in part
+    auto left = static_cast<size_t>(result);
+    while (iovcnt > 0 && left >= iov->iov_len) {
+      left -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+      iov->iov_len -= left;
+    }
+  }
+  return written;
+}
+
+/**
+ * Private helper function to start or wait for the write back of what was just written
+ */
+void DiskManager::ApplyDurability(int fd, int64_t offset, size_t size, LatencyHistogram *latency) {
+  auto mode = durability_mode_.load();
+  if (mode == DurabilityMode::NONE || size == 0) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (mode == DurabilityMode::FLUSH) {
+    sync_file_range(fd, offset, static_cast<int64_t>(size), SYNC_FILE_RANGE_WRITE);
+  } else {
+    num_syncs_ += 1;
+    if (fdatasync(fd) != 0) {
+      LOG_DEBUG("I/O error while syncing: %s", strerror(errno));
+    }
+  }
+  latency->Record(std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Leaving REPAIR drops the page image log, so that a later recovery never puts back an image older than the page
+ */
+void DiskManager::SetChecksumMode(ChecksumMode mode) {
+  std::scoped_lock<std::mutex> lock(page_image_latch_);
+  if (mode != ChecksumMode::REPAIR) {
+    DropPageImageLog();
+  }
+  checksum_mode_ = mode;
+}
+
+/**
+ * CRC32C of the page, with the checksum field taken as zero
+ */
+auto DiskManager::ComputeChecksum(const char *page_data, size_t page_size) -> uint32_t {
+  const uint32_t zero = 0;
+  auto crc = Crc32c::Compute(page_data, Page::OFFSET_CHECKSUM);
+  crc = Crc32c::Compute(reinterpret_cast<const char *>(&zero), sizeof(zero), crc);
+  auto rest = Page::OFFSET_CHECKSUM + sizeof(uint32_t);
+  return Crc32c::Compute(page_data + rest, page_size - rest, crc);
+}
+
+void DiskManager::SetChecksum(char *page_data) const {
+  auto crc = ComputeChecksum(page_data, page_size_);
+  memcpy(page_data + Page::OFFSET_CHECKSUM, &crc, sizeof(crc));
+}
+
+auto DiskManager::IsChecksumValid(const char *page_data) const -> bool {
+  uint32_t crc;
+  memcpy(&crc, page_data + Page::OFFSET_CHECKSUM, sizeof(crc));
+  if (crc == ComputeChecksum(page_data, page_size_)) {
+    return true;
+  }
+  return crc == 0 && std::all_of(page_data, page_data + page_size_, [](char c) { return c == 0; });
+}
+
+/**
+ * Private helper function to checksum, and log, a run of pages on their way to disk
+ */
+auto DiskManager::PrepareWrite(page_id_t first_page_id, const char *page_data, size_t num_pages,
+                               std::unique_lock<std::mutex> *lock) -> const char * {
+  if (checksum_mode_.load() == ChecksumMode::NONE || num_pages == 0) {
+    return page_data;
+  }
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < num_pages; i++) {
+    pages.emplace_back(first_page_id + static_cast<page_id_t>(i), page_data + i * page_size_);
+  }
+  PrepareWrite(&pages, lock);
+  return pages.front().second;
+}
+
+/**
+ * Private helper function to checksum, and log, a batch of pages on their way to disk. The copies are back to back in
+ * the order of the batch.
+ */
+void DiskManager::PrepareWrite(std::vector<std::pair<page_id_t, const char *>> *pages,
+                               std::unique_lock<std::mutex> *lock) {
+  auto mode = checksum_mode_.load();
+  if (mode == ChecksumMode::NONE || pages->empty()) {
+    return;
+  }
+  auto *copy = ScratchBuffer(pages->size() * page_size_);
+  for (auto &[page_id, page_data] : *pages) {
+    memcpy(copy, page_data, page_size_);
+    SetChecksum(copy);
+    page_data = copy;
+    copy += page_size_;
+  }
+  if (mode == ChecksumMode::REPAIR) {
+    lock->lock();
+    LogPageImages(*pages);
+  }
+}
+
+/**
+ * Private helper function to verify a page just read, falling back to its logged image
+ */
+void DiskManager::CheckPage(page_id_t page_id, char *page_data) {
+  auto mode = checksum_mode_.load();
+  if (mode == ChecksumMode::NONE || IsChecksumValid(page_data)) {
+    return;
+  }
+  num_checksum_failures_ += 1;
+  if (mode == ChecksumMode::REPAIR && ReadPageImage(page_id, page_data)) {
+    LOG_DEBUG("page %d failed its checksum, put back its logged image", page_id);
+    WritePages(page_id, page_data, 1);
+    num_repaired_pages_ += 1;
+    return;
+  }
+  throw Exception(ExceptionType::IO, "page " + std::to_string(page_id) + " failed its checksum");
+}
+
+/**
+ * Private helper function to log the images of a write in consecutive slots of the page image log
+ */
+void DiskManager::LogPageImages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (pages.empty()) {
+    return;
+  }
+  if (page_image_fd_ < 0) {
+    page_image_fd_ = open(page_image_name_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (page_image_fd_ < 0) {
+      LOG_DEBUG("can't open the page image log");
+      return;
+    }
+  }
+  // A write larger than the ring grows it; one that does not fit before its end starts over at the first slot.
+  page_image_num_slots_ = std::max(page_image_num_slots_, pages.size());
+  page_image_page_of_.resize(page_image_num_slots_, INVALID_PAGE_ID);
+  if (page_image_next_slot_ + pages.size() > page_image_num_slots_) {
+    page_image_next_slot_ = 0;
+  }
+  auto first_slot = page_image_next_slot_;
+  std::vector<PageImageHeader> headers(pages.size());
+  std::vector<struct iovec> iov;
+  for (size_t i = 0; i < pages.size(); i++) {
+    auto slot = first_slot + i;
+    // the image overwritten may be the last one of its page
+    auto overwritten = page_image_slot_of_.find(page_image_page_of_[slot]);
+    if (overwritten != page_image_slot_of_.end() && overwritten->second == slot) {
+      page_image_slot_of_.erase(overwritten);
+    }
+    page_image_page_of_[slot] = pages[i].first;
+    page_image_slot_of_[pages[i].first] = slot;
+    headers[i] = {PAGE_IMAGE_MAGIC, pages[i].first, page_image_next_seq_++};
+    iov.push_back({&headers[i], sizeof(PageImageHeader)});
+    iov.push_back({const_cast<char *>(pages[i].second), page_size_});
+  }
+  page_image_next_slot_ = first_slot + pages.size();
+  auto slot_size = sizeof(PageImageHeader) + page_size_;
+  auto offset = static_cast<int64_t>(first_slot * slot_size);
+  size_t written = 0;
+  for (size_t begin = 0; begin < iov.size(); begin += IOV_MAX) {
+    auto count = std::min<size_t>(IOV_MAX, iov.size() - begin);
+    written += WriteFully(page_image_fd_, iov.data() + begin, static_cast<int>(count),
+                          offset + static_cast<int64_t>(written));
+  }
+  if (written < pages.size() * slot_size) {
+    LOG_DEBUG("I/O error while writing the page image log");
+  }
+  ApplyDurability(page_image_fd_, offset, written, &db_sync_latency_);
+}
+
+/**
+ * Private helper function to read the last logged image of a page, if its slot has not been reused since
+ */
+auto DiskManager::ReadPageImage(page_id_t page_id, char *page_data) -> bool {
+  std::scoped_lock<std::mutex> lock(page_image_latch_);
+  auto it = page_image_slot_of_.find(page_id);
+  if (page_image_fd_ < 0 || it == page_image_slot_of_.end()) {
+    return false;
+  }
+  std::vector<char> slot(sizeof(PageImageHeader) + page_size_);
+  auto offset = static_cast<int64_t>(it->second * slot.size());
+  if (pread(page_image_fd_, slot.data(), slot.size(), offset) != static_cast<ssize_t>(slot.size())) {
+    return false;
+  }
+  PageImageHeader header;
+  memcpy(&header, slot.data(), sizeof(header));
+  const char *image = slot.data() + sizeof(header);
+  if (header.magic_ != PAGE_IMAGE_MAGIC || header.page_id_ != page_id || !IsChecksumValid(image)) {
+    return false;
+  }
+  memcpy(page_data, image, page_size_);
+  return true;
+}
+
+/**
+ * Private helper function to recover from a crash: every page that fails its checksum while the page image log of the
+ * last run holds an image of it was torn, and gets its last image back
+ */
+void DiskManager::RepairTornPages() {
+  int fd = open(page_image_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  std::unordered_map<page_id_t, std::pair<uint64_t, std::vector<char>>> last_images;
+  std::vector<char> slot(sizeof(PageImageHeader) + page_size_);
+  for (int64_t offset = 0; pread(fd, slot.data(), slot.size(), offset) == static_cast<ssize_t>(slot.size());
+       offset += static_cast<int64_t>(slot.size())) {
+    PageImageHeader header;
+    memcpy(&header, slot.data(), sizeof(header));
+    const char *image = slot.data() + sizeof(header);
+    // skip slots never written, and the ones torn by the crash themselves
+    if (header.magic_ != PAGE_IMAGE_MAGIC || !IsChecksumValid(image)) {
+      continue;
+    }
+    auto it = last_images.find(header.page_id_);
+    if (it == last_images.end() || it->second.first < header.seq_) {
+      last_images[header.page_id_] = {header.seq_, std::vector<char>(image, image + page_size_)};
+    }
+  }
+  close(fd);
+  std::vector<char> page(page_size_);
+  for (const auto &[page_id, last_image] : last_images) {
+    memset(page.data(), 0, page_size_);
+    ReadPage(page_id, page.data());
+    if (!IsChecksumValid(page.data())) {
+      WritePages(page_id, last_image.second.data(), 1);
+      num_repaired_pages_ += 1;
+    }
+  }
+  if (num_repaired_pages_ > 0) {
+    LOG_INFO("put back %d torn pages from the page image log", num_repaired_pages_.load());
+    fdatasync(db_fd_);
+  }
+  std::remove(page_image_name_.c_str());
+}
+
+/**
+ * Private helper function to close and remove the page image log
+ */
+void DiskManager::DropPageImageLog() {
+  if (page_image_fd_ >= 0) {
+    close(page_image_fd_);
+    page_image_fd_ = -1;
+    std::remove(page_image_name_.c_str());
+  }
+  page_image_slot_of_.clear();
+  page_image_page_of_.clear();
+  page_image_num_slots_ = PAGE_IMAGE_LOG_CAPACITY;
+  page_image_next_slot_ = 0;
 }
 
 }  // namespace bustub
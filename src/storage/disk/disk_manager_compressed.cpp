@@ -0,0 +1,425 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed.cpp
+//
+// Identification: src/storage/disk/disk_manager_compressed.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_compressed.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/crc32c.h"
+#include "common/util/lz4.h"
+
+namespace bustub {
+
+/** The header of every slot, followed by the stored page. */
+struct SlotHeader {
+  uint32_t magic_;
+  page_id_t page_id_;
+  uint64_t seq_;
+  uint32_t size_;
+  /** CRC32C of the header up to here and of the stored page. */
+  uint32_t checksum_;
+};
+
+/** Written at the start of every slot, to find them again after a crash. */
+static constexpr uint32_t SLOT_MAGIC = 0x4c535043;  // "CPSL"
+
+/** Written at the start of the slot map file, to recognize it. */
+static constexpr uint32_t SLOT_MAP_MAGIC = 0x4d535043;  // "CPSM"
+
+static auto SlotChecksum(const SlotHeader &header, const char *stored_page) -> uint32_t {
+  auto crc = Crc32c::Compute(reinterpret_cast<const char *>(&header), offsetof(SlotHeader, checksum_));
+  return Crc32c::Compute(stored_page, header.size_, crc);
+}
+
+/**
+ * Read size bytes at offset of fd, retrying short reads
+ * @return the number of bytes read, less than asked for only at the end of the file or on error
+ */
+static auto ReadFully(int fd, char *data, size_t size, int64_t offset) -> size_t {
+  size_t read_count = 0;
+  while (read_count < size) {
+    auto result = pread(fd, data + read_count, size - read_count, offset + static_cast<int64_t>(read_count));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    read_count += result;
+  }
+  return read_count;
+}
+
+DiskManagerCompressed::DiskManagerCompressed(const std::string &db_file, size_t page_size)
+    : DiskManager(db_file, page_size) {
+  if (db_fd_ < 0) {
+    return;
+  }
+  auto map_file = MapFileNameFor(file_name_);
+  auto file_size = db_file_size_.load();
+  if (!LoadMap(map_file) && file_size > 0) {
+    LOG_INFO("rebuilding the slot map of %s", file_name_.c_str());
+    ScanSlots(file_size);
+  }
+  // the saved map goes stale with the first write, so a crash before the next shut down rebuilds it from the slots
+  std::remove(map_file.c_str());
+  RebuildFreeUnits();
+  // GetNumPages counts page ids, not bytes of the file
+  db_file_size_ = PageOffset(static_cast<page_id_t>(slots_.size()));
+}
+
+/**
+ * Cut off the free units at the end of the file, and save the map once the slots it points to are on disk
+ */
+void DiskManagerCompressed::ShutDown() {
+  if (db_fd_ >= 0) {
+    std::unique_lock lock(latch_);
+    if (ftruncate(db_fd_, static_cast<int64_t>(end_unit_ * COMPRESSED_SLOT_UNIT)) != 0) {
+      LOG_DEBUG("I/O error while truncating the db file");
+    }
+    fdatasync(db_fd_);
+    if (!SaveMap(MapFileNameFor(file_name_))) {
+      LOG_DEBUG("I/O error while saving the slot map");
+    }
+  }
+  DiskManager::ShutDown();
+}
+
+void DiskManagerCompressed::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < num_pages; i++) {
+    pages.emplace_back(first_page_id + static_cast<page_id_t>(i), page_data + i * page_size_);
+  }
+  WritePageBatch(std::move(pages));
+}
+
+/**
+ * Compress the pages into slots back to back, write them to free units with a single write, then point the map at
+ * them
+ */
+void DiskManagerCompressed::WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) {
+  if (pages.empty()) {
+    return;
+  }
+  static thread_local std::vector<char> copy;
+  static thread_local std::vector<char> buffer;
+  const auto raw_units = NumUnits(page_size_);
+  // a compressed page has to save at least a unit to be worth decompressing on every read
+  const auto capacity = (raw_units - 1) * COMPRESSED_SLOT_UNIT - sizeof(SlotHeader);
+  const bool checksums = checksum_mode_.load() != ChecksumMode::NONE;
+  copy.resize(page_size_);
+  buffer.resize(pages.size() * raw_units * COMPRESSED_SLOT_UNIT);
+  std::vector<Slot> slots(pages.size());
+  uint64_t num_units = 0;
+  for (size_t i = 0; i < pages.size(); i++) {
+    const char *page_data = pages[i].second;
+    if (checksums) {
+      memcpy(copy.data(), page_data, page_size_);
+      SetChecksum(copy.data());
+      page_data = copy.data();
+    }
+    char *stored_page = buffer.data() + num_units * COMPRESSED_SLOT_UNIT + sizeof(SlotHeader);
+    auto size = Lz4::Compress(page_data, page_size_, stored_page, capacity);
+    if (size == 0) {
+      memcpy(stored_page, page_data, page_size_);
+      size = page_size_;
+    }
+    slots[i] = {num_units, 0, static_cast<uint32_t>(size)};
+    auto units = NumUnits(size);
+    memset(stored_page + size, 0, units * COMPRESSED_SLOT_UNIT - sizeof(SlotHeader) - size);
+    num_units += units;
+  }
+
+  uint64_t first_unit;
+  {
+    std::unique_lock lock(latch_);
+    first_unit = AllocateUnits(num_units);
+    for (auto &slot : slots) {
+      slot.seq_ = next_seq_++;
+    }
+  }
+  page_id_t last_page_id = 0;
+  for (size_t i = 0; i < pages.size(); i++) {
+    char *slot_data = buffer.data() + slots[i].unit_ * COMPRESSED_SLOT_UNIT;
+    SlotHeader header{SLOT_MAGIC, pages[i].first, slots[i].seq_, slots[i].size_, 0};
+    header.checksum_ = SlotChecksum(header, slot_data + sizeof(SlotHeader));
+    memcpy(slot_data, &header, sizeof(header));
+    slots[i].unit_ += first_unit;
+    last_page_id = std::max(last_page_id, pages[i].first);
+  }
+  auto offset = static_cast<int64_t>(first_unit * COMPRESSED_SLOT_UNIT);
+  struct iovec iov = {buffer.data(), num_units * COMPRESSED_SLOT_UNIT};
+  num_writes_ += 1;
+  auto written = WriteFully(db_fd_, &iov, 1, offset);
+  ApplyDurability(db_fd_, offset, written, &db_sync_latency_);
+
+  std::unique_lock lock(latch_);
+  if (written < num_units * COMPRESSED_SLOT_UNIT) {
+    // the pages keep the slots they had
+    LOG_DEBUG("I/O error while writing");
+    FreeUnits(first_unit, num_units);
+    return;
+  }
+  for (size_t i = 0; i < pages.size(); i++) {
+    InstallSlot(pages[i].first, slots[i]);
+  }
+  ExtendFileSize(PageOffset(last_page_id + 1));
+}
+
+/**
+ * Read the slot of the page, check it, and decompress it into page_data
+ */
+void DiskManagerCompressed::ReadPage(page_id_t page_id, char *page_data) {
+  static thread_local std::vector<char> buffer;
+  bool complete;
+  {
+    std::shared_lock lock(latch_);
+    if (page_id < 0 || static_cast<size_t>(page_id) >= slots_.size() || slots_[page_id].size_ == 0) {
+      // a page never written reads as zeros, as it would from a hole of an uncompressed file
+      memset(page_data, 0, page_size_);
+      return;
+    }
+    const auto &slot = slots_[page_id];
+    buffer.resize(sizeof(SlotHeader) + slot.size_);
+    auto offset = static_cast<int64_t>(slot.unit_ * COMPRESSED_SLOT_UNIT);
+    complete = ReadFully(db_fd_, buffer.data(), buffer.size(), offset) == buffer.size();
+  }
+  SlotHeader header;
+  memcpy(&header, buffer.data(), sizeof(header));
+  const char *stored_page = buffer.data() + sizeof(SlotHeader);
+  if (!complete || header.magic_ != SLOT_MAGIC || header.page_id_ != page_id ||
+      header.size_ != buffer.size() - sizeof(SlotHeader) || header.checksum_ != SlotChecksum(header, stored_page)) {
+    num_checksum_failures_ += 1;
+    throw Exception(ExceptionType::IO, "the slot of page " + std::to_string(page_id) + " is corrupted");
+  }
+  if (header.size_ == page_size_) {
+    memcpy(page_data, stored_page, page_size_);
+  } else if (!Lz4::Decompress(stored_page, header.size_, page_data, page_size_)) {
+    num_checksum_failures_ += 1;
+    throw Exception(ExceptionType::IO, "page " + std::to_string(page_id) + " does not decompress");
+  }
+  CheckPage(page_id, page_data);
+}
+
+void DiskManagerCompressed::DeallocatePage(page_id_t page_id) {
+  {
+    std::unique_lock lock(latch_);
+    if (page_id >= 0 && static_cast<size_t>(page_id) < slots_.size()) {
+      ReleaseSlot(&slots_[page_id]);
+    }
+  }
+  DiskManager::DeallocatePage(page_id);
+}
+
+auto DiskManagerCompressed::GetFileSize() -> size_t {
+  std::shared_lock lock(latch_);
+  return end_unit_ * COMPRESSED_SLOT_UNIT;
+}
+
+auto DiskManagerCompressed::GetStoredSize() -> size_t {
+  std::shared_lock lock(latch_);
+  return stored_units_ * COMPRESSED_SLOT_UNIT;
+}
+
+auto DiskManagerCompressed::GetNumCompressedPages() -> size_t {
+  std::shared_lock lock(latch_);
+  return num_compressed_pages_;
+}
+
+auto DiskManagerCompressed::MapFileNameFor(const std::string &db_file_name) -> std::string {
+  auto n = db_file_name.rfind('.');
+  return (n == std::string::npos ? db_file_name : db_file_name.substr(0, n)) + ".cpm";
+}
+
+auto DiskManagerCompressed::NumUnits(size_t size) -> uint64_t {
+  return (sizeof(SlotHeader) + size + COMPRESSED_SLOT_UNIT - 1) / COMPRESSED_SLOT_UNIT;
+}
+
+/**
+ * Private helper function to take the first run of free units large enough, or the units at the end of the file
+ */
+auto DiskManagerCompressed::AllocateUnits(uint64_t num_units) -> uint64_t {
+  for (auto it = free_units_.begin(); it != free_units_.end(); ++it) {
+    auto [unit, length] = *it;
+    if (length >= num_units) {
+      free_units_.erase(it);
+      if (length > num_units) {
+        free_units_[unit + num_units] = length - num_units;
+      }
+      return unit;
+    }
+  }
+  auto unit = end_unit_;
+  end_unit_ += num_units;
+  return unit;
+}
+
+void DiskManagerCompressed::FreeUnits(uint64_t unit, uint64_t num_units) {
+  auto next = free_units_.lower_bound(unit);
+  if (next != free_units_.end() && next->first == unit + num_units) {
+    num_units += next->second;
+    next = free_units_.erase(next);
+  }
+  if (next != free_units_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == unit) {
+      unit = prev->first;
+      num_units += prev->second;
+      free_units_.erase(prev);
+    }
+  }
+  if (unit + num_units == end_unit_) {
+    end_unit_ = unit;
+    return;
+  }
+  free_units_[unit] = num_units;
+}
+
+/**
+ * Private helper function to point the map at a slot just written. A write of the same page that took its sequence
+ * number later but finished first keeps its slot.
+ */
+void DiskManagerCompressed::InstallSlot(page_id_t page_id, const Slot &slot) {
+  if (static_cast<size_t>(page_id) >= slots_.size()) {
+    slots_.resize(page_id + 1, Slot{0, 0, 0});
+  }
+  auto &current = slots_[page_id];
+  if (current.size_ != 0 && current.seq_ > slot.seq_) {
+    FreeUnits(slot.unit_, NumUnits(slot.size_));
+    return;
+  }
+  ReleaseSlot(&current);
+  current = slot;
+  stored_units_ += NumUnits(slot.size_);
+  num_compressed_pages_ += slot.size_ < page_size_ ? 1 : 0;
+}
+
+void DiskManagerCompressed::ReleaseSlot(Slot *slot) {
+  if (slot->size_ == 0) {
+    return;
+  }
+  FreeUnits(slot->unit_, NumUnits(slot->size_));
+  stored_units_ -= NumUnits(slot->size_);
+  num_compressed_pages_ -= slot->size_ < page_size_ ? 1 : 0;
+  slot->size_ = 0;
+}
+
+auto DiskManagerCompressed::LoadMap(const std::string &file_name) -> bool {
+  slots_.clear();
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t page_size = 0;
+  uint64_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&page_size), sizeof(page_size));
+  in.read(reinterpret_cast<char *>(&next_seq_), sizeof(next_seq_));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in.good() || magic != SLOT_MAP_MAGIC || page_size != page_size_) {
+    next_seq_ = 1;
+    return false;
+  }
+  slots_.resize(count);
+  in.read(reinterpret_cast<char *>(slots_.data()), count * sizeof(Slot));
+  if (in.gcount() != static_cast<std::streamsize>(count * sizeof(Slot))) {
+    slots_.clear();
+    next_seq_ = 1;
+    return false;
+  }
+  return true;
+}
+
+auto DiskManagerCompressed::SaveMap(const std::string &file_name) -> bool {
+  auto tmp_file_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto page_size = static_cast<uint32_t>(page_size_);
+    uint64_t count = slots_.size();
+    out.write(reinterpret_cast<const char *>(&SLOT_MAP_MAGIC), sizeof(SLOT_MAP_MAGIC));
+    out.write(reinterpret_cast<const char *>(&page_size), sizeof(page_size));
+    out.write(reinterpret_cast<const char *>(&next_seq_), sizeof(next_seq_));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(slots_.data()), count * sizeof(Slot));
+    if (!out.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+/**
+ * Private helper function to find the slots by their headers, unit by unit. A slot partly overwritten by a later one
+ * fails its checksum and is skipped; of the intact slots of a page, the one with the highest sequence number wins.
+ */
+void DiskManagerCompressed::ScanSlots(int64_t file_size) {
+  std::vector<char> slot_data(sizeof(SlotHeader) + page_size_);
+  auto end_unit = static_cast<uint64_t>(file_size) / COMPRESSED_SLOT_UNIT;
+  for (auto unit = FirstUnit(); unit < end_unit;) {
+    auto offset = static_cast<int64_t>(unit * COMPRESSED_SLOT_UNIT);
+    SlotHeader header{};
+    if (ReadFully(db_fd_, reinterpret_cast<char *>(&header), sizeof(header), offset) < sizeof(header) ||
+        header.magic_ != SLOT_MAGIC || header.page_id_ < 0 || header.size_ == 0 || header.size_ > page_size_ ||
+        ReadFully(db_fd_, slot_data.data(), header.size_, offset + static_cast<int64_t>(sizeof(header))) <
+            header.size_ ||
+        header.checksum_ != SlotChecksum(header, slot_data.data())) {
+      unit++;
+      continue;
+    }
+    if (static_cast<size_t>(header.page_id_) >= slots_.size()) {
+      slots_.resize(header.page_id_ + 1, Slot{0, 0, 0});
+    }
+    auto &slot = slots_[header.page_id_];
+    if (slot.size_ == 0 || slot.seq_ < header.seq_) {
+      slot = {unit, header.seq_, header.size_};
+    }
+    next_seq_ = std::max(next_seq_, header.seq_ + 1);
+    unit += NumUnits(header.size_);
+  }
+}
+
+/**
+ * Private helper function to find the free units between the slots in use
+ */
+void DiskManagerCompressed::RebuildFreeUnits() {
+  free_units_.clear();
+  stored_units_ = 0;
+  num_compressed_pages_ = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> used;
+  for (const auto &slot : slots_) {
+    if (slot.size_ != 0) {
+      used.emplace_back(slot.unit_, NumUnits(slot.size_));
+      stored_units_ += NumUnits(slot.size_);
+      num_compressed_pages_ += slot.size_ < page_size_ ? 1 : 0;
+    }
+  }
+  std::sort(used.begin(), used.end());
+  end_unit_ = FirstUnit();
+  for (const auto &[unit, num_units] : used) {
+    if (unit > end_unit_) {
+      free_units_[end_unit_] = unit - end_unit_;
+    }
+    end_unit_ = std::max(end_unit_, unit + num_units);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,399 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_direct.cpp
+//
+// Identification: src/storage/disk/disk_manager_direct.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_direct.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+/** O_DIRECT transfers must be aligned to the logical block size of the device, which is at most a 4 KB page. */
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+struct DiskManagerDirect::Request {
+  bool is_write_;
+  int64_t offset_;
+  size_t size_;
+  /** The caller's buffer. */
+  char *data_;
+  /** The buffer the I/O is done on: data_ if it is aligned, otherwise a bounce buffer owned by the request. */
+  char *io_buffer_;
+  /** Bytes already transferred by an io_uring entry that came back short. */
+  size_t transferred_;
+  std::promise<void> done_;
+};
+
+/** The rings of an io_uring, mapped from the kernel, and the bookkeeping of the entries in flight. */
+struct DiskManagerDirect::IoUring {
+  int ring_fd_{-1};
+  void *sq_ring_{MAP_FAILED};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{MAP_FAILED};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  size_t sqes_size_{0};
+
+  unsigned *sq_tail_;
+  unsigned *sq_mask_;
+  unsigned *sq_array_;
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned *cq_mask_;
+  io_uring_cqe *cqes_;
+
+  /** Protects the submission queue and in_flight_, which never exceeds the queue depth. */
+  std::mutex latch_;
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+
+  std::thread reaper_;
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+};
+
+DiskManagerDirect::DiskManagerDirect(const std::string &db_file, size_t page_size, size_t queue_depth,
+                                     bool use_io_uring)
+    : DiskManager(db_file, page_size), queue_depth_(queue_depth) {
+  // The base class created the file and opened the log; reopen the file for direct I/O.
+  close(db_fd_);
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_DIRECT);
+  is_direct_ = db_fd_ >= 0;
+  if (db_fd_ < 0 && errno == EINVAL) {
+    LOG_DEBUG("O_DIRECT is not supported for %s, falling back to buffered I/O", db_file.c_str());
+    db_fd_ = open(db_file.c_str(), O_RDWR);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  if (use_io_uring && SetUpIoUring()) {
+    return;
+  }
+  for (size_t i = 0; i < queue_depth_; i++) {
+    workers_.emplace_back([this] { RunWorker(); });
+  }
+}
+
+DiskManagerDirect::~DiskManagerDirect() { ShutDown(); }
+
+void DiskManagerDirect::ShutDown() {
+  if (is_shut_down_) {
+    return;
+  }
+  is_shut_down_ = true;
+  if (ring_ != nullptr) {
+    {
+      std::unique_lock<std::mutex> lock(ring_->latch_);
+      ring_->slot_cv_.wait(lock, [this] { return ring_->in_flight_ == 0; });
+    }
+    SubmitToIoUring(nullptr);
+    ring_->reaper_.join();
+    delete ring_;
+    ring_ = nullptr;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(queue_latch_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  DiskManager::ShutDown();
+}
+
+auto DiskManagerDirect::MakeRequest(bool is_write, page_id_t page_id, char *page_data, size_t num_pages,
+                                    bool set_checksums) -> Request * {
+  auto *request = new Request{is_write, PageOffset(page_id), num_pages * page_size_, page_data, page_data, 0, {}};
+  if (reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0 || set_checksums) {
+    request->io_buffer_ = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, request->size_));
+    if (is_write) {
+      memcpy(request->io_buffer_, page_data, request->size_);
+    }
+    for (size_t i = 0; set_checksums && i < num_pages; i++) {
+      SetChecksum(request->io_buffer_ + i * page_size_);
+    }
+  }
+  return request;
+}
+
+auto DiskManagerDirect::DoIo(Request *request) -> int64_t {
+  size_t done = request->transferred_;
+  while (done < request->size_) {
+    auto result = request->is_write_ ? pwrite(db_fd_, request->io_buffer_ + done, request->size_ - done,
+                                              request->offset_ + static_cast<int64_t>(done))
+                                     : pread(db_fd_, request->io_buffer_ + done, request->size_ - done,
+                                             request->offset_ + static_cast<int64_t>(done));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
+      return -errno;
+    }
+    if (result == 0) {
+      break;
+    }
+    done += result;
+  }
+  return static_cast<int64_t>(done);
+}
+
+void DiskManagerDirect::Complete(Request *request, int64_t result) {
+  if (result < 0) {
+    LOG_DEBUG("I/O error while %s: %s", request->is_write_ ? "writing" : "reading",
+              strerror(static_cast<int>(-result)));
+  } else if (request->is_write_ && static_cast<size_t>(result) < request->size_) {
+    LOG_DEBUG("I/O error while writing: short write");
+  } else if (!request->is_write_ && static_cast<size_t>(result) < request->size_) {
+    // Reading at or past the end of the file: the rest of the page reads as zeros, as with DiskManager.
+    memset(request->io_buffer_ + result, 0, request->size_ - result);
+  }
+  if (request->io_buffer_ != request->data_) {
+    if (!request->is_write_) {
+      memcpy(request->data_, request->io_buffer_, request->size_);
+    }
+    std::free(request->io_buffer_);
+  }
+  if (!request->is_write_ && result >= 0) {
+    try {
+      auto first_page_id = static_cast<page_id_t>((request->offset_ - data_offset_) / static_cast<int64_t>(page_size_));
+      for (size_t i = 0; i < request->size_ / page_size_; i++) {
+        CheckPage(first_page_id + static_cast<page_id_t>(i), request->data_ + i * page_size_);
+      }
+    } catch (Exception &e) {
+      request->done_.set_exception(std::current_exception());
+      delete request;
+      return;
+    }
+  }
+  request->done_.set_value();
+  delete request;
+}
+
+void DiskManagerDirect::WritePage(page_id_t page_id, const char *page_data) { WritePages(page_id, page_data, 1); }
+
+void DiskManagerDirect::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  num_writes_ += 1;
+  std::unique_lock<std::mutex> lock(page_image_latch_, std::defer_lock);
+  page_data = PrepareWrite(first_page_id, page_data, num_pages, &lock);
+  auto *request = MakeRequest(true, first_page_id, const_cast<char *>(page_data), num_pages);
+  auto offset = request->offset_;
+  auto result = DoIo(request);
+  Complete(request, result);
+  ApplyDurability(db_fd_, offset, std::max<int64_t>(result, 0), &db_sync_latency_);
+}
+
+void DiskManagerDirect::WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) {
+  // The vectored writes of DiskManager go straight to the file, so unaligned pages need aligned copies first.
+  std::vector<char *> copies;
+  for (auto &[page_id, page_data] : pages) {
+    if (is_direct_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0) {
+      auto *copy = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, page_size_));
+      memcpy(copy, page_data, page_size_);
+      copies.push_back(copy);
+      page_data = copy;
+    }
+  }
+  DiskManager::WritePageBatch(std::move(pages));
+  for (auto *copy : copies) {
+    std::free(copy);
+  }
+}
+
+void DiskManagerDirect::ReadPage(page_id_t page_id, char *page_data) {
+  auto *request = MakeRequest(false, page_id, page_data, 1);
+  auto done = request->done_.get_future();
+  Complete(request, DoIo(request));
+  done.get();
+}
+
+auto DiskManagerDirect::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  auto *request = MakeRequest(false, page_id, page_data, 1);
+  auto done = request->done_.get_future();
+  Submit(request);
+  return done;
+}
+
+auto DiskManagerDirect::WritePagesAsync(page_id_t first_page_id, const char *page_data, size_t num_pages)
+    -> std::future<void> {
+  auto mode = checksum_mode_.load();
+  if (mode == ChecksumMode::REPAIR) {
+    // Each write has to follow the logging of its page images, which the caller may not be waiting for.
+    return DiskManager::WritePagesAsync(first_page_id, page_data, num_pages);
+  }
+  num_writes_ += 1;
+  auto *request =
+      MakeRequest(true, first_page_id, const_cast<char *>(page_data), num_pages, mode == ChecksumMode::VERIFY);
+  auto done = request->done_.get_future();
+  Submit(request);
+  return done;
+}
+
+void DiskManagerDirect::Submit(Request *request) {
+  if (ring_ != nullptr) {
+    SubmitToIoUring(request);
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(queue_latch_);
+    queue_.push_back(request);
+  }
+  queue_cv_.notify_one();
+}
+
+void DiskManagerDirect::RunWorker() {
+  std::unique_lock<std::mutex> lock(queue_latch_);
+  while (true) {
+    queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    auto *request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    Complete(request, DoIo(request));
+    lock.lock();
+  }
+}
+
+auto DiskManagerDirect::SetUpIoUring() -> bool {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  auto *ring = new IoUring();
+  ring->ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth_, &params));
+  if (ring->ring_fd_ < 0) {
+    delete ring;
+    return false;
+  }
+  // Map the submission ring, the completion ring (which may share the mapping) and the submission entries.
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    ring->sq_ring_size_ = ring->cq_ring_size_ = std::max(ring->sq_ring_size_, ring->cq_ring_size_);
+  }
+  ring->sq_ring_ = mmap(nullptr, ring->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->ring_fd_, IORING_OFF_SQ_RING);
+  if (ring->sq_ring_ == MAP_FAILED) {
+    delete ring;
+    return false;
+  }
+  ring->cq_ring_ = single_mmap ? ring->sq_ring_
+                               : mmap(nullptr, ring->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      ring->ring_fd_, IORING_OFF_CQ_RING);
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes_ = static_cast<io_uring_sqe *>(mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_POPULATE, ring->ring_fd_, IORING_OFF_SQES));
+  if (ring->cq_ring_ == MAP_FAILED || ring->sqes_ == MAP_FAILED) {
+    delete ring;
+    return false;
+  }
+  auto *sq = static_cast<char *>(ring->sq_ring_);
+  auto *cq = static_cast<char *>(ring->cq_ring_);
+  ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  ring_ = ring;
+  ring_->reaper_ = std::thread([this] { ReapIoUring(); });
+  return true;
+}
+
+void DiskManagerDirect::SubmitToIoUring(Request *request) {
+  std::unique_lock<std::mutex> lock(ring_->latch_);
+  // The stop request is only submitted once nothing else is in flight, so it always finds a slot.
+  ring_->slot_cv_.wait(lock, [&] { return request == nullptr || ring_->in_flight_ < queue_depth_; });
+  unsigned tail = *ring_->sq_tail_;
+  unsigned index = tail & *ring_->sq_mask_;
+  io_uring_sqe *sqe = &ring_->sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    sqe->opcode = request->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = db_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(request->io_buffer_);
+    sqe->len = static_cast<uint32_t>(request->size_);
+    sqe->off = static_cast<uint64_t>(request->offset_);
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  ring_->sq_array_[index] = index;
+  __atomic_store_n(ring_->sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ring_->in_flight_++;
+  while (syscall(__NR_io_uring_enter, ring_->ring_fd_, 1, 0, 0, nullptr, 0) < 0 &&
+         (errno == EINTR || errno == EAGAIN)) {
+  }
+}
+
+void DiskManagerDirect::ReapIoUring() {
+  while (true) {
+    syscall(__NR_io_uring_enter, ring_->ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    unsigned head = *ring_->cq_head_;
+    size_t reaped = 0;
+    bool stop = false;
+    while (head != __atomic_load_n(ring_->cq_tail_, __ATOMIC_ACQUIRE)) {
+      const io_uring_cqe &cqe = ring_->cqes_[head & *ring_->cq_mask_];
+      auto *request = reinterpret_cast<Request *>(cqe.user_data);
+      if (request == nullptr) {
+        stop = true;
+      } else if (cqe.res > 0 && static_cast<size_t>(cqe.res) < request->size_) {
+        // A short transfer, which may also just have hit the end of the file: finish it synchronously.
+        request->transferred_ = cqe.res;
+        Complete(request, DoIo(request));
+      } else {
+        Complete(request, cqe.res);
+      }
+      head++;
+      reaped++;
+    }
+    __atomic_store_n(ring_->cq_head_, head, __ATOMIC_RELEASE);
+    {
+      std::scoped_lock<std::mutex> lock(ring_->latch_);
+      ring_->in_flight_ -= reaped;
+    }
+    ring_->slot_cv_.notify_all();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -27,24 +27,37 @@ namespace bustub {
 /**
  * Constructor: used for memory based manager
  */
-DiskManagerMemory::DiskManagerMemory(size_t pages) { memory_ = new char[pages * BUSTUB_PAGE_SIZE]; }
+DiskManagerMemory::DiskManagerMemory(size_t pages, size_t page_size) : DiskManager(page_size) {
+  memory_ = new char[pages * page_size_];
+}
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t offset = static_cast<size_t>(page_id) * page_size_;
   // set write cursor to offset
   num_writes_ += 1;
-  memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
+  memcpy(memory_ + offset, page_data, page_size_);
+  ExtendFileSize(PageOffset(page_id + 1));
+}
+
+/**
+ * Write the contents of num_pages consecutive pages into disk file
+ */
+void DiskManagerMemory::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  size_t offset = static_cast<size_t>(first_page_id) * page_size_;
+  num_writes_ += 1;
+  memcpy(memory_ + offset, page_data, num_pages * page_size_);
+  ExtendFileSize(PageOffset(first_page_id + static_cast<page_id_t>(num_pages)));
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
-  int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
-  memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
+  int64_t offset = static_cast<int64_t>(page_id) * page_size_;
+  memcpy(page_data, memory_ + offset, page_size_);
 }
 
 }  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file, size_t page_size) : DiskManager(page_size) {
+  file_name_ = db_file;
+  db_fd_ = open(db_file.c_str(), O_RDONLY);
+  struct stat stat_buf;
+  if (db_fd_ < 0 || fstat(db_fd_, &stat_buf) != 0) {
+    ShutDown();
+    throw Exception(ExceptionType::IO, "can't open db file " + db_file);
+  }
+  db_file_size_ = stat_buf.st_size;
+  try {
+    OpenFileHeader(false);
+  } catch (Exception &e) {
+    ShutDown();
+    throw;
+  }
+  mapping_size_ = stat_buf.st_size;
+  if (mapping_size_ == 0) {
+    // an empty file cannot be mapped, and has no page to view anyway
+    return;
+  }
+  void *mapping = mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (mapping == MAP_FAILED) {
+    mapping_size_ = 0;
+    ShutDown();
+    throw Exception(ExceptionType::IO, "can't map db file " + db_file);
+  }
+  mapping_ = static_cast<char *>(mapping);
+}
+
+DiskManagerMmap::~DiskManagerMmap() { ShutDown(); }
+
+void DiskManagerMmap::ShutDown() {
+  // not DiskManager::ShutDown, which would save or remove the free page map of the file
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+}
+
+void DiskManagerMmap::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  throw Exception(ExceptionType::INVALID, "can't write page " + std::to_string(first_page_id) + ": " + file_name_ +
+                                              " is mapped read only");
+}
+
+void DiskManagerMmap::WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) {
+  throw Exception(ExceptionType::INVALID, "can't write pages: " + file_name_ + " is mapped read only");
+}
+
+void DiskManagerMmap::DeallocatePage(page_id_t page_id) {
+  throw Exception(ExceptionType::INVALID, "can't deallocate page " + std::to_string(page_id) + ": " + file_name_ +
+                                              " is mapped read only");
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  auto offset = static_cast<size_t>(PageOffset(page_id));
+  if (page_id < 0 || offset >= mapping_size_) {
+    LOG_DEBUG("I/O error reading past end of file");
+    return;
+  }
+  // a page the file ends in the middle of reads as zeros past its end, as with DiskManager
+  auto size = std::min(page_size_, mapping_size_ - offset);
+  memcpy(page_data, mapping_ + offset, size);
+  memset(page_data + size, 0, page_size_ - size);
+  VerifyPage(page_id, page_data);
+}
+
+auto DiskManagerMmap::MapPage(page_id_t page_id) -> const char * {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= GetNumMappedPages()) {
+    return nullptr;
+  }
+  const char *page_data = mapping_ + PageOffset(page_id);
+  VerifyPage(page_id, page_data);
+  return page_data;
+}
+
+void DiskManagerMmap::WillNeed(page_id_t first_page_id, size_t num_pages) {
+  if (first_page_id < 0) {
+    return;
+  }
+  auto offset = static_cast<size_t>(PageOffset(first_page_id));
+  if (offset >= mapping_size_) {
+    return;
+  }
+  // madvise takes whole OS pages, and database pages are a multiple of them
+  auto size = std::min(num_pages * page_size_, mapping_size_ - offset);
+  madvise(mapping_ + offset, size, MADV_WILLNEED);
+}
+
+void DiskManagerMmap::VerifyPage(page_id_t page_id, const char *page_data) {
+  if (checksum_mode_.load() == ChecksumMode::NONE || IsChecksumValid(page_data)) {
+    return;
+  }
+  num_checksum_failures_ += 1;
+  throw Exception(ExceptionType::IO, "page " + std::to_string(page_id) + " failed its checksum");
+}
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated.cpp
+//
+// Identification: src/storage/disk/disk_manager_simulated.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_simulated.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>  // NOLINT
+
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+auto SimulatedDeviceFromString(const std::string &name, SimulatedDevice *device) -> bool {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "hdd") {
+    *device = SimulatedDevice::HDD;
+  } else if (lower == "sata_ssd") {
+    *device = SimulatedDevice::SATA_SSD;
+  } else if (lower == "nvme") {
+    *device = SimulatedDevice::NVME;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+auto SimulatedDeviceToString(SimulatedDevice device) -> std::string {
+  switch (device) {
+    case SimulatedDevice::HDD:
+      return "hdd";
+    case SimulatedDevice::SATA_SSD:
+      return "sata_ssd";
+    case SimulatedDevice::NVME:
+      return "nvme";
+  }
+  return "unknown";
+}
+
+auto DeviceProfile::Of(SimulatedDevice device) -> DeviceProfile {
+  DeviceProfile profile;
+  switch (device) {
+    case SimulatedDevice::HDD:
+      // a 7200 rpm disk: a random access costs a seek and half a rotation, and there is one head
+      profile.read_latency_ = microseconds(100);
+      profile.write_latency_ = microseconds(100);
+      profile.seek_latency_ = microseconds(8000);
+      profile.bandwidth_ = 160'000'000;
+      profile.queue_depth_ = 1;
+      break;
+    case SimulatedDevice::SATA_SSD:
+      profile.read_latency_ = microseconds(90);
+      profile.write_latency_ = microseconds(40);
+      profile.bandwidth_ = 550'000'000;
+      profile.queue_depth_ = 32;
+      break;
+    case SimulatedDevice::NVME:
+      profile.read_latency_ = microseconds(25);
+      profile.write_latency_ = microseconds(15);
+      profile.bandwidth_ = 3'200'000'000;
+      profile.queue_depth_ = 64;
+      break;
+  }
+  return profile;
+}
+
+DiskManagerSimulated::DiskManagerSimulated(const DeviceProfile &profile, bool use_virtual_clock, size_t page_size)
+    : DiskManagerUnlimitedMemory(page_size),
+      profile_(profile),
+      use_virtual_clock_(use_virtual_clock),
+      start_(Clock::now()) {}
+
+void DiskManagerSimulated::WritePages(page_id_t first_page_id, const char *page_data, size_t num_pages) {
+  num_writes_ += 1;
+  Simulate(true, first_page_id, num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    DiskManagerUnlimitedMemory::WritePage(first_page_id + static_cast<page_id_t>(i), page_data + i * page_size_);
+  }
+}
+
+void DiskManagerSimulated::ReadPage(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
+  Simulate(false, page_id, 1);
+  DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+}
+
+void DiskManagerSimulated::WritePageBatch(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first == pages[end - 1].first + 1) {
+      end++;
+    }
+    num_writes_ += 1;
+    Simulate(true, pages[begin].first, end - begin);
+    for (size_t i = begin; i < end; i++) {
+      DiskManagerUnlimitedMemory::WritePage(pages[i].first, pages[i].second);
+    }
+    begin = end;
+  }
+}
+
+void DiskManagerSimulated::Simulate(bool is_write, page_id_t page_id, size_t num_pages) {
+  std::unique_lock<std::mutex> lock(latch_);
+  auto now = [this] { return use_virtual_clock_ ? virtual_now_ : nanoseconds(Clock::now() - start_); };
+  auto issued = now();
+  if (!use_virtual_clock_ && profile_.queue_depth_ > 0) {
+    slot_cv_.wait(lock, [this] { return in_flight_ < profile_.queue_depth_; });
+  }
+  in_flight_++;
+
+  // the latency of the command, then the transfer, once the transfers ahead of it are done
+  auto ready = now() + (is_write ? profile_.write_latency_ : profile_.read_latency_);
+  if (page_id != next_page_id_) {
+    ready += profile_.seek_latency_;
+  }
+  next_page_id_ = page_id + static_cast<page_id_t>(num_pages);
+  auto completion = ready;
+  if (profile_.bandwidth_ > 0) {
+    auto bytes = static_cast<uint64_t>(num_pages * page_size_);
+    completion = std::max(ready, transfer_end_) + nanoseconds(bytes * 1'000'000'000 / profile_.bandwidth_);
+    transfer_end_ = completion;
+  }
+  last_completion_ = std::max(last_completion_, completion);
+  if (use_virtual_clock_) {
+    virtual_now_ = completion;
+  }
+  (is_write ? write_latency_ : read_latency_).Record(completion - issued);
+  if (tracing_) {
+    trace_.push_back({is_write, page_id, static_cast<uint32_t>(num_pages), issued, completion - issued});
+  }
+
+  if (!use_virtual_clock_) {
+    lock.unlock();
+    std::this_thread::sleep_until(start_ + completion);
+    lock.lock();
+  }
+  in_flight_--;
+  slot_cv_.notify_one();
+}
+
+auto DiskManagerSimulated::GetDeviceTime() -> nanoseconds {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return last_completion_;
+}
+
+void DiskManagerSimulated::SetTracing(bool enabled) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  tracing_ = enabled;
+}
+
+auto DiskManagerSimulated::GetTrace() -> std::vector<IoTraceRecord> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return trace_;
+}
+
+auto DiskManagerSimulated::SaveTrace(const std::string &file_name) -> bool {
+  auto trace = GetTrace();
+  std::ofstream out(file_name);
+  out << "# op page_id num_pages issued_us latency_us\n";
+  for (const auto &record : trace) {
+    out << (record.is_write_ ? 'W' : 'R') << ' ' << record.page_id_ << ' ' << record.num_pages_ << ' '
+        << std::chrono::duration<double, std::micro>(record.issued_).count() << ' '
+        << std::chrono::duration<double, std::micro>(record.latency_).count() << '\n';
+  }
+  out.flush();
+  return out.good();
+}
+
+}  // namespace bustub
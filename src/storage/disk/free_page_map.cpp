@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace bustub {
+
+void FreePageMap::Deallocate(page_id_t page_id) {
+  if (page_id < 0) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto word = static_cast<size_t>(page_id) / 64;
+  auto bit = uint64_t{1} << (page_id % 64);
+  if (word >= words_.size()) {
+    words_.resize(word + 1, 0);
+  }
+  if ((words_[word] & bit) == 0) {
+    words_[word] |= bit;
+    num_free_pages_++;
+  }
+}
+
+auto FreePageMap::Allocate(uint32_t stride, uint32_t offset, page_id_t near_page_id) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  page_id_t best = INVALID_PAGE_ID;
+  // Walk the set bits in page id order. Without a hint the first match is the lowest; with one, stop at the first
+  // match past the hint, since every later one is further away.
+  bool done = false;
+  for (size_t word = 0; word < words_.size() && !done; word++) {
+    for (uint64_t bits = words_[word]; bits != 0 && !done; bits &= bits - 1) {
+      auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+      if (static_cast<uint32_t>(page_id) % stride != offset) {
+        continue;
+      }
+      if (best == INVALID_PAGE_ID || std::abs(page_id - near_page_id) < std::abs(best - near_page_id)) {
+        best = page_id;
+      }
+      done = near_page_id == INVALID_PAGE_ID || page_id >= near_page_id;
+    }
+  }
+  if (best != INVALID_PAGE_ID) {
+    words_[best / 64] &= ~(uint64_t{1} << (best % 64));
+    num_free_pages_--;
+  }
+  return best;
+}
+
+auto FreePageMap::AllocateIn(uint32_t stride, uint32_t offset, page_id_t begin, page_id_t end) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto last_word = std::min(words_.size(), (static_cast<size_t>(std::max(end, 0)) + 63) / 64);
+  for (size_t word = static_cast<size_t>(std::max(begin, 0)) / 64; word < last_word; word++) {
+    for (uint64_t bits = words_[word]; bits != 0; bits &= bits - 1) {
+      auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+      if (page_id < begin || page_id >= end || static_cast<uint32_t>(page_id) % stride != offset) {
+        continue;
+      }
+      words_[word] &= ~(uint64_t{1} << (page_id % 64));
+      num_free_pages_--;
+      return page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreePageMap::MoveTo(FreePageMap *other) {
+  std::scoped_lock<std::mutex, std::mutex> lock(latch_, other->latch_);
+  if (other->words_.size() < words_.size()) {
+    other->words_.resize(words_.size(), 0);
+  }
+  for (size_t word = 0; word < words_.size(); word++) {
+    other->num_free_pages_ += __builtin_popcountll(words_[word] & ~other->words_[word]);
+    other->words_[word] |= words_[word];
+  }
+  words_.clear();
+  num_free_pages_ = 0;
+}
+
+auto FreePageMap::IsFree(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto word = static_cast<size_t>(page_id) / 64;
+  return page_id >= 0 && word < words_.size() && (words_[word] & (uint64_t{1} << (page_id % 64))) != 0;
+}
+
+auto FreePageMap::GetEnd() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t word = words_.size(); word > 0; word--) {
+    if (words_[word - 1] != 0) {
+      return (word - 1) * 64 + 64 - __builtin_clzll(words_[word - 1]);
+    }
+  }
+  return 0;
+}
+
+auto FreePageMap::GetNumFreePages() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return num_free_pages_;
+}
+
+auto FreePageMap::FileNameFor(const std::string &db_file_name) -> std::string {
+  auto n = db_file_name.rfind('.');
+  return (n == std::string::npos ? db_file_name : db_file_name.substr(0, n)) + ".fpm";
+}
+
+auto FreePageMap::Load(const std::string &file_name) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  words_.clear();
+  num_free_pages_ = 0;
+  std::ifstream in(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  if (!in.good() || magic != MAGIC) {
+    return false;
+  }
+  words_.resize(count);
+  in.read(reinterpret_cast<char *>(words_.data()), count * sizeof(uint64_t));
+  if (in.gcount() != static_cast<std::streamsize>(count * sizeof(uint64_t))) {
+    words_.clear();
+    return false;
+  }
+  for (auto word : words_) {
+    num_free_pages_ += __builtin_popcountll(word);
+  }
+  return true;
+}
+
+auto FreePageMap::Save(const std::string &file_name) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto tmp_file_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto count = static_cast<uint32_t>(words_.size());
+    out.write(reinterpret_cast<const char *>(&MAGIC), sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(words_.data()), words_.size() * sizeof(uint64_t));
+    if (!out.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <fstream>
 #include <string>
 
 #include "common/exception.h"
@@ -14,8 +15,9 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manag
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      leaf_max_size_(leaf_max_size > 0 ? leaf_max_size : LeafPage::MaxSizeFor(buffer_pool_manager->GetPageSize())),
+      internal_max_size_(internal_max_size > 0 ? internal_max_size
+                                               : InternalPage::MaxSizeFor(buffer_pool_manager->GetPageSize())) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -109,7 +111,9 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  auto header_guard = buffer_pool_manager_->FetchPageWrite(HEADER_PAGE_ID);
+  auto *header_page = header_guard.GetPage<HeaderPage>();
+  header_guard.SetDirty();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -117,7 +121,6 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
@@ -164,7 +167,8 @@ void BPLUSTREE_TYPE::Draw(BufferPoolManager *bpm, const std::string &outf) {
   }
   std::ofstream out(outf);
   out << "digraph G {" << std::endl;
-  ToGraph(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm, out);
+  auto root_guard = bpm->FetchPageBasic(root_page_id_);
+  ToGraph(root_guard.As<BPlusTreePage>(), bpm, out);
   out << "}" << std::endl;
   out.flush();
   out.close();
@@ -179,7 +183,8 @@ void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
     LOG_WARN("Print an empty tree");
     return;
   }
-  ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
+  auto root_guard = bpm->FetchPageBasic(root_page_id_);
+  ToString(root_guard.As<BPlusTreePage>(), bpm);
 }
 
 /**
@@ -192,11 +197,11 @@ void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
  * @param out
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const {
+void BPLUSTREE_TYPE::ToGraph(const BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const {
   std::string leaf_prefix("LEAF_");
   std::string internal_prefix("INT_");
   if (page->IsLeafPage()) {
-    auto *leaf = reinterpret_cast<LeafPage *>(page);
+    auto *leaf = reinterpret_cast<const LeafPage *>(page);
     // Print node name
     out << leaf_prefix << leaf->GetPageId();
     // Print node properties
@@ -227,7 +232,7 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
           << leaf->GetPageId() << ";\n";
     }
   } else {
-    auto *inner = reinterpret_cast<InternalPage *>(page);
+    auto *inner = reinterpret_cast<const InternalPage *>(page);
     // Print node name
     out << internal_prefix << inner->GetPageId();
     // Print node properties
@@ -259,19 +264,19 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     }
     // Print leaves
     for (int i = 0; i < inner->GetSize(); i++) {
-      auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      BasicPageGuard child_guard = bpm->FetchPageBasic(inner->ValueAt(i));
+      const auto *child_page = child_guard.As<BPlusTreePage>();
       ToGraph(child_page, bpm, out);
       if (i > 0) {
-        auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
+        BasicPageGuard sibling_guard = bpm->FetchPageBasic(inner->ValueAt(i - 1));
+        const auto *sibling_page = sibling_guard.As<BPlusTreePage>();
         if (!sibling_page->IsLeafPage() && !child_page->IsLeafPage()) {
           out << "{rank=same " << internal_prefix << sibling_page->GetPageId() << " " << internal_prefix
               << child_page->GetPageId() << "};\n";
         }
-        bpm->UnpinPage(sibling_page->GetPageId(), false);
       }
     }
   }
-  bpm->UnpinPage(page->GetPageId(), false);
 }
 
 /**
@@ -283,9 +288,9 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
  * @param bpm
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
+void BPLUSTREE_TYPE::ToString(const BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
-    auto *leaf = reinterpret_cast<LeafPage *>(page);
+    auto *leaf = reinterpret_cast<const LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
               << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
@@ -294,7 +299,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
     std::cout << std::endl;
   } else {
-    auto *internal = reinterpret_cast<InternalPage *>(page);
+    auto *internal = reinterpret_cast<const InternalPage *>(page);
     std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
@@ -302,10 +307,10 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
     std::cout << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
-      ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(internal->ValueAt(i))->GetData()), bpm);
+      BasicPageGuard child_guard = bpm->FetchPageBasic(internal->ValueAt(i));
+      ToString(child_guard.As<BPlusTreePage>(), bpm);
     }
   }
-  bpm->UnpinPage(page->GetPageId(), false);
 }
 
 template class BPlusTree<GenericKey<4>, RID, GenericComparator<4>>;
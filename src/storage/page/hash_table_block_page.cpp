@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_block_page.h"
+#include <cstddef>
 #include "storage/index/generic_key.h"
 
 namespace bustub {
@@ -43,6 +44,12 @@ auto HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const -> bool {
   return false;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::CheckLayout() {
+  static_assert(offsetof(HashTableBlockPage, occupied_) == HASH_TABLE_PAGE_HEADER_SIZE,
+                "the block starts past the page header");
+}
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBlockPage<int, int, IntComparator>;
 template class HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
@@ -12,10 +12,18 @@
 
 #include "storage/page/hash_table_directory_page.h"
 #include <algorithm>
+#include <cstddef>
 #include <unordered_map>
 #include "common/logger.h"
 
 namespace bustub {
+void HashTableDirectoryPage::CheckLayout() {
+  static_assert(offsetof(HashTableDirectoryPage, checksum_) == 8, "the checksum is at Page::OFFSET_CHECKSUM");
+  static_assert(offsetof(HashTableDirectoryPage, global_depth_) == HASH_TABLE_PAGE_HEADER_SIZE,
+                "the directory starts past the page header");
+  static_assert(sizeof(HashTableDirectoryPage) <= BUSTUB_PAGE_SIZE, "the directory fits in a page");
+}
+
 auto HashTableDirectoryPage::GetPageId() const -> page_id_t { return page_id_; }
 
 void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
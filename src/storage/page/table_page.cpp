@@ -12,7 +12,9 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 namespace bustub {
 
@@ -38,11 +40,6 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
 auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) -> bool {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
-  // If there is not enough space, then return false.
-  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
-  }
-
   // Try to find a free slot to reuse.
   uint32_t i;
   for (i = 0; i < GetTupleCount(); i++) {
@@ -53,9 +50,15 @@ auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
     }
   }
 
-  // If there was no free slot left, and we cannot claim it from the free space, then we give up.
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
+  // A reused slot only needs room for the tuple, a new one also for its slot.
+  uint32_t needed = tuple.size_ + (i == GetTupleCount() ? SIZE_TUPLE : 0);
+  if (GetFreeSpaceRemaining() < needed) {
+    // If the holes of deleted tuples do not make up for it either, then we give up.
+    if (GetFreeSpaceRemaining() + GetFragmentedSpace() < needed) {
+      return false;
+    }
+    // Otherwise compacting makes room. If slot i was at the end, it is given back, and i is now a new slot.
+    Compact();
   }
 
   // Otherwise we claim available free space..
@@ -157,7 +160,10 @@ auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   }
   // If there is not enuogh space to update, we need to update via delete followed by an insert (not enough space).
   if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_) {
-    return false;
+    if (GetFreeSpaceRemaining() + GetFragmentedSpace() + tuple_size < new_tuple.size_) {
+      return false;
+    }
+    Compact();
   }
 
   // Copy out the old value.
@@ -244,18 +250,22 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // The tuple next to the free space joins it, any other leaves a hole for Compact to reclaim.
+  if (tuple_offset == free_space_pointer) {
+    SetFreeSpacePointer(free_space_pointer + tuple_size);
+  }
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
-    }
+  // Give the empty slots at the end back to the free space.
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  // With no tuple left, there is no hole left either.
+  if (tuple_count == 0) {
+    SetFreeSpacePointer(static_cast<uint32_t>(GetPageSize()));
   }
 }
 
@@ -326,6 +336,77 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   return true;
 }
 
+auto TablePage::GetTupleOptimistic(const RID &rid, Tuple *tuple, uint64_t version) -> bool {
+  // The header and the slot may be torn by a writer, so check they lie inside the page before reading them.
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || slot_num >= (GetPageSize() - OFFSET_TUPLE_OFFSET) / SIZE_TUPLE) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  // Once validated the slot is one a writer left behind, so the tuple it points at lies inside the page.
+  if (IsDeleted(tuple_size) || !OptimisticValidate(version)) {
+    return false;
+  }
+  if (!tuple->allocated_ || tuple->size_ != tuple_size) {
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->data_ = new char[tuple_size];
+    tuple->allocated_ = true;
+  }
+  tuple->size_ = tuple_size;
+  memcpy(tuple->data_, GetData() + tuple_offset, tuple_size);
+  tuple->rid_ = rid;
+  return OptimisticValidate(version);
+}
+
+auto TablePage::Compact() -> bool {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  bool changed = tuple_count != GetTupleCount();
+  SetTupleCount(tuple_count);
+
+  // Move the tuples, the one at the end of the page first, each right after the one before.
+  std::vector<uint32_t> slots;
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetTupleSize(i) != 0) {
+      slots.push_back(i);
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [this](uint32_t a, uint32_t b) { return GetTupleOffsetAtSlot(a) > GetTupleOffsetAtSlot(b); });
+  auto end = static_cast<uint32_t>(GetPageSize());
+  for (auto slot : slots) {
+    uint32_t tuple_offset = GetTupleOffsetAtSlot(slot);
+    end -= UnsetDeletedFlag(GetTupleSize(slot));
+    if (tuple_offset != end) {
+      memmove(GetData() + end, GetData() + tuple_offset, UnsetDeletedFlag(GetTupleSize(slot)));
+      SetTupleOffsetAtSlot(slot, end);
+      changed = true;
+    }
+  }
+  changed = changed || end != GetFreeSpacePointer();
+  SetFreeSpacePointer(end);
+  return changed;
+}
+
+auto TablePage::GetFragmentedSpace() -> uint32_t {
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    used += UnsetDeletedFlag(GetTupleSize(i));
+  }
+  return static_cast<uint32_t>(GetPageSize()) - GetFreeSpacePointer() - used;
+}
+
+auto TablePage::GetFreeSpaceForInsert() -> uint32_t {
+  // The tuple may need a new slot too.
+  uint32_t free_space = GetFreeSpaceRemaining() + GetFragmentedSpace();
+  return free_space > SIZE_TUPLE ? free_space - static_cast<uint32_t>(SIZE_TUPLE) : 0;
+}
+
 auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(size_t page_size) : page_size_(page_size), tree_(2, 0) {}
+
+auto FreeSpaceMap::ToCategory(uint32_t free_space) const -> uint8_t {
+  return static_cast<uint8_t>(std::min<uint64_t>(uint64_t{free_space} * NUM_CATEGORIES / page_size_, 255));
+}
+
+void FreeSpaceMap::AddPage(page_id_t page_id, uint32_t free_space) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (pages_.size() == capacity_) {
+    // Double the leaves, and rebuild the nodes above them.
+    std::vector<uint8_t> tree(4 * capacity_, 0);
+    std::copy(tree_.begin() + capacity_, tree_.end(), tree.begin() + 2 * capacity_);
+    capacity_ *= 2;
+    for (size_t node = capacity_ - 1; node > 0; node--) {
+      tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+    }
+    tree_ = std::move(tree);
+  }
+  index_[page_id] = pages_.size();
+  pages_.push_back(page_id);
+  SetCategory(pages_.size() - 1, ToCategory(free_space));
+}
+
+void FreeSpaceMap::SetCategory(size_t index, uint8_t category) {
+  auto node = capacity_ + index;
+  tree_[node] = category;
+  for (node /= 2; node > 0; node /= 2) {
+    auto max = std::max(tree_[2 * node], tree_[2 * node + 1]);
+    if (tree_[node] == max) {
+      break;
+    }
+    tree_[node] = max;
+  }
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t free_space) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    SetCategory(it->second, ToCategory(free_space));
+  }
+}
+
+void FreeSpaceMap::RemovePage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto it = index_.find(page_id);
+  if (it == index_.end()) {
+    return;
+  }
+  SetCategory(it->second, 0);
+  pages_[it->second] = INVALID_PAGE_ID;
+  index_.erase(it);
+  while (!pages_.empty() && pages_.back() == INVALID_PAGE_ID) {
+    pages_.pop_back();
+  }
+}
+
+auto FreeSpaceMap::FindPage(uint32_t size) -> page_id_t {
+  // The category that guarantees size bytes, rounded up.
+  auto needed = (uint64_t{size} * NUM_CATEGORIES + page_size_ - 1) / page_size_;
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (needed >= NUM_CATEGORIES || tree_[1] < needed) {
+    return INVALID_PAGE_ID;
+  }
+  // Go down to the leftmost leaf with room.
+  size_t node = 1;
+  while (node < capacity_) {
+    node = tree_[2 * node] >= needed ? 2 * node : 2 * node + 1;
+  }
+  return pages_[node - capacity_];
+}
+
+auto FreeSpaceMap::GetLastPageId() -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return pages_.empty() ? INVALID_PAGE_ID : pages_.back();
+}
+
+auto FreeSpaceMap::GetNumPages() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return index_.size();
+}
+
+}  // namespace bustub
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "fmt/format.h"
@@ -23,88 +25,185 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager->GetPageSize()) {
+  // The free space map is not saved: build it by reading every page of the table once.
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id, AccessType::Scan);
+    BUSTUB_ENSURE(guard.IsValid(), "BPM full");
+    free_space_map_.AddPage(page_id, guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
+    page_id = guard.GetPage<TablePage>()->GetNextPageId();
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      free_space_map_(buffer_pool_manager->GetPageSize()) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
-  BUSTUB_ASSERT(first_page != nullptr,
+  auto first_page_guard = buffer_pool_manager_->NewPageGuarded(&first_page_id_);
+  BUSTUB_ASSERT(first_page_guard.IsValid(),
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  first_page_guard.GetPage<TablePage>()->Init(first_page_id_, buffer_pool_manager_->GetPageSize(), INVALID_LSN,
+                                              log_manager_, txn);
+  first_page_guard.SetDirty();
+  free_space_map_.AddPage(first_page_id_, first_page_guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 36 > buffer_pool_manager_->GetPageSize()) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // Insert into the first page the free space map finds room in. The map only errs on the side of too little room,
+  // unless a concurrent insert filled the page first, so the page is put right in the map and the next one is tried.
+  for (auto page_id = free_space_map_.FindPage(tuple.size_); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_.FindPage(tuple.size_)) {
+    auto guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    auto *page = guard.GetPage<TablePage>();
+    bool is_inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    free_space_map_.Update(page_id, page->GetFreeSpaceForInsert());
+    if (is_inserted) {
+      guard.SetDirty();
+      guard.Drop();
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+  }
+
+  auto cur_guard = buffer_pool_manager_->FetchPageWrite(free_space_map_.GetLastPageId());
+  if (!cur_guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
-
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      next_page->WLatch();
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+  // No page has room: append a new page to the table, and insert into that.
+  while (!cur_guard.GetPage<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    if (!NextPageForInsert(&cur_guard, txn)) {
+      return false;
     }
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  free_space_map_.Update(cur_guard.PageId(), cur_guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
+  cur_guard.SetDirty();
+  cur_guard.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+auto TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool {
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ + 36 > buffer_pool_manager_->GetPageSize()) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  rids->reserve(rids->size() + tuples.size());
+
+  // Fill the pages the free space map finds room in, each with as many of the tuples as it takes under one latch.
+  size_t next = 0;
+  while (next < tuples.size()) {
+    auto page_id = free_space_map_.FindPage(tuples[next].size_);
+    if (page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    auto guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    next = FillPage(&guard, tuples, next, rids, txn);
+  }
+  if (next == tuples.size()) {
+    return true;
+  }
+
+  // Then fill new pages appended to the table.
+  auto cur_guard = buffer_pool_manager_->FetchPageWrite(free_space_map_.GetLastPageId());
+  if (!cur_guard.IsValid()) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  for (next = FillPage(&cur_guard, tuples, next, rids, txn); next < tuples.size();
+       next = FillPage(&cur_guard, tuples, next, rids, txn)) {
+    if (!NextPageForInsert(&cur_guard, txn)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto TableHeap::FillPage(WritePageGuard *guard, const std::vector<Tuple> &tuples, size_t begin,
+                         std::vector<RID> *rids, Transaction *txn) -> size_t {
+  auto *page = guard->GetPage<TablePage>();
+  auto write_set = txn->GetWriteSet();
+  auto end = begin;
+  RID rid;
+  while (end < tuples.size() && page->InsertTuple(tuples[end], &rid, txn, lock_manager_, log_manager_)) {
+    rids->push_back(rid);
+    write_set->emplace_back(rid, WType::INSERT, Tuple{}, this);
+    end++;
+  }
+  free_space_map_.Update(guard->PageId(), page->GetFreeSpaceForInsert());
+  if (end != begin) {
+    guard->SetDirty();
+  }
+  return end;
+}
+
+auto TableHeap::NextPageForInsert(WritePageGuard *cur_guard, Transaction *txn) -> bool {
+  // Concurrent inserts may have appended pages since the last page was looked up, so the chain is followed to its end
+  // first. The next page is latched before the current one is released, so concurrent inserts cannot both append a
+  // page.
+  auto *cur_page = cur_guard->GetPage<TablePage>();
+  auto next_page_id = cur_page->GetNextPageId();
+  // If the next page is a valid page,
+  if (next_page_id != INVALID_PAGE_ID) {
+    *cur_guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+    BUSTUB_ENSURE(cur_guard->IsValid(), "BPM full");
+    return true;
+  }
+  // Otherwise we have run out of valid pages. We need to create a new page, close to the last one on disk.
+  auto new_guard =
+      buffer_pool_manager_->NewPageGuarded(&next_page_id, AccessType::Unknown, cur_guard->PageId()).UpgradeWrite();
+  // If we could not create a new page,
+  if (!new_guard.IsValid()) {
+    // Then life sucks and we abort the transaction.
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  // Otherwise we were able to create a new page. We initialize it now.
+  cur_page->SetNextPageId(next_page_id);
+  cur_guard->SetDirty();
+  new_guard.GetPage<TablePage>()->Init(next_page_id, buffer_pool_manager_->GetPageSize(), cur_guard->PageId(),
+                                       log_manager_, txn);
+  new_guard.SetDirty();
+  free_space_map_.AddPage(next_page_id, new_guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
+  *cur_guard = std::move(new_guard);
+  return true;
+}
+
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.GetPage<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  guard.SetDirty();
+  guard.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
@@ -112,18 +211,20 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
 
 auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  bool is_updated = guard.GetPage<TablePage>()->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    guard.SetDirty();
+    free_space_map_.Update(rid.GetPageId(), guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
+  }
+  guard.Drop();
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -133,47 +234,91 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  guard.GetPage<TablePage>()->ApplyDelete(rid, txn, log_manager_);
+  free_space_map_.Update(rid.GetPageId(), guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.SetDirty();
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(guard.IsValid(), "Couldn't find a page containing that RID.");
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  guard.GetPage<TablePage>()->RollbackDelete(rid, txn, log_manager_);
+  guard.SetDirty();
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::Vacuum(Transaction *txn) -> size_t {
+  size_t num_deleted = 0;
+  auto prev_guard = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  BUSTUB_ENSURE(prev_guard.IsValid(), "BPM full");
+  if (prev_guard.GetPage<TablePage>()->Compact()) {
+    prev_guard.SetDirty();
+  }
+  free_space_map_.Update(first_page_id_, prev_guard.GetPage<TablePage>()->GetFreeSpaceForInsert());
+  // Walk the pages latched two at a time, like inserts do, so that an empty page can be unlinked from its neighbours.
+  auto page_id = prev_guard.GetPage<TablePage>()->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto cur_guard = buffer_pool_manager_->FetchPageWrite(page_id);
+    BUSTUB_ENSURE(cur_guard.IsValid(), "BPM full");
+    auto *cur_page = cur_guard.GetPage<TablePage>();
+    if (cur_page->Compact()) {
+      cur_guard.SetDirty();
+    }
+    auto next_page_id = cur_page->GetNextPageId();
+    if (cur_page->GetTupleCount() > 0) {
+      free_space_map_.Update(page_id, cur_page->GetFreeSpaceForInsert());
+      prev_guard = std::move(cur_guard);
+      page_id = next_page_id;
+      continue;
+    }
+    // The page is empty: link its neighbours to each other, and delete it.
+    prev_guard.GetPage<TablePage>()->SetNextPageId(next_page_id);
+    prev_guard.SetDirty();
+    if (next_page_id != INVALID_PAGE_ID) {
+      auto next_guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      BUSTUB_ENSURE(next_guard.IsValid(), "BPM full");
+      next_guard.GetPage<TablePage>()->SetPrevPageId(prev_guard.PageId());
+      next_guard.SetDirty();
+    }
+    cur_guard.Drop();
+    free_space_map_.RemovePage(page_id);
+    if (buffer_pool_manager_->DeletePage(page_id)) {
+      num_deleted++;
+    }
+    page_id = next_page_id;
+  }
+  prev_guard.Drop();
+  return num_deleted;
+}
+
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock,
+                         AccessType access_type) -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto guard = buffer_pool_manager_->FetchPageBasic(rid.GetPageId(), access_type);
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!guard.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
   if (acquire_read_lock) {
-    page->RLatch();
-  }
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  if (acquire_read_lock) {
-    page->RUnlatch();
+    // Try without the latch first, so that readers of a hot page do not all write to the latch's cache line.
+    uint64_t version;
+    auto *page = guard.GetPage<TablePage>();
+    if (page->TryOptimisticLatch(&version) && page->GetTupleOptimistic(rid, tuple, version)) {
+      return true;
+    }
+    auto read_guard = guard.UpgradeRead();
+    return read_guard.GetPage<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
   }
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return guard.GetPage<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
 }
 
 auto TableHeap::Begin(Transaction *txn) -> TableIterator {
@@ -182,16 +327,13 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id, AccessType::Scan);
+    BUSTUB_ENSURE(guard.IsValid(), "BPM full");
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (guard.GetPage<TablePage>()->GetFirstTupleRid(&rid)) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = guard.GetPage<TablePage>()->GetNextPageId();
   }
   return {this, rid, txn};
 }
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "common/exception.h"
@@ -21,9 +22,16 @@ namespace bustub {
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true, AccessType::Scan)) {
       throw bustub::Exception("read non-existing tuple");
     }
+    page_id_t next_page_id;
+    {
+      auto guard = table_heap_->buffer_pool_manager_->FetchPageRead(rid.GetPageId(), AccessType::Scan);
+      BUSTUB_ENSURE(guard.IsValid(), "BPM full");
+      next_page_id = guard.GetPage<TablePage>()->GetNextPageId();
+    }
+    ReadAhead(rid.GetPageId(), next_page_id);
   }
 }
 
@@ -39,20 +47,16 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
+  auto cur_guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), AccessType::Scan);
+  BUSTUB_ENSURE(cur_guard.IsValid(), "BPM full");  // all pages are pinned
 
-  cur_page->RLatch();
+  page_id_t start_page_id = cur_guard.PageId();
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+  if (!cur_guard.GetPage<TablePage>()->GetNextTupleRid(tuple_->rid_, &next_tuple_rid)) {  // end of this page
+    while (cur_guard.GetPage<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      cur_guard = buffer_pool_manager->FetchPageRead(cur_guard.GetPage<TablePage>()->GetNextPageId(), AccessType::Scan);
+      BUSTUB_ENSURE(cur_guard.IsValid(), "BPM full");
+      if (cur_guard.GetPage<TablePage>()->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
@@ -62,18 +66,54 @@ auto TableIterator::operator++() -> TableIterator & {
   if (*this != table_heap_->End()) {
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false, AccessType::Scan)) {
       throw bustub::Exception("read non-existing tuple");
     }
   }
   // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  page_id_t cur_page_id = cur_guard.PageId();
+  page_id_t next_page_id = cur_guard.GetPage<TablePage>()->GetNextPageId();
+  cur_guard.Drop();
+  if (cur_page_id != start_page_id) {
+    ReadAhead(cur_page_id, next_page_id);
+  }
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t page_id, page_id_t next_page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  auto it = std::find(read_ahead_.begin(), read_ahead_.end(), page_id);
+  if (it == read_ahead_.end()) {
+    read_ahead_.clear();
+  } else {
+    read_ahead_.erase(read_ahead_.begin(), it + 1);
+  }
+
+  if (read_ahead_.empty()) {
+    if (next_page_id == INVALID_PAGE_ID || !buffer_pool_manager->PrefetchPages({next_page_id})) {
+      return;
+    }
+    read_ahead_.push_back(next_page_id);
+  }
+
+  // Follow the chain past the window's tail once the prefetch of the tail has landed; fetching it is then a hit.
+  while (read_ahead_.size() < TABLE_SCAN_READ_AHEAD && buffer_pool_manager->IsPageResident(read_ahead_.back())) {
+    page_id_t tail_page_id = read_ahead_.back();
+    page_id_t following_page_id;
+    {
+      auto tail_guard = buffer_pool_manager->FetchPageRead(tail_page_id, AccessType::Scan);
+      if (!tail_guard.IsValid()) {
+        return;
+      }
+      following_page_id = tail_guard.GetPage<TablePage>()->GetNextPageId();
+    }
+    if (following_page_id == INVALID_PAGE_ID || !buffer_pool_manager->PrefetchPages({following_page_id})) {
+      return;
+    }
+    read_ahead_.push_back(following_page_id);
+  }
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
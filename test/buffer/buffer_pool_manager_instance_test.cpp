@@ -12,18 +12,94 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 #include <cstdio>
+#include <future>  // NOLINT
+#include <iostream>
+#include <mutex>  // NOLINT
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
+/** Counts the pages read from disk, to measure how often the buffer pool misses. */
+class ReadCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<size_t> num_reads_{0};
+};
+
+/** Holds every read of one page until it is let go, to see what the buffer pool does while a read is slow. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit BlockingDiskManager(page_id_t blocked_page_id) : blocked_page_id_(blocked_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == blocked_page_id_) {
+      std::unique_lock<std::mutex> lock(latch_);
+      num_blocked_reads_++;
+      cv_.notify_all();
+      cv_.wait(lock, [this] { return is_released_; });
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  /** @brief Wait until a read of the blocked page has started. */
+  void WaitForBlockedRead() {
+    std::unique_lock<std::mutex> lock(latch_);
+    cv_.wait(lock, [this] { return num_blocked_reads_ > 0; });
+  }
+
+  void Release() {
+    std::scoped_lock<std::mutex> lock(latch_);
+    is_released_ = true;
+    cv_.notify_all();
+  }
+
+  auto GetNumBlockedReads() -> size_t {
+    std::scoped_lock<std::mutex> lock(latch_);
+    return num_blocked_reads_;
+  }
+
+ private:
+  const page_id_t blocked_page_id_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  size_t num_blocked_reads_{0};
+  bool is_released_{false};
+};
+
+/** Fails every read with an exception the buffer pool knows nothing about while failing_ is set. */
+class FailingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (failing_) {
+      num_failed_reads_++;
+      throw std::runtime_error("read failed");
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  std::atomic<bool> failing_{false};
+  std::atomic<size_t> num_failed_reads_{0};
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t k = 5;
@@ -89,7 +165,7 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerInstanceTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
   const size_t k = 5;
@@ -145,4 +221,501 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_threads = 8;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: half of the pages stay resident and are hammered through the hit path, while the other half of the
+  // frames keep being recycled for new pages. Pinned pages must never be evicted underneath their readers.
+  std::vector<page_id_t> hot_pages;
+  for (size_t i = 0; i < buffer_pool_size / 2; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+    hot_pages.push_back(page_id);
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &hot_pages, tid]() {
+      for (int i = 0; i < 2000; i++) {
+        if (tid == 0) {
+          page_id_t page_id;
+          auto *page = bpm->NewPage(&page_id);
+          if (page != nullptr) {
+            snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+            bpm->UnpinPage(page_id, true);
+          }
+          continue;
+        }
+        auto page_id = hot_pages[(tid + i) % hot_pages.size()];
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(std::to_string(page_id), page->GetData());
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (auto page_id : hot_pages) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentMissTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new BlockingDiskManager(0);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids(2 * buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  ASSERT_FALSE(bpm->IsPageResident(0));
+
+  // Scenario: while the read of page 0 is stuck on disk, hits, other misses and new pages still go through.
+  std::thread reader([bpm] {
+    auto *page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("0", std::string(page->GetData()));
+  });
+  disk_manager->WaitForBlockedRead();
+  auto others = std::async(std::launch::async, [bpm, &page_ids] {
+    for (auto page_id : {page_ids.back(), page_ids[1]}) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), page->GetData());
+      bpm->UnpinPage(page_id, false);
+    }
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  });
+  auto status = others.wait_for(std::chrono::seconds(10));
+  EXPECT_EQ(std::future_status::ready, status);
+  if (status != std::future_status::ready) {
+    disk_manager->Release();
+  }
+
+  // Scenario: a second fetch of page 0 waits for the read under way rather than reading the page into another frame,
+  // and the page cannot be deleted meanwhile.
+  std::thread second_reader([bpm] { EXPECT_NE(nullptr, bpm->FetchPage(0)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(bpm->DeletePage(0));
+  disk_manager->Release();
+  reader.join();
+  second_reader.join();
+  others.wait();
+  EXPECT_EQ(1, disk_manager->GetNumBlockedReads());
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(3, page->GetPinCount());
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PinnedVictimTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  // Every page is hit once more, so each has two accesses once the next miss reports the hits to the replacer.
+  for (size_t i = 1; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    bpm->UnpinPage(page_ids[i], false);
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+
+  // Scenario: the hot page with the oldest history is the replacer's first choice, but it is pinned during the miss,
+  // so the next page is evicted instead.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->UnpinPage(page_id, false);
+  EXPECT_TRUE(bpm->IsPageResident(page_ids[0]));
+  EXPECT_FALSE(bpm->IsPageResident(page_ids[1]));
+  bpm->UnpinPage(page_ids[0], false);
+
+  // Scenario: it kept its two accesses, so the new page, seen only once, goes before it.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->UnpinPage(page_id, false);
+  EXPECT_TRUE(bpm->IsPageResident(page_ids[0]));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty, unpinned pages.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: the cleaner writes every page back in the background, a few pages per round.
+  bpm->RunPageCleaner(1.0, 4);
+  for (int i = 0; i < 1000 && bpm->GetBackgroundWrites() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWrites());
+
+  // Scenario: evicting the now clean pages needs no write on this thread, and their data was not lost.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWrites());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    bpm->UnpinPage(page_id, false);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit, so the first half is evicted.
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  EXPECT_FALSE(bpm->IsPageResident(0));
+
+  // Scenario: prefetched pages become resident without being pinned.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    page_ids.push_back(page_id);
+  }
+  EXPECT_TRUE(bpm->PrefetchPages(page_ids));
+  for (int i = 0; i < 1000 && bpm->GetPrefetchedPages() < page_ids.size(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(page_ids.size(), bpm->GetPrefetchedPages());
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->IsPageResident(page_id));
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching resident pages is a no-op.
+  EXPECT_TRUE(bpm->PrefetchPages(page_ids));
+  bpm->FlushAllPages();
+  EXPECT_EQ(page_ids.size(), bpm->GetPrefetchedPages());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReadErrorTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit, so the first half is evicted.
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  EXPECT_FALSE(bpm->IsPageResident(0));
+
+  // Scenario: a failed read reaches the caller, whatever its type, and gives its frame back.
+  disk_manager->failing_ = true;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    EXPECT_THROW(bpm->FetchPage(page_id), std::runtime_error);
+  }
+
+  // Scenario: the prefetch thread swallows failed reads instead of taking the process down.
+  std::vector<page_id_t> page_ids{0, 1, 2, 3};
+  EXPECT_TRUE(bpm->PrefetchPages(page_ids));
+  for (int i = 0; i < 1000 && disk_manager->num_failed_reads_ < 2 * page_ids.size(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(2 * page_ids.size(), disk_manager->num_failed_reads_);
+  EXPECT_EQ(0, bpm->GetPrefetchedPages());
+
+  // Scenario: once reads succeed again, every frame can be pinned at the same time.
+  disk_manager->failing_ = false;
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+  }
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ScanRingTest) {
+  const size_t buffer_pool_size = 20;
+  const size_t num_hot_pages = 8;
+  const size_t num_scan_pages = 100;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write the pages of a large table, then a small set of hot pages that are looked up repeatedly.
+  std::vector<page_id_t> scan_page_ids;
+  for (size_t i = 0; i < num_scan_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    scan_page_ids.push_back(page_id);
+  }
+  std::vector<page_id_t> hot_page_ids;
+  for (size_t i = 0; i < num_hot_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    hot_page_ids.push_back(page_id);
+  }
+  for (auto page_id : hot_page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Lookup));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: scanning the whole table recycles a few frames and leaves the hot pages resident.
+  for (auto page_id : scan_page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Scan));
+    bpm->UnpinPage(page_id, false);
+  }
+  for (auto page_id : hot_page_ids) {
+    EXPECT_TRUE(bpm->IsPageResident(page_id));
+  }
+  EXPECT_TRUE(bpm->IsPageResident(scan_page_ids.back()));
+
+  // Scenario: a scanned page that is then looked up leaves the ring and is not recycled by the next scan.
+  page_id_t promoted_page_id = scan_page_ids.back();
+  ASSERT_NE(nullptr, bpm->FetchPage(promoted_page_id, AccessType::Lookup));
+  bpm->UnpinPage(promoted_page_id, false);
+  for (auto page_id : scan_page_ids) {
+    if (page_id != promoted_page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Scan));
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+  EXPECT_TRUE(bpm->IsPageResident(promoted_page_id));
+  for (auto page_id : hot_page_ids) {
+    EXPECT_TRUE(bpm->IsPageResident(page_id));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/**
+ * Interleave rounds of point lookups on a small hot set with full scans of a much larger table, and return the
+ * fraction of lookups that hit the buffer pool.
+ */
+auto ScanMixHitRatio(AccessType scan_access_type) -> double {
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 32;
+  const size_t num_scan_pages = 512;
+  const size_t num_rounds = 20;
+
+  auto *disk_manager = new ReadCountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_hot_pages + num_scan_pages; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  std::vector<page_id_t> hot_page_ids(page_ids.begin(), page_ids.begin() + num_hot_pages);
+  std::vector<page_id_t> scan_page_ids(page_ids.begin() + num_hot_pages, page_ids.end());
+
+  size_t lookups = 0;
+  size_t lookup_misses = 0;
+  for (size_t round = 0; round < num_rounds; round++) {
+    for (auto page_id : hot_page_ids) {
+      size_t reads_before = disk_manager->num_reads_;
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id, AccessType::Lookup));
+      bpm->UnpinPage(page_id, false);
+      lookups++;
+      lookup_misses += disk_manager->num_reads_ - reads_before;
+    }
+    for (auto page_id : scan_page_ids) {
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id, scan_access_type));
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  return 1.0 - static_cast<double>(lookup_misses) / static_cast<double>(lookups);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty pages and keep one of them pinned.
+  std::vector<page_id_t> page_ids(buffer_pool_size);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (size_t i = 1; i < buffer_pool_size; i++) {
+    bpm->UnpinPage(page_ids[i], true);
+  }
+  BufferPoolStats stats;
+  ASSERT_TRUE(bpm->GetStats(&stats));
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(0, stats.free_frames_);
+  EXPECT_EQ(1, stats.pinned_frames_);
+  EXPECT_EQ(buffer_pool_size - 1, stats.dirty_frames_);
+  EXPECT_EQ(buffer_pool_size, stats.new_pages_);
+
+  // Scenario: a hit, then misses that evict the dirty pages, then re-reading one of them.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[1]));
+  bpm->UnpinPage(page_ids[1], false);
+  for (size_t i = 0; i < 3; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[2]));
+  bpm->UnpinPage(page_ids[2], false);
+
+  ASSERT_TRUE(bpm->GetStats(&stats));
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(4, stats.evictions_);
+  EXPECT_EQ(3, stats.dirty_evictions_);
+  EXPECT_EQ(3, stats.foreground_writes_);
+  EXPECT_GT(LatencyHistogram::Quantile(stats.miss_latency_, 0.5), 0);
+  EXPECT_GT(LatencyHistogram::Quantile(stats.eviction_write_latency_, 0.99), 0);
+
+  // Scenario: the shards of a parallel pool add up.
+  BufferPoolStats total;
+  total.Merge(stats);
+  total.Merge(stats);
+  EXPECT_EQ(2 * buffer_pool_size, total.pool_size_);
+  EXPECT_EQ(2, total.misses_);
+
+  bpm->UnpinPage(page_ids[0], false);
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_ScanResistanceBenchmark) {
+  auto hit_ratio_unhinted = ScanMixHitRatio(AccessType::Unknown);
+  auto hit_ratio_hinted = ScanMixHitRatio(AccessType::Scan);
+  std::cout << "scan_hint=none lookup_hit_ratio=" << hit_ratio_unhinted << std::endl;
+  std::cout << "scan_hint=scan lookup_hit_ratio=" << hit_ratio_hinted << std::endl;
+  EXPECT_GE(hit_ratio_hinted, hit_ratio_unhinted);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_HitPathBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t ops_per_thread = 2000;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+
+  // Every page is resident, so all FetchPage calls below are buffer pool hits.
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    auto clock_start = std::chrono::system_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([bpm, &page_ids, tid]() {
+        for (size_t i = 0; i < ops_per_thread; i++) {
+          auto page_id = page_ids[(tid * 7 + i) % page_ids.size()];
+          bpm->FetchPage(page_id);
+          bpm->UnpinPage(page_id, false);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto clock_end = std::chrono::system_clock::now();
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+    std::cout << "threads=" << num_threads << " hits=" << num_threads * ops_per_thread
+              << " hits_per_ms=" << num_threads * ops_per_thread * 1000 / std::max<int64_t>(time_us, 1) << std::endl;
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
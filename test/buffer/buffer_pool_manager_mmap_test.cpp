@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_mmap_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_mmap_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_mmap.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+
+namespace bustub {
+
+class BufferPoolManagerMmapTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("mmap_test.db");
+    remove("mmap_test.log");
+    // Write the database the replica maps, with checksums.
+    DiskManager dm("mmap_test.db");
+    dm.SetChecksumMode(ChecksumMode::VERIFY);
+    for (int i = 0; i < NUM_PAGES; i++) {
+      dm.WritePage(i, PageOf(i).data());
+    }
+    dm.ShutDown();
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("mmap_test.db");
+    remove("mmap_test.log");
+  };
+
+  /** @return the data written to a page, past its header */
+  static auto PageOf(int page_id) -> std::vector<char> {
+    std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+    snprintf(page.data() + 16, BUSTUB_PAGE_SIZE - 16, "page %d", page_id);
+    return page;
+  }
+
+  static constexpr int NUM_PAGES = 8;
+};
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerMmapTest, ZeroCopyFetchTest) {
+  DiskManagerMmap dm("mmap_test.db");
+  dm.SetChecksumMode(ChecksumMode::VERIFY);
+  BufferPoolManagerMmap bpm(&dm);
+  EXPECT_EQ(NUM_PAGES, dm.GetNumPages());
+  EXPECT_EQ(NUM_PAGES, bpm.GetPoolSize());
+
+  // Scenario: a fetched page is a view of the mapping, not a copy, and fetching it again gives the same view.
+  EXPECT_FALSE(bpm.IsPageResident(3));
+  auto *page = bpm.FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(dm.MapPage(3), page->GetData());
+  EXPECT_EQ(3, page->GetPageId());
+  EXPECT_STREQ("page 3", page->GetData() + 16);
+  EXPECT_EQ(page, bpm.FetchPage(3));
+  EXPECT_EQ(2, page->GetPinCount());
+  EXPECT_TRUE(bpm.IsPageResident(3));
+
+  // Scenario: every page can be pinned at once, there is nothing to evict.
+  for (int i = 0; i < NUM_PAGES; i++) {
+    auto guard = bpm.FetchPageRead(i);
+    ASSERT_NE(nullptr, guard.GetData());
+    EXPECT_STREQ(("page " + std::to_string(i)).c_str(), guard.GetData() + 16);
+  }
+  EXPECT_EQ(nullptr, bpm.FetchPage(NUM_PAGES));
+
+  // Scenario: unpinning is counted, and being unpinned dirty does not make a page dirty.
+  EXPECT_TRUE(bpm.UnpinPage(3, true));
+  EXPECT_FALSE(page->IsDirty());
+  EXPECT_TRUE(bpm.UnpinPage(3, false));
+  EXPECT_FALSE(bpm.UnpinPage(3, false));
+  EXPECT_FALSE(bpm.UnpinPage(NUM_PAGES, false));
+
+  // Scenario: reads through the disk manager copy the page out of the mapping.
+  char buf[BUSTUB_PAGE_SIZE];
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(0, memcmp(dm.MapPage(5), buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(PageOf(5).data() + 16, buf + 16, BUSTUB_PAGE_SIZE - 16));
+  EXPECT_TRUE(bpm.PrefetchPages({0, 1, 2, 6}));
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerMmapTest, ReadOnlyTest) {
+  DiskManagerMmap dm("mmap_test.db");
+  BufferPoolManagerMmap bpm(&dm);
+
+  // Scenario: nothing can be created, deleted or written.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+  EXPECT_FALSE(bpm.DeletePage(0));
+  auto page = PageOf(0);
+  EXPECT_THROW(dm.WritePage(0, page.data()), Exception);
+  EXPECT_THROW(dm.WritePageBatch({{1, page.data()}}), Exception);
+  EXPECT_THROW(dm.DeallocatePage(2), Exception);
+  EXPECT_FALSE(bpm.FlushPage(0));
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  EXPECT_TRUE(bpm.FlushPage(0));
+  bpm.FlushAllPages();
+  EXPECT_TRUE(bpm.UnpinPage(0, false));
+
+  // Scenario: a file that does not exist is not created.
+  EXPECT_THROW(DiskManagerMmap("mmap_test_missing.db"), Exception);
+  EXPECT_FALSE(std::ifstream("mmap_test_missing.db").good());
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerMmapTest, ChecksumTest) {
+  {
+    std::fstream file("mmap_test.db", std::ios::binary | std::ios::in | std::ios::out);
+    // page 5, after the header page of the file
+    file.seekp(6 * BUSTUB_PAGE_SIZE + 100);
+    file.put('x');
+  }
+  DiskManagerMmap dm("mmap_test.db");
+  dm.SetChecksumMode(ChecksumMode::VERIFY);
+  BufferPoolManagerMmap bpm(&dm);
+
+  // Scenario: a corrupted page fails its checksum when it is first fetched, and no view of it is kept.
+  int failures = 0;
+  for (int i = 0; i < NUM_PAGES; i++) {
+    try {
+      auto *page = bpm.FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      bpm.UnpinPage(i, false);
+    } catch (Exception &e) {
+      EXPECT_EQ(ExceptionType::IO, e.GetType());
+      failures++;
+    }
+  }
+  EXPECT_EQ(1, failures);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  EXPECT_FALSE(bpm.IsPageResident(5));
+  char buf[BUSTUB_PAGE_SIZE];
+  EXPECT_THROW(dm.ReadPage(5, buf), Exception);
+
+  // Scenario: without checksums, the page is served as it is.
+  dm.SetChecksumMode(ChecksumMode::NONE);
+  ASSERT_NE(nullptr, bpm.FetchPage(5));
+  EXPECT_EQ('x', bpm.FetchPage(5)->GetData()[100]);
+}
+
+}  // namespace bustub
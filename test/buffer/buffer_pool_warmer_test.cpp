@@ -0,0 +1,278 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_warmer_test.cpp
+//
+// Identification: test/buffer/buffer_pool_warmer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_warmer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Wait for the prefetch thread of bpm to have read num_pages pages in total. */
+static void WaitForPrefetch(BufferPoolManagerInstance *bpm, size_t num_pages) {
+  for (int i = 0; i < 2000 && bpm->GetPrefetchedPages() < num_pages; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolWarmerTest, SaveAndWarmUpTest) {
+  const size_t buffer_pool_size = 10;
+  const std::string warm_file = "warmer_test.warm";
+  EXPECT_EQ(warm_file, BufferPoolWarmer::FileNameFor("warmer_test.db"));
+  remove(warm_file.c_str());
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+  auto *warmer = new BufferPoolWarmer(bpm, warm_file);
+
+  // Scenario: without a file there is nothing to warm up.
+  EXPECT_EQ(0, warmer->WarmUp());
+
+  // Scenario: write twice as many pages as fit, then keep coming back to a few of the resident ones.
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  std::vector<page_id_t> hot_page_ids{17, 12, 19};
+  for (int round = 0; round < 3; round++) {
+    for (auto page_id : hot_page_ids) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+
+  // Scenario: the saved set is the resident set, with the pages the replacer keeps longest first.
+  ASSERT_TRUE(warmer->Save());
+  std::vector<page_id_t> saved;
+  uint64_t db_file_id = 1;
+  ASSERT_TRUE(BufferPoolWarmer::ReadFile(warm_file, &db_file_id, &saved));
+  EXPECT_EQ(0, db_file_id);
+  ASSERT_EQ(buffer_pool_size, saved.size());
+  std::vector<page_id_t> hottest(saved.begin(), saved.begin() + hot_page_ids.size());
+  std::sort(hottest.begin(), hottest.end());
+  EXPECT_EQ((std::vector<page_id_t>{12, 17, 19}), hottest);
+  std::sort(saved.begin(), saved.end());
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(static_cast<page_id_t>(buffer_pool_size + i), saved[i]);
+  }
+  bpm->FlushAllPages();
+  delete warmer;
+  delete bpm;
+
+  // Scenario: a smaller pool restarted on the same disk is warmed up with the hottest pages that fit.
+  bpm = new BufferPoolManagerInstance(hot_page_ids.size(), disk_manager, 2);
+  warmer = new BufferPoolWarmer(bpm, warm_file);
+  EXPECT_EQ(hot_page_ids.size(), warmer->WarmUp());
+  WaitForPrefetch(bpm, hot_page_ids.size());
+  for (auto page_id : hot_page_ids) {
+    EXPECT_TRUE(bpm->IsPageResident(page_id));
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // Scenario: a warmer for another database file ignores the file.
+  auto *other_warmer = new BufferPoolWarmer(bpm, warm_file, 42);
+  EXPECT_EQ(0, other_warmer->WarmUp());
+  delete other_warmer;
+
+  // Scenario: a truncated file is ignored.
+  std::filesystem::resize_file(warm_file, std::filesystem::file_size(warm_file) - 1);
+  EXPECT_FALSE(BufferPoolWarmer::ReadFile(warm_file, &db_file_id, &saved));
+  EXPECT_EQ(0, warmer->WarmUp());
+
+  // Scenario: a file whose count is corrupt is ignored, rather than trusted with an allocation of that size.
+  std::fstream file(warm_file, std::ios::binary | std::ios::in | std::ios::out);
+  uint32_t count = 0xffffffff;
+  file.seekp(sizeof(uint32_t));
+  file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  file.close();
+  EXPECT_FALSE(BufferPoolWarmer::ReadFile(warm_file, &db_file_id, &saved));
+
+  delete warmer;
+  delete bpm;
+  delete disk_manager;
+  remove(warm_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolWarmerTest, StaleFileTest) {
+  const size_t buffer_pool_size = 10;
+  const std::string db_file = "warmer_stale_test.db";
+  const std::string warm_file = BufferPoolWarmer::FileNameFor(db_file);
+  remove(db_file.c_str());
+  remove(warm_file.c_str());
+
+  // Write a few pages and save them as the resident set.
+  auto *disk_manager = new DiskManager(db_file);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+  auto *warmer = new BufferPoolWarmer(bpm, warm_file, disk_manager->GetFileId());
+  for (size_t i = 0; i < buffer_pool_size / 2; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  ASSERT_TRUE(warmer->Save());
+  delete warmer;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: the database file is deleted and created again, empty, under the same name. Its warm-up file is not
+  // for it, and is ignored.
+  remove(db_file.c_str());
+  disk_manager = new DiskManager(db_file);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+  warmer = new BufferPoolWarmer(bpm, warm_file, disk_manager->GetFileId());
+  EXPECT_EQ(0, warmer->WarmUp());
+
+  // Scenario: pages that do not exist are not prefetched even when asked for, so a new page is in a single frame.
+  std::vector<page_id_t> page_ids{0, 1, 2, 3};
+  ASSERT_TRUE(bpm->PrefetchPages(page_ids, AccessType::Lookup));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->UnpinPage(page_id, true);
+  bpm->FlushAllPages();
+  auto resident = bpm->GetResidentPages();
+  EXPECT_EQ(1, std::count(resident.begin(), resident.end(), page_id));
+  EXPECT_EQ(0, bpm->GetPrefetchedPages());
+
+  delete warmer;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_file.c_str());
+  remove(warm_file.c_str());
+  remove("warmer_stale_test.log");
+}
+
+/**
+ * Fetch pages in windows of window_size accesses, 95% of them to the hot pages and the rest anywhere.
+ * @return the hit ratio of every window
+ */
+static auto RunWorkload(BufferPoolManagerInstance *bpm, const std::vector<page_id_t> &hot_page_ids, size_t num_pages,
+                        size_t num_windows, size_t window_size, std::mt19937 *rng) -> std::vector<double> {
+  std::uniform_int_distribution<size_t> percent(0, 99);
+  std::uniform_int_distribution<size_t> hot(0, hot_page_ids.size() - 1);
+  std::uniform_int_distribution<page_id_t> any(0, static_cast<page_id_t>(num_pages) - 1);
+  std::vector<double> hit_ratios;
+  for (size_t window = 0; window < num_windows; window++) {
+    BufferPoolStats before;
+    bpm->GetStats(&before);
+    for (size_t i = 0; i < window_size; i++) {
+      page_id_t page_id = percent(*rng) < 95 ? hot_page_ids[hot(*rng)] : any(*rng);
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    BufferPoolStats after;
+    bpm->GetStats(&after);
+    hit_ratios.push_back(static_cast<double>(after.hits_ - before.hits_) / static_cast<double>(window_size));
+  }
+  return hit_ratios;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolWarmerTest, DISABLED_TimeToSteadyStateBenchmark) {
+  const size_t num_pages = 1024;
+  const size_t buffer_pool_size = 128;
+  const size_t num_hot_pages = 100;
+  const size_t window_size = 200;
+  const size_t num_windows = 20;
+  const std::string db_file = "warmer_test.db";
+  const std::string warm_file = BufferPoolWarmer::FileNameFor(db_file);
+  remove(db_file.c_str());
+  remove(warm_file.c_str());
+
+  auto *disk_manager = new DiskManager(db_file);
+  std::mt19937 rng(15445);
+  std::vector<page_id_t> hot_page_ids;
+  {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    std::vector<page_id_t> page_ids(num_pages);
+    std::iota(page_ids.begin(), page_ids.end(), 0);
+    std::shuffle(page_ids.begin(), page_ids.end(), rng);
+    hot_page_ids.assign(page_ids.begin(), page_ids.begin() + num_hot_pages);
+
+    // Run until steady, then shut down the way a BustubInstance does, saving the resident set.
+    auto *warmer = new BufferPoolWarmer(bpm, warm_file);
+    warmer->Start();
+    RunWorkload(bpm, hot_page_ids, num_pages, num_windows, window_size, &rng);
+    delete warmer;
+    bpm->FlushAllPages();
+    delete bpm;
+  }
+
+  // Restart cold and warm, and count the accesses until a window comes within 5% of the hit ratio of the second half
+  // of the run, which is steady by then.
+  size_t accesses_to_steady[2];
+  for (bool warm_up : {false, true}) {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    auto *warmer = new BufferPoolWarmer(bpm, warm_file);
+    auto clock_start = std::chrono::steady_clock::now();
+    if (warm_up) {
+      auto queued = warmer->WarmUp();
+      EXPECT_EQ(buffer_pool_size, queued);
+      WaitForPrefetch(bpm, queued);
+    }
+    auto hit_ratios = RunWorkload(bpm, hot_page_ids, num_pages, num_windows, window_size, &rng);
+    auto clock_end = std::chrono::steady_clock::now();
+    double steady_hit_ratio = 0;
+    for (size_t window = num_windows / 2; window < num_windows; window++) {
+      steady_hit_ratio += hit_ratios[window] / static_cast<double>(num_windows - num_windows / 2);
+    }
+    size_t windows = 0;
+    while (windows < hit_ratios.size() && hit_ratios[windows] < 0.95 * steady_hit_ratio) {
+      windows++;
+    }
+    accesses_to_steady[warm_up ? 1 : 0] = windows * window_size;
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+    std::cout << (warm_up ? "warm" : "cold") << " start: first window hit ratio " << hit_ratios.front() << ", "
+              << windows * window_size << " accesses before reaching the steady hit ratio " << steady_hit_ratio << ", "
+              << time_us << " us for " << num_windows * window_size << " accesses" << std::endl;
+    delete warmer;
+    delete bpm;
+  }
+  EXPECT_EQ(0, accesses_to_steady[1]);
+  EXPECT_LT(accesses_to_steady[1], accesses_to_steady[0]);
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_file.c_str());
+  remove("warmer_test.log");
+  remove(warm_file.c_str());
+}
+
+}  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, LayoutTest) {
+  const size_t num_frames = 1000;
+  FrameArena arena(num_frames);
+
+  // Scenario: the mapping is huge page aligned, rounded up to whole huge pages, and zeroed.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_EQ(0, arena.GetSize() % FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_GE(arena.GetSize(), num_frames * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_frames; i++) {
+    EXPECT_EQ(arena.GetFrame(0) + i * BUSTUB_PAGE_SIZE, arena.GetFrame(i));
+    EXPECT_EQ(0, arena.GetFrame(i)[BUSTUB_PAGE_SIZE - 1]);
+  }
+  EXPECT_GE(FrameArena::NumaNodeCount(), 1);
+
+  // Scenario: buffer pool frames hand out the arena's memory, so the data of consecutive frames is contiguous.
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  page_id_t page_id;
+  auto *page0 = bpm->NewPage(&page_id);
+  auto *page1 = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page0);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page0->GetData()) % BUSTUB_PAGE_SIZE);
+  EXPECT_EQ(BUSTUB_PAGE_SIZE, std::abs(page1->GetData() - page0->GetData()));
+  delete bpm;
+  delete disk_manager;
+}
+
+/** @return the average time in nanoseconds of a read of one random cache line in each of num_ops random frames */
+auto RandomFrameReadNs(FrameArena *arena, size_t num_frames, size_t num_ops) -> size_t {
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<size_t> dist(0, num_frames - 1);
+  uint64_t sum = 0;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    sum += arena->GetFrame(dist(rng))[(i * 64) % BUSTUB_PAGE_SIZE];
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  EXPECT_EQ(0, sum);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count() / num_ops;
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, DISABLED_RandomAccessBenchmark) {
+  // 1 GB of frames; big enough to overflow the TLB reach of base pages many times over.
+  const size_t num_frames = 256 * 1024;
+  const size_t num_ops = 2000000;
+
+  for (bool huge_pages : {false, true}) {
+    FrameArena arena(num_frames, BUSTUB_PAGE_SIZE, huge_pages);
+    for (size_t i = 0; i < num_frames; i++) {
+      arena.GetFrame(i)[0] = 0;  // fault every page in before timing
+    }
+    std::cout << "arena_gb=" << arena.GetSize() / (1024 * 1024 * 1024) << " huge_pages=" << huge_pages
+              << " random_read_ns=" << RandomFrameReadNs(&arena, num_frames, num_ops) << std::endl;
+  }
+
+  // The same pattern through FetchPage on a pool where every page is resident.
+  const size_t pool_size = 64 * 1024;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  for (size_t i = 0; i < pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, pool_size - 1);
+  uint64_t sum = 0;
+  const size_t num_fetches = 200000;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_fetches; i++) {
+    auto page_id = dist(rng);
+    auto *page = bpm->FetchPage(page_id);
+    sum += page->GetData()[(i * 64) % BUSTUB_PAGE_SIZE];
+    bpm->UnpinPage(page_id, false);
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  EXPECT_EQ(0, sum);
+  std::cout << "pool_mb=" << pool_size * BUSTUB_PAGE_SIZE / (1024 * 1024) << " random_fetch_page_ns="
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count() / num_fetches
+            << std::endl;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
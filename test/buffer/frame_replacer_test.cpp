@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_replacer_test.cpp
+//
+// Identification: test/buffer/frame_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameReplacerTest, ArcSampleTest) {
+  ArcReplacer replacer(4);
+
+  // Scenario: four pages seen once each go to T1; a second access moves page 11 (frame 1) to T2.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, 10 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(1, 11);
+  EXPECT_EQ(4, replacer.Size());
+
+  // Scenario: T1 is evicted in LRU order first, and its pages are remembered in B1.
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+
+  // Scenario: page 10 comes back while still in B1, so it goes straight to T2 and T1 grows its target.
+  replacer.RecordAccess(0, 10);
+  replacer.SetEvictable(0, true);
+  replacer.RecordAccess(2, 99);
+  replacer.SetEvictable(2, true);
+  std::vector<frame_id_t> expected{3, 2, 1, 0};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(4));
+
+  // Scenario: pinned frames are skipped, and removing a frame does not leave a ghost.
+  replacer.SetEvictable(2, false);
+  replacer.SetEvictable(3, false);
+  EXPECT_EQ(2, replacer.Size());
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  replacer.Remove(0);
+  EXPECT_EQ(0, replacer.Size());
+  EXPECT_FALSE(replacer.Evict(&frame_id));
+}
+
+// NOLINTNEXTLINE
+TEST(FrameReplacerTest, TwoQueueSampleTest) {
+  TwoQueueReplacer replacer(8);  // A1in holds 2 frames, A1out remembers 4 pages
+
+  // Scenario: re-accessing a page in A1in does not move it.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, 10 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(0, 10);
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: pages 10 and 11 were remembered in A1out, so they come back into Am, which A1in is evicted before.
+  replacer.RecordAccess(0, 10);
+  replacer.SetEvictable(0, true);
+  replacer.RecordAccess(1, 11);
+  replacer.SetEvictable(1, true);
+  replacer.RecordAccess(4, 14);
+  replacer.SetEvictable(4, true);
+  std::vector<frame_id_t> expected{2, 3, 4, 0, 1};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(8));
+
+  // Scenario: within Am, a hit moves the frame to the MRU end.
+  replacer.RecordAccess(0, 10);
+  expected = {2, 3, 4, 1, 0};
+  EXPECT_EQ(expected, replacer.EvictionCandidates(8));
+  replacer.Remove(2);
+  EXPECT_EQ(4, replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(FrameReplacerTest, PolicyNameTest) {
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::LRU, ReplacerPolicy::ARC, ReplacerPolicy::TWO_Q}) {
+    ReplacerPolicy parsed;
+    ASSERT_TRUE(ReplacerPolicyFromString(ReplacerPolicyToString(policy), &parsed));
+    EXPECT_EQ(policy, parsed);
+  }
+  ReplacerPolicy parsed;
+  EXPECT_TRUE(ReplacerPolicyFromString("ARC", &parsed));
+  EXPECT_EQ(ReplacerPolicy::ARC, parsed);
+  EXPECT_FALSE(ReplacerPolicyFromString("mru", &parsed));
+}
+
+// NOLINTNEXTLINE
+TEST(FrameReplacerTest, BufferPoolPolicyTest) {
+  const size_t buffer_pool_size = 10;
+
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::LRU, ReplacerPolicy::ARC, ReplacerPolicy::TWO_Q}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, policy);
+    EXPECT_EQ(policy, bpm->GetReplacerPolicy());
+
+    // Scenario: write three pool sizes of pages, switching the policy halfway, and read all of them back.
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < 3 * buffer_pool_size; i++) {
+      if (i == buffer_pool_size + buffer_pool_size / 2) {
+        EXPECT_TRUE(bpm->SetReplacerPolicy(ReplacerPolicy::ARC));
+        EXPECT_EQ(ReplacerPolicy::ARC, bpm->GetReplacerPolicy());
+      }
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      page_ids.push_back(page_id);
+    }
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), page->GetData());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: with every frame pinned, no policy can find a victim.
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(page_ids.back()));
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
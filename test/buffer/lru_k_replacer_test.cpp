@@ -5,18 +5,22 @@
 #include "buffer/lru_k_replacer.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <list>
 #include <memory>
 #include <random>
 #include <set>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(LRUKReplacerTest, DISABLED_SampleTest) {
+TEST(LRUKReplacerTest, SampleTest) {
   LRUKReplacer lru_replacer(7, 2);
 
   // Scenario: add six elements to the replacer. We have [1,2,3,4,5]. Frame 6 is non-evictable.
@@ -97,4 +101,166 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+/**
+ * The LRU-K replacer as it was before eviction was ordered: Evict scans every tracked frame. Kept as the reference the
+ * ordered replacer must agree with, and as the baseline of the benchmark.
+ */
+class ScanLRUKReplacer {
+ public:
+  explicit ScanLRUKReplacer(size_t k) : k_(k) {}
+
+  auto Evict(frame_id_t *frame_id) -> bool {
+    bool found = false;
+    bool victim_inf = false;
+    size_t victim_ts = 0;
+    for (const auto &[fid, entry] : entries_) {
+      bool inf = entry.history_.size() < k_;
+      size_t ts = entry.history_.front();
+      if (entry.evictable_ && (!found || (inf && !victim_inf) || (inf == victim_inf && ts < victim_ts))) {
+        found = true;
+        victim_inf = inf;
+        victim_ts = ts;
+        *frame_id = fid;
+      }
+    }
+    if (found) {
+      entries_.erase(*frame_id);
+    }
+    return found;
+  }
+
+  void RecordAccess(frame_id_t frame_id) {
+    auto &history = entries_[frame_id].history_;
+    history.push_back(current_timestamp_++);
+    if (history.size() > k_) {
+      history.pop_front();
+    }
+  }
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) {
+    auto it = entries_.find(frame_id);
+    if (it != entries_.end()) {
+      it->second.evictable_ = set_evictable;
+    }
+  }
+
+ private:
+  struct Entry {
+    std::list<size_t> history_;
+    bool evictable_{false};
+  };
+  const size_t k_;
+  size_t current_timestamp_{0};
+  std::unordered_map<frame_id_t, Entry> entries_;
+};
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, MatchesScanTest) {
+  const size_t num_frames = 64;
+  LRUKReplacer replacer(num_frames, LRUK_REPLACER_K);
+  ScanLRUKReplacer reference(LRUK_REPLACER_K);
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<frame_id_t> dist(0, num_frames - 1);
+
+  // Scenario: under a random mix of accesses, pins, unpins and evictions, the ordered replacer picks the same victims
+  // as a scan over every frame.
+  for (int i = 0; i < 20000; i++) {
+    auto frame_id = dist(rng);
+    switch (rng() % 4) {
+      case 0:
+      case 1:
+        replacer.RecordAccess(frame_id);
+        reference.RecordAccess(frame_id);
+        break;
+      case 2: {
+        bool evictable = rng() % 4 != 0;
+        replacer.SetEvictable(frame_id, evictable);
+        reference.SetEvictable(frame_id, evictable);
+        break;
+      }
+      default: {
+        frame_id_t victim = -1;
+        frame_id_t expected = -1;
+        ASSERT_EQ(reference.Evict(&expected), replacer.Evict(&victim));
+        ASSERT_EQ(expected, victim);
+      }
+    }
+  }
+}
+
+/** @return the average time in nanoseconds of fn(i) over num_ops calls */
+template <typename F>
+auto TimePerOp(size_t num_ops, F &&fn) -> size_t {
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    fn(i);
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count() / num_ops;
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, DISABLED_LargePoolBenchmark) {
+  const size_t num_frames = 1000000;
+  const size_t num_ops = 2000;
+  // A scan eviction takes tens of milliseconds at this size, so the scan replacer evicts fewer times.
+  const size_t num_evictions = 20;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<frame_id_t> dist(0, num_frames - 1);
+  std::vector<frame_id_t> frames(num_ops);
+  for (auto &frame_id : frames) {
+    frame_id = dist(rng);
+  }
+
+  // Every frame is resident and evictable; half of them have been accessed k times. Each eviction is followed by
+  // re-admitting the victim, the way the buffer pool reuses a frame.
+  {
+    LRUKReplacer replacer(num_frames, LRUK_REPLACER_K);
+    for (size_t i = 0; i < num_frames; i++) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      for (size_t j = 0; j < (i % 2 == 0 ? 1 : LRUK_REPLACER_K); j++) {
+        replacer.RecordAccess(frame_id);
+      }
+      replacer.SetEvictable(frame_id, true);
+    }
+    auto record_ns = TimePerOp(num_ops, [&](size_t i) { replacer.RecordAccess(frames[i]); });
+    auto toggle_ns = TimePerOp(num_ops, [&](size_t i) {
+      replacer.SetEvictable(frames[i], false);
+      replacer.SetEvictable(frames[i], true);
+    });
+    auto evict_ns = TimePerOp(num_ops, [&](size_t i) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(replacer.Evict(&frame_id));
+      replacer.RecordAccess(frame_id);
+      replacer.SetEvictable(frame_id, true);
+    });
+    std::cout << "replacer=lru_k frames=" << num_frames << " record_access_ns=" << record_ns
+              << " set_evictable_ns=" << toggle_ns << " evict_ns=" << evict_ns << std::endl;
+  }
+  {
+    ScanLRUKReplacer replacer(LRUK_REPLACER_K);
+    for (size_t i = 0; i < num_frames; i++) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      for (size_t j = 0; j < (i % 2 == 0 ? 1 : LRUK_REPLACER_K); j++) {
+        replacer.RecordAccess(frame_id);
+      }
+      replacer.SetEvictable(frame_id, true);
+    }
+    auto record_ns = TimePerOp(num_ops, [&](size_t i) { replacer.RecordAccess(frames[i]); });
+    auto toggle_ns = TimePerOp(num_ops, [&](size_t i) {
+      replacer.SetEvictable(frames[i], false);
+      replacer.SetEvictable(frames[i], true);
+    });
+    auto evict_ns = TimePerOp(num_evictions, [&](size_t i) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(replacer.Evict(&frame_id));
+      replacer.RecordAccess(frame_id);
+      replacer.SetEvictable(frame_id, true);
+    });
+    std::cout << "replacer=lru_k_scan frames=" << num_frames << " record_access_ns=" << record_ns
+              << " set_evictable_ns=" << toggle_ns << " evict_ns=" << evict_ns << std::endl;
+  }
+}
+
 }  // namespace bustub
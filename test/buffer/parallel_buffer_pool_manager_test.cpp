@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: new pages are handed out round-robin, so the first num_instances ids cover every shard.
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+
+  std::vector<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(static_cast<page_id_t>(i), page_ids[i]);
+  }
+
+  // Scenario: every frame of every shard is pinned, so no new page can be created.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: unpinning a page frees a frame only in the shard that owns it.
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0U, page_id_temp % num_instances);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: the data written to page 0 survives the eviction.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(bpm->UnpinPage(0, false));
+
+  // Scenario: deleting pages works through the owning shard.
+  EXPECT_FALSE(bpm->DeletePage(page_ids[1]));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], false));
+  EXPECT_TRUE(bpm->DeletePage(page_ids[1]));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const size_t num_threads = 8;
+  const size_t num_runs = 20;
+
+  for (size_t run = 0; run < num_runs; run++) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new ParallelBufferPoolManager(4, 50, disk_manager);
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([bpm]() {
+        page_id_t temp_page_id;
+        std::vector<page_id_t> page_ids;
+        for (int i = 0; i < 10; i++) {
+          auto *new_page = bpm->NewPage(&temp_page_id);
+          ASSERT_NE(nullptr, new_page);
+          strcpy(new_page->GetData(), std::to_string(temp_page_id).c_str());  // NOLINT
+          page_ids.push_back(temp_page_id);
+        }
+        for (auto page_id : page_ids) {
+          ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+        }
+        for (auto page_id : page_ids) {
+          auto *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(0, strcmp(page->GetData(), std::to_string(page_id).c_str()));
+          ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+        }
+        for (auto page_id : page_ids) {
+          EXPECT_TRUE(bpm->DeletePage(page_id));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+/** Run num_threads threads that each issue FetchPage/UnpinPage pairs against a pool split into num_instances shards. */
+auto ParallelBufferPoolBenchmarkCall(size_t num_instances, size_t num_threads, size_t ops_per_thread) -> size_t {
+  const size_t total_frames = 256;
+  const size_t num_pages = total_frames / 2;  // every page stays resident, so we only measure latch contention
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+
+  auto clock_start = std::chrono::system_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &page_ids, tid, ops_per_thread]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        auto page_id = page_ids[dist(rng)];
+        if (bpm->FetchPage(page_id) != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto clock_end = std::chrono::system_clock::now();
+
+  delete bpm;
+  delete disk_manager;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(clock_end - clock_start).count();
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_ScalingBenchmark) {
+  const size_t num_threads = 8;
+  const size_t ops_per_thread = 5000;
+  for (size_t num_instances : {1, 2, 4, 8}) {
+    auto time_ms = ParallelBufferPoolBenchmarkCall(num_instances, num_threads, ops_per_thread);
+    std::cout << "instances=" << num_instances << " threads=" << num_threads << " ops=" << num_threads * ops_per_thread
+              << " time_ms=" << time_ms << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Scenario: the check value of the CRC-32C catalogue entry, and the test vectors of RFC 3720 (iSCSI).
+  std::string check = "123456789";
+  EXPECT_EQ(0xe3069283, Crc32c::Compute(check.data(), check.size()));
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8a9136aa, Crc32c::Compute(zeros.data(), zeros.size()));
+  std::vector<char> ones(32, static_cast<char>(0xff));
+  EXPECT_EQ(0x62a8ab43, Crc32c::Compute(ones.data(), ones.size()));
+  std::vector<char> ascending(32);
+  for (size_t i = 0; i < ascending.size(); i++) {
+    ascending[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x46dd794e, Crc32c::Compute(ascending.data(), ascending.size()));
+  EXPECT_EQ(0x46dd794e, Crc32c::ComputeSoftware(ascending.data(), ascending.size()));
+  EXPECT_EQ(0, Crc32c::Compute(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, HardwareMatchesSoftwareTest) {
+  std::mt19937 gen(15445);
+  std::vector<char> data(5000);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  // Scenario: any offset and length, so the eight byte steps of the crc32 instruction start anywhere.
+  for (size_t begin = 0; begin < 16; begin++) {
+    for (size_t size : {0, 1, 7, 8, 9, 63, 4096, 4000}) {
+      EXPECT_EQ(Crc32c::ComputeSoftware(data.data() + begin, size), Crc32c::Compute(data.data() + begin, size));
+    }
+  }
+  // Scenario: a checksum extended piece by piece is the checksum of the whole.
+  auto crc = Crc32c::Compute(data.data(), 1000);
+  crc = Crc32c::Compute(data.data() + 1000, 3, crc);
+  crc = Crc32c::Compute(data.data() + 1003, data.size() - 1003, crc);
+  EXPECT_EQ(Crc32c::Compute(data.data(), data.size()), crc);
+}
+
+}  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_test.cpp
+//
+// Identification: test/common/lz4_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/lz4.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** @return the size src compresses to, after checking that it decompresses back to itself */
+static auto RoundTrip(const std::vector<char> &src) -> size_t {
+  std::vector<char> compressed(Lz4::MaxCompressedSize(src.size()));
+  auto size = Lz4::Compress(src.data(), src.size(), compressed.data(), compressed.size());
+  EXPECT_NE(0, size);
+  std::vector<char> decompressed(src.size());
+  EXPECT_TRUE(Lz4::Decompress(compressed.data(), size, decompressed.data(), decompressed.size()));
+  EXPECT_EQ(src, decompressed);
+  return size;
+}
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, RoundTripTest) {
+  std::mt19937 gen(15445);
+  // Scenario: inputs too short to hold a match are stored as literals.
+  for (size_t size : {0, 1, 12, 13}) {
+    EXPECT_EQ(size + 1, RoundTrip(std::vector<char>(size, 'a')));
+  }
+
+  // Scenario: long runs, with lengths that need extra length bytes, and the short offsets of repeated patterns.
+  EXPECT_GT(100U, RoundTrip(std::vector<char>(4096, 0)));
+  EXPECT_GT(300U, RoundTrip(std::vector<char>(65536, 'x')));
+  std::vector<char> pattern(4096);
+  for (size_t i = 0; i < pattern.size(); i++) {
+    pattern[i] = "abc"[i % 3];
+  }
+  EXPECT_GT(100U, RoundTrip(pattern));
+
+  // Scenario: text, and records that differ in a few bytes, compress; random bytes do not, and grow a little.
+  std::string text;
+  while (text.size() < 4096) {
+    text += "the quick brown fox " + std::to_string(gen() % 100) + " jumps over the lazy dog. ";
+  }
+  EXPECT_GT(2048U, RoundTrip(std::vector<char>(text.begin(), text.end())));
+  std::vector<char> records(4096, 0);
+  for (size_t i = 0; i + 16 <= records.size(); i += 16) {
+    auto id = static_cast<uint32_t>(i / 16);
+    memcpy(&records[i], &id, sizeof(id));
+    memcpy(&records[i + 4], "terrier", 7);
+  }
+  EXPECT_GT(2048U, RoundTrip(records));
+  std::vector<char> random(4096);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  auto size = RoundTrip(random);
+  EXPECT_LE(random.size(), size);
+  EXPECT_GE(Lz4::MaxCompressedSize(random.size()), size);
+
+  // Scenario: output that does not fit the capacity given is not written.
+  std::vector<char> compressed(random.size());
+  EXPECT_EQ(0, Lz4::Compress(random.data(), random.size(), compressed.data(), compressed.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, CorruptInputTest) {
+  std::string text;
+  for (int i = 0; text.size() < 4096; i++) {
+    text += "tuple " + std::to_string(i % 50) + ";";
+  }
+  std::vector<char> compressed(Lz4::MaxCompressedSize(text.size()));
+  auto size = Lz4::Compress(text.data(), text.size(), compressed.data(), compressed.size());
+  ASSERT_NE(0, size);
+  std::vector<char> out(text.size());
+  ASSERT_TRUE(Lz4::Decompress(compressed.data(), size, out.data(), out.size()));
+
+  // Scenario: truncated input, input for another size, and garbage are rejected without writing past the output.
+  for (size_t truncated = 0; truncated < size; truncated += 7) {
+    EXPECT_FALSE(Lz4::Decompress(compressed.data(), truncated, out.data(), out.size()));
+  }
+  EXPECT_FALSE(Lz4::Decompress(compressed.data(), size, out.data(), out.size() - 1));
+  std::vector<char> larger(text.size() + 1);
+  EXPECT_FALSE(Lz4::Decompress(compressed.data(), size, larger.data(), larger.size()));
+  std::mt19937 gen(15445);
+  for (int round = 0; round < 100; round++) {
+    auto corrupted = compressed;
+    corrupted[gen() % size] ^= static_cast<char>(1 + gen() % 255);
+    Lz4::Decompress(corrupted.data(), size, out.data(), out.size());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+/**
+ * striped_hash_table_test.cpp
+ */
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "container/hash/striped_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(StripedHashTableTest, SampleTest) {
+  auto table = std::make_unique<StripedHashTable<int, std::string>>();
+
+  table->Insert(1, "a");
+  table->Insert(2, "b");
+  table->Insert(3, "c");
+  table->Insert(3, "d");
+  EXPECT_EQ(3U, table->Size());
+
+  std::string result;
+  EXPECT_TRUE(table->Find(3, result));
+  EXPECT_EQ("d", result);
+  EXPECT_FALSE(table->Find(10, result));
+
+  EXPECT_TRUE(table->Remove(1));
+  EXPECT_FALSE(table->Remove(1));
+  EXPECT_FALSE(table->Find(1, result));
+  EXPECT_EQ(2U, table->Size());
+}
+
+TEST(StripedHashTableTest, ConcurrentInsertFindTest) {
+  const int num_threads = 8;
+  const int keys_per_thread = 1000;
+  auto table = std::make_unique<StripedHashTable<page_id_t, frame_id_t>>();
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table]() {
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = tid * keys_per_thread + i;
+        table->Insert(key, key * 2);
+        int value;
+        EXPECT_TRUE(table->Find(key, value));
+        EXPECT_EQ(key * 2, value);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(static_cast<size_t>(num_threads * keys_per_thread), table->Size());
+}
+
+}  // namespace bustub
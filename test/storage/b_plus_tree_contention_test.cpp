@@ -2,18 +2,22 @@
  * b_plus_tree_contention_test.cpp
  */
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <future>  // NOLINT
 #include <iostream>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/table/table_heap.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -154,4 +158,68 @@ TEST(BPlusTreeTest, DISABLED_BPlusTreeContentionBenchmark2) {  // NOLINT
             << std::endl;
 }
 
+/**
+ * Reads random tuples of a table that fits in a handful of pages from num_threads threads, the access pattern of the
+ * upper levels of an index where every lookup passes through the same few pages.
+ * @return lookups per microsecond, over all threads
+ */
+auto PageReadBenchmarkCall(TableHeap *table, BufferPoolManager *bpm, const std::vector<RID> &rids,
+                           size_t num_threads, bool optimistic) -> double {
+  const size_t lookups_per_thread = 200000;
+  std::vector<std::thread> threads;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i]() {
+      Transaction transaction(static_cast<txn_id_t>(i + 1));
+      Tuple tuple;
+      size_t next = i * 7919;
+      for (size_t n = 0; n < lookups_per_thread; n++) {
+        next = (next * 1103515245 + 12345) & 0x7FFFFFFF;
+        const auto &rid = rids[next % rids.size()];
+        if (optimistic) {
+          table->GetTuple(rid, &tuple, &transaction);
+        } else {
+          auto guard = bpm->FetchPageRead(rid.GetPageId());
+          guard.GetPage<TablePage>()->GetTuple(rid, &tuple, &transaction, nullptr);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+  return static_cast<double>(num_threads * lookups_per_thread) / std::max<int64_t>(time_us, 1);
+}
+
+TEST(BPlusTreeTest, DISABLED_PageReadScalabilityBenchmark) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, transaction);
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 2000; key++) {
+    Tuple tuple{{ValueFactory::GetBigIntValue(key)}, key_schema.get()};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rids.push_back(rid);
+  }
+
+  std::cout << "This test will see how page reads scale with threads under shared latches and optimistic reads."
+            << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8, 16}) {
+    double latched = PageReadBenchmarkCall(table, bpm, rids, num_threads, false);
+    double optimistic = PageReadBenchmarkCall(table, bpm, rids, num_threads, true);
+    std::cout << num_threads << " threads: shared latch " << latched << " lookups/us, optimistic " << optimistic
+              << " lookups/us" << std::endl;
+  }
+
+  delete table;
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
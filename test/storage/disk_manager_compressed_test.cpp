@@ -0,0 +1,257 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_compressed_test.cpp
+//
+// Identification: test/storage/disk_manager_compressed_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "common/util/lz4.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_compressed.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class DiskManagerCompressedTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    for (const auto *file : {"compressed_test.db", "compressed_test.log", "compressed_test.cpm", "plain_test.db",
+                             "plain_test.log"}) {
+      remove(file);
+    }
+  }
+
+  // This function is called after every test.
+  void TearDown() override { SetUp(); };
+};
+
+/** @return a page of text that compresses well, different for every seed */
+static auto TextPage(int seed) -> std::vector<char> {
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  std::string text;
+  for (int i = 0; text.size() < BUSTUB_PAGE_SIZE / 2; i++) {
+    text += "page " + std::to_string(seed) + " line " + std::to_string(i) + "; ";
+  }
+  memcpy(page.data(), text.data(), text.size());
+  return page;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerCompressedTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE];
+  std::mt19937 gen(15445);
+  std::vector<char> random(BUSTUB_PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  auto *dm = new DiskManagerCompressed("compressed_test.db");
+
+  // Scenario: a page never written reads as zeros.
+  memset(buf, 'x', sizeof(buf));
+  dm->ReadPage(5, buf);
+  EXPECT_EQ(std::vector<char>(BUSTUB_PAGE_SIZE, 0), std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+
+  // Scenario: pages that compress take a fraction of a page on disk, a random one is stored as it is.
+  for (int i = 0; i < 8; i++) {
+    dm->WritePage(i, TextPage(i).data());
+  }
+  dm->WritePage(8, random.data());
+  EXPECT_EQ(8, dm->GetNumCompressedPages());
+  EXPECT_EQ(9, dm->GetNumPages());
+  EXPECT_GT(4 * BUSTUB_PAGE_SIZE, dm->GetStoredSize());
+  for (int i = 0; i < 8; i++) {
+    dm->ReadPage(i, buf);
+    EXPECT_EQ(TextPage(i), std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+  }
+  dm->ReadPage(8, buf);
+  EXPECT_EQ(random, std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+
+  // Scenario: rewriting pages with data of another size moves them, and the space they leave is reused, so the file
+  // does not grow when the same pages are written over and over.
+  size_t file_size = 0;
+  for (int round = 0; round < 20; round++) {
+    if (round == 10) {
+      file_size = dm->GetFileSize();
+    }
+    dm->WritePages(0, round % 2 == 0 ? TextPage(round).data() : random.data(), 1);
+    dm->WritePage(1, round % 2 == 1 ? TextPage(round).data() : random.data());
+  }
+  EXPECT_EQ(file_size, dm->GetFileSize());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(random, std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+  dm->ReadPage(1, buf);
+  EXPECT_EQ(TextPage(19), std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+
+  // Scenario: a deallocated page gives its slot back and reads as zeros until written again.
+  auto stored_size = dm->GetStoredSize();
+  dm->DeallocatePage(3);
+  EXPECT_GT(stored_size, dm->GetStoredSize());
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: after a shut down the map is loaded back, and the file holds no more than the slots in use.
+  dm->ShutDown();
+  delete dm;
+  EXPECT_TRUE(std::filesystem::exists("compressed_test.cpm"));
+  dm = new DiskManagerCompressed("compressed_test.db", BUSTUB_PAGE_SIZE);
+  EXPECT_FALSE(std::filesystem::exists("compressed_test.cpm"));
+  EXPECT_EQ(9, dm->GetNumPages());
+  EXPECT_EQ(dm->GetFileSize(), std::filesystem::file_size("compressed_test.db"));
+  for (int i : {2, 4, 5, 6, 7}) {
+    dm->ReadPage(i, buf);
+    EXPECT_EQ(TextPage(i), std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+  }
+  dm->ReadPage(1, buf);
+  EXPECT_EQ(TextPage(19), std::vector<char>(buf, buf + BUSTUB_PAGE_SIZE));
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerCompressedTest, CrashRecoveryTest) {
+  char buf[BUSTUB_PAGE_SIZE];
+  auto *dm = new DiskManagerCompressed("compressed_test.db");
+  dm->SetChecksumMode(ChecksumMode::VERIFY);
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  std::vector<std::vector<char>> pages;
+  for (int i = 0; i < 16; i++) {
+    pages.push_back(TextPage(i));
+  }
+  for (int i = 0; i < 16; i++) {
+    batch.emplace_back(i, pages[i].data());
+  }
+  dm->WritePageBatch(batch);
+  for (int i = 0; i < 16; i += 2) {
+    pages[i] = TextPage(1000 + i);
+    dm->WritePage(i, pages[i].data());
+  }
+
+  // Scenario: the process dies without shutting down. The map is rebuilt from the slots, and every page reads back as
+  // it was last written.
+  auto *restarted = new DiskManagerCompressed("compressed_test.db");
+  restarted->SetChecksumMode(ChecksumMode::VERIFY);
+  EXPECT_EQ(16, restarted->GetNumPages());
+  EXPECT_EQ(16, restarted->GetNumCompressedPages());
+  for (int i = 0; i < 16; i++) {
+    restarted->ReadPage(i, buf);
+    EXPECT_EQ(0, memcmp(pages[i].data() + 12, buf + 12, BUSTUB_PAGE_SIZE - 12));
+  }
+
+  // Scenario: the slot of page 5 is corrupted on disk. Its read fails instead of decompressing garbage.
+  {
+    std::fstream file("compressed_test.db", std::ios::binary | std::ios::in | std::ios::out);
+    const uint32_t header[] = {0x4c535043, 5};
+    std::vector<char> unit(COMPRESSED_SLOT_UNIT);
+    for (std::streamoff offset = 0; file.read(unit.data(), unit.size()); offset += unit.size()) {
+      if (memcmp(unit.data(), header, sizeof(header)) == 0) {
+        file.seekp(offset + 40);
+        file.put(static_cast<char>(unit[40] ^ 1));
+        break;
+      }
+    }
+  }
+  int failures = 0;
+  for (int i = 0; i < 16; i++) {
+    try {
+      restarted->ReadPage(i, buf);
+    } catch (Exception &e) {
+      EXPECT_EQ(ExceptionType::IO, e.GetType());
+      failures++;
+    }
+  }
+  EXPECT_EQ(1, failures);
+  EXPECT_EQ(1, restarted->GetNumChecksumFailures());
+  restarted->ShutDown();
+  delete restarted;
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerCompressedTest, DISABLED_CompressionBenchmark) {
+  const size_t num_tuples = 30000;
+  const size_t num_rounds = 8;
+
+  // The nft table of the terrier benchmark, (id, terrier) pairs with every terrier 0, built through a buffer pool.
+  auto *plain = new DiskManager("plain_test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, plain);
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, txn);
+  Schema schema({Column("id", TypeId::INTEGER), Column("terrier", TypeId::INTEGER)});
+  for (size_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(static_cast<int>(i)), ValueFactory::GetIntegerValue(0)}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, txn));
+  }
+  bpm->FlushAllPages();
+  auto num_pages = plain->GetNumPages();
+
+  // Copy every page to a compressing disk manager.
+  auto *compressed = new DiskManagerCompressed("compressed_test.db");
+  std::vector<char> pages(num_pages * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; i++) {
+    plain->ReadPage(static_cast<page_id_t>(i), pages.data() + i * BUSTUB_PAGE_SIZE);
+  }
+  compressed->WritePages(0, pages.data(), num_pages);
+
+  std::cout << "nft table: " << num_tuples << " tuples, " << num_pages << " pages, "
+            << compressed->GetNumCompressedPages() << " compressed" << std::endl;
+  std::cout << "on disk: " << num_pages * BUSTUB_PAGE_SIZE << " bytes plain, " << compressed->GetFileSize()
+            << " bytes compressed (" << 100.0 * compressed->GetFileSize() / (num_pages * BUSTUB_PAGE_SIZE) << "%)"
+            << std::endl;
+
+  // Decompression alone, then whole page reads through each disk manager, from the OS page cache.
+  std::vector<char> slot(Lz4::MaxCompressedSize(BUSTUB_PAGE_SIZE));
+  auto size = Lz4::Compress(pages.data() + BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, slot.data(), slot.size());
+  char buf[BUSTUB_PAGE_SIZE];
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < num_rounds * num_pages; round++) {
+    ASSERT_TRUE(Lz4::Decompress(slot.data(), size, buf, BUSTUB_PAGE_SIZE));
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+  std::cout << "lz4 decompress: " << seconds / (num_rounds * num_pages) * 1e9 << " ns per page" << std::endl;
+  for (DiskManager *dm : {plain, static_cast<DiskManager *>(compressed)}) {
+    clock_start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (size_t i = 0; i < num_pages; i++) {
+        dm->ReadPage(static_cast<page_id_t>(i), buf);
+      }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+    EXPECT_EQ(0, memcmp(buf, pages.data() + (num_pages - 1) * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+    std::cout << (dm == plain ? "plain" : "compressed") << " reads: " << seconds / (num_rounds * num_pages) * 1e9
+              << " ns per page" << std::endl;
+  }
+  EXPECT_GT(num_pages * BUSTUB_PAGE_SIZE / 2, compressed->GetFileSize());
+
+  compressed->ShutDown();
+  delete compressed;
+  delete table;
+  delete txn;
+  delete bpm;
+  plain->ShutDown();
+  delete plain;
+}
+
+}  // namespace bustub
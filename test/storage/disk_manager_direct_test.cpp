@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_direct_test.cpp
+//
+// Identification: test/storage/disk_manager_direct_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_direct.h"
+
+namespace bustub {
+
+class DiskManagerDirectTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("direct_test.db");
+    remove("direct_test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("direct_test.db");
+    remove("direct_test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerDirectTest, ReadWritePageTest) {
+  for (bool use_io_uring : {true, false}) {
+    remove("direct_test.db");
+    DiskManagerDirect dm("direct_test.db", BUSTUB_PAGE_SIZE, 8, use_io_uring);
+    if (use_io_uring && dm.GetBackend() != DiskManagerDirect::Backend::IO_URING) {
+      std::cout << "io_uring is not available, testing the thread pool only" << std::endl;
+      continue;
+    }
+
+    // Scenario: pages round trip through aligned and unaligned buffers, and unwritten pages read as zeros.
+    alignas(BUSTUB_PAGE_SIZE) char aligned[BUSTUB_PAGE_SIZE];
+    std::vector<char> unaligned(BUSTUB_PAGE_SIZE + 1);
+    char *data = unaligned.data() + 1;
+    std::memset(aligned, 'x', sizeof(aligned));
+    dm.ReadPage(3, aligned);
+    EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(aligned, BUSTUB_PAGE_SIZE));
+    std::strncpy(data, "A test string.", BUSTUB_PAGE_SIZE);
+    dm.WritePage(0, data);
+    dm.ReadPage(0, aligned);
+    EXPECT_STREQ("A test string.", aligned);
+    std::strncpy(aligned, "Another string.", BUSTUB_PAGE_SIZE);
+    dm.WritePage(5, aligned);
+    dm.ReadPage(5, data);
+    EXPECT_STREQ("Another string.", data);
+
+    // Scenario: many asynchronous writes and reads in flight at once, more than the queue depth.
+    const size_t num_pages = 64;
+    std::vector<char> pages(num_pages * BUSTUB_PAGE_SIZE);
+    std::vector<std::future<void>> done;
+    for (size_t i = 0; i < num_pages; i++) {
+      snprintf(pages.data() + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, "page %zu", i);
+      done.push_back(dm.WritePageAsync(static_cast<page_id_t>(i), pages.data() + i * BUSTUB_PAGE_SIZE));
+    }
+    for (auto &write : done) {
+      write.get();
+    }
+    done.clear();
+    std::vector<char> read_back(num_pages * BUSTUB_PAGE_SIZE);
+    for (size_t i = 0; i < num_pages; i++) {
+      done.push_back(dm.ReadPageAsync(static_cast<page_id_t>(i), read_back.data() + i * BUSTUB_PAGE_SIZE));
+    }
+    for (auto &read : done) {
+      read.get();
+    }
+    EXPECT_EQ(pages, read_back);
+
+    // Scenario: a run of pages written with one call reads back page by page.
+    dm.WritePagesAsync(100, pages.data(), 3).get();
+    for (page_id_t i = 0; i < 3; i++) {
+      dm.ReadPageAsync(100 + i, data).get();
+      EXPECT_EQ(0, std::memcmp(data, pages.data() + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+    }
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerDirectTest, ChecksumTest) {
+  for (auto checksum_mode : {ChecksumMode::VERIFY, ChecksumMode::REPAIR}) {
+    remove("direct_test.db");
+    DiskManagerDirect dm("direct_test.db", BUSTUB_PAGE_SIZE, 8);
+    dm.SetChecksumMode(checksum_mode);
+
+    // Scenario: checksummed pages round trip through every write path, and the caller's pages are left as they are.
+    const size_t num_pages = 8;
+    std::vector<char> pages(num_pages * BUSTUB_PAGE_SIZE);
+    for (size_t i = 0; i < num_pages; i++) {
+      snprintf(pages.data() + i * BUSTUB_PAGE_SIZE + 16, BUSTUB_PAGE_SIZE - 16, "page %zu", i);
+    }
+    auto original = pages;
+    dm.WritePage(0, pages.data());
+    dm.WritePages(1, pages.data() + BUSTUB_PAGE_SIZE, 3);
+    dm.WritePageBatch({{5, pages.data() + 5 * BUSTUB_PAGE_SIZE}, {4, pages.data() + 4 * BUSTUB_PAGE_SIZE}});
+    dm.WritePagesAsync(6, pages.data() + 6 * BUSTUB_PAGE_SIZE, 2).get();
+    EXPECT_EQ(original, pages);
+    std::vector<char> read_back(BUSTUB_PAGE_SIZE);
+    for (size_t i = 0; i < num_pages; i++) {
+      dm.ReadPageAsync(static_cast<page_id_t>(i), read_back.data()).get();
+      EXPECT_STREQ(pages.data() + i * BUSTUB_PAGE_SIZE + 16, read_back.data() + 16);
+    }
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+    // Scenario: a page corrupted on disk fails the asynchronous read through its future, or is repaired.
+    {
+      std::fstream file("direct_test.db", std::ios::binary | std::ios::in | std::ios::out);
+      // page 2, after the header page of the file
+      file.seekp(3 * BUSTUB_PAGE_SIZE + 16);
+      file.put('P');
+    }
+    auto read = dm.ReadPageAsync(2, read_back.data());
+    if (checksum_mode == ChecksumMode::VERIFY) {
+      EXPECT_THROW(read.get(), Exception);
+    } else {
+      read.get();
+      EXPECT_STREQ("page 2", read_back.data() + 16);
+      EXPECT_EQ(1, dm.GetNumRepairedPages());
+    }
+    EXPECT_EQ(1, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerDirectTest, DISABLED_RandomReadBenchmark) {
+  const size_t num_pages = 4096;
+  const size_t num_reads = 4000;
+  {
+    DiskManagerDirect dm("direct_test.db");
+    std::vector<char> pages(64 * BUSTUB_PAGE_SIZE, 'x');
+    for (size_t i = 0; i < num_pages; i += 64) {
+      dm.WritePages(static_cast<page_id_t>(i), pages.data(), 64);
+    }
+    dm.ShutDown();
+  }
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> any(0, num_pages - 1);
+  std::vector<page_id_t> page_ids(num_reads);
+  for (auto &page_id : page_ids) {
+    page_id = any(rng);
+  }
+
+  // Synchronous reads issue one I/O at a time; asynchronous ones keep a queue depth's worth in flight.
+  auto run = [&](DiskManager *dm, bool async) -> double {
+    std::vector<char> buffers(DISK_IO_QUEUE_DEPTH * BUSTUB_PAGE_SIZE);
+    auto clock_start = std::chrono::steady_clock::now();
+    if (async) {
+      std::vector<std::future<void>> in_flight(DISK_IO_QUEUE_DEPTH);
+      for (size_t i = 0; i < num_reads; i++) {
+        auto slot = i % DISK_IO_QUEUE_DEPTH;
+        if (in_flight[slot].valid()) {
+          in_flight[slot].get();
+        }
+        in_flight[slot] = dm->ReadPageAsync(page_ids[i], buffers.data() + slot * BUSTUB_PAGE_SIZE);
+      }
+      for (auto &read : in_flight) {
+        if (read.valid()) {
+          read.get();
+        }
+      }
+    } else {
+      for (auto page_id : page_ids) {
+        dm->ReadPage(page_id, buffers.data());
+      }
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+    return static_cast<double>(num_reads) * 1e6 / static_cast<double>(std::max<int64_t>(time_us, 1));
+  };
+
+  {
+    DiskManager dm("direct_test.db");
+    std::cout << "buffered, synchronous: " << run(&dm, false) << " IOPS" << std::endl;
+    dm.ShutDown();
+  }
+  for (bool use_io_uring : {true, false}) {
+    DiskManagerDirect dm("direct_test.db", BUSTUB_PAGE_SIZE, DISK_IO_QUEUE_DEPTH, use_io_uring);
+    auto backend = dm.GetBackend() == DiskManagerDirect::Backend::IO_URING ? "io_uring" : "thread pool";
+    auto direct = dm.IsDirect() ? "O_DIRECT" : "buffered";
+    if (use_io_uring) {
+      std::cout << direct << ", synchronous: " << run(&dm, false) << " IOPS" << std::endl;
+    }
+    std::cout << direct << ", " << backend << " at queue depth " << DISK_IO_QUEUE_DEPTH << ": " << run(&dm, true)
+              << " IOPS" << std::endl;
+    dm.ShutDown();
+  }
+}
+
+}  // namespace bustub
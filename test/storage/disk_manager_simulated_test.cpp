@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_simulated_test.cpp
+//
+// Identification: test/storage/disk_manager_simulated_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_simulated.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, DeviceNameTest) {
+  for (auto device : {SimulatedDevice::HDD, SimulatedDevice::SATA_SSD, SimulatedDevice::NVME}) {
+    SimulatedDevice parsed;
+    ASSERT_TRUE(SimulatedDeviceFromString(SimulatedDeviceToString(device), &parsed));
+    EXPECT_EQ(device, parsed);
+  }
+  SimulatedDevice parsed;
+  EXPECT_TRUE(SimulatedDeviceFromString("NVMe", &parsed));
+  EXPECT_EQ(SimulatedDevice::NVME, parsed);
+  EXPECT_FALSE(SimulatedDeviceFromString("tape", &parsed));
+
+  // Scenario: the faster the device, the lower its latency and the higher its bandwidth.
+  auto hdd = DeviceProfile::Of(SimulatedDevice::HDD);
+  auto ssd = DeviceProfile::Of(SimulatedDevice::SATA_SSD);
+  auto nvme = DeviceProfile::Of(SimulatedDevice::NVME);
+  EXPECT_GT(hdd.read_latency_ + hdd.seek_latency_, ssd.read_latency_);
+  EXPECT_GT(ssd.read_latency_, nvme.read_latency_);
+  EXPECT_LT(hdd.bandwidth_, ssd.bandwidth_);
+  EXPECT_LT(ssd.bandwidth_, nvme.bandwidth_);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, VirtualClockTest) {
+  const size_t num_pages = 64;
+  auto profile = DeviceProfile::Of(SimulatedDevice::HDD);
+  auto transfer = nanoseconds(uint64_t{BUSTUB_PAGE_SIZE} * 1'000'000'000 / profile.bandwidth_);
+  std::vector<char> pages(num_pages * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < pages.size(); i++) {
+    pages[i] = static_cast<char>(i / BUSTUB_PAGE_SIZE);
+  }
+
+  // Scenario: one sequential write of every page seeks once and transfers them all.
+  DiskManagerSimulated dm(profile, true);
+  dm.SetTracing(true);
+  dm.WritePages(0, pages.data(), num_pages);
+  auto write_time = profile.write_latency_ + profile.seek_latency_ + num_pages * transfer;
+  EXPECT_EQ(write_time, dm.GetDeviceTime());
+
+  // Scenario: reading the pages back in order only seeks for the first one; in a random order every read seeks.
+  char buf[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; i < num_pages; i++) {
+    dm.ReadPage(static_cast<page_id_t>(i), buf);
+    EXPECT_EQ(pages[i * BUSTUB_PAGE_SIZE], buf[0]);
+  }
+  auto sequential_time = dm.GetDeviceTime() - write_time;
+  EXPECT_EQ(profile.seek_latency_ + num_pages * (profile.read_latency_ + transfer), sequential_time);
+  std::vector<page_id_t> order;
+  for (size_t i = 0; i < num_pages; i++) {
+    order.push_back(static_cast<page_id_t>(i * 2 % num_pages + (i * 2 >= num_pages ? 1 : 0)));
+  }
+  auto before = dm.GetDeviceTime();
+  for (auto page_id : order) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(pages[page_id * BUSTUB_PAGE_SIZE], buf[0]);
+  }
+  EXPECT_EQ(num_pages * (profile.seek_latency_ + profile.read_latency_ + transfer), dm.GetDeviceTime() - before);
+  EXPECT_EQ(2 * num_pages, dm.GetNumReads());
+
+  // Scenario: a batch is written one I/O per run of consecutive pages.
+  dm.WritePageBatch({{7, pages.data()}, {2, pages.data()}, {3, pages.data()}, {1, pages.data()}});
+  EXPECT_EQ(3, dm.GetNumWrites());
+
+  // Scenario: the trace has every I/O, in order, and is the same on every run.
+  auto trace = dm.GetTrace();
+  ASSERT_EQ(1 + 2 * num_pages + 2, trace.size());
+  EXPECT_TRUE(trace[0].is_write_);
+  EXPECT_EQ(num_pages, trace[0].num_pages_);
+  EXPECT_EQ(nanoseconds(0), trace[0].issued_);
+  EXPECT_EQ(write_time, trace[0].latency_);
+  EXPECT_FALSE(trace[1].is_write_);
+  EXPECT_EQ(write_time, trace[1].issued_);
+  EXPECT_EQ(order[0], trace[num_pages + 1].page_id_);
+  EXPECT_EQ(1, trace[2 * num_pages + 1].page_id_);
+  EXPECT_EQ(3, trace[2 * num_pages + 1].num_pages_);
+  EXPECT_EQ(7, trace[2 * num_pages + 2].page_id_);
+  ASSERT_TRUE(dm.SaveTrace("simulated_test.trace"));
+  std::ifstream in("simulated_test.trace");
+  std::string line;
+  size_t num_lines = 0;
+  while (std::getline(in, line)) {
+    num_lines++;
+  }
+  EXPECT_EQ(1 + trace.size(), num_lines);
+  remove("simulated_test.trace");
+
+  LatencyHistogram::Buckets buckets{};
+  dm.GetReadLatency(&buckets);
+  EXPECT_LE(static_cast<uint64_t>(nanoseconds(profile.seek_latency_).count()),
+            LatencyHistogram::Quantile(buckets, 0.99));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, BandwidthTest) {
+  // Scenario: without latency, transfers take their size over the bandwidth and queue behind each other.
+  DeviceProfile profile;
+  profile.bandwidth_ = BUSTUB_PAGE_SIZE * 1000;
+  DiskManagerSimulated dm(profile, true);
+  std::vector<char> pages(10 * BUSTUB_PAGE_SIZE, 'x');
+  dm.WritePages(0, pages.data(), 10);
+  EXPECT_EQ(milliseconds(10), dm.GetDeviceTime());
+  dm.WritePages(20, pages.data(), 5);
+  EXPECT_EQ(milliseconds(15), dm.GetDeviceTime());
+
+  // Scenario: the default profile is instant.
+  DiskManagerSimulated instant(DeviceProfile{}, true);
+  instant.WritePages(0, pages.data(), 10);
+  EXPECT_EQ(nanoseconds(0), instant.GetDeviceTime());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerSimulatedTest, RealClockQueueDepthTest) {
+  DeviceProfile profile;
+  profile.read_latency_ = milliseconds(20);
+  profile.queue_depth_ = 2;
+  DiskManagerSimulated dm(profile);
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 'y');
+  dm.WritePage(0, page.data());
+
+  // Scenario: four reads at once on a device that takes two at a time take two rounds of latency.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&dm] {
+      char buf[BUSTUB_PAGE_SIZE];
+      dm.ReadPage(0, buf);
+      EXPECT_EQ('y', buf[0]);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(milliseconds(40), std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(4, dm.GetNumReads());
+  LatencyHistogram::Buckets buckets{};
+  dm.GetReadLatency(&buckets);
+  EXPECT_LE(static_cast<uint64_t>(nanoseconds(milliseconds(40)).count()), LatencyHistogram::Quantile(buckets, 1.0));
+}
+
+}  // namespace bustub
@@ -10,9 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
+#include "common/util/crc32c.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 
@@ -24,12 +34,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fpi");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fpi");
   };
 };
 
@@ -55,6 +67,72 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  const size_t num_pages = 4;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::vector<char> data(num_pages * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data.data() + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, "page %zu", i + 3);
+  }
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: a run of consecutive pages is one write, and every page lands at its own offset.
+  dm.WritePages(3, data.data(), num_pages);
+  EXPECT_EQ(1, dm.GetNumWrites());
+  for (size_t i = 0; i < num_pages; i++) {
+    dm.ReadPage(static_cast<page_id_t>(i + 3), buf);
+    EXPECT_EQ(std::memcmp(buf, data.data() + i * BUSTUB_PAGE_SIZE, sizeof(buf)), 0);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: threads write interleaved pages while reading back their own, with no shared file cursor to race on.
+  std::vector<std::thread> threads;
+  std::vector<size_t> mismatches(num_threads, 0);
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        auto page_id = static_cast<page_id_t>(i * num_threads + t);
+        snprintf(data, sizeof(data), "page %d", page_id);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        mismatches[t] += std::memcmp(buf, data, sizeof(buf)) != 0 ? 1 : 0;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(std::vector<size_t>(num_threads, 0), mismatches);
+  EXPECT_EQ(static_cast<int>(num_threads * pages_per_thread), dm.GetNumWrites());
+
+  // Scenario: the cached file size covers every page written, so each reads back rather than past the end.
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  for (size_t i = 0; i < num_threads * pages_per_thread; i++) {
+    dm.ReadPage(static_cast<page_id_t>(i), buf);
+    EXPECT_EQ("page " + std::to_string(i), std::string(buf));
+  }
+  dm.ShutDown();
+
+  // Scenario: reopening the file picks its size up again.
+  auto reopened = DiskManager(db_file);
+  reopened.ReadPage(static_cast<page_id_t>(num_threads * pages_per_thread - 1), buf);
+  EXPECT_EQ("page " + std::to_string(num_threads * pages_per_thread - 1), std::string(buf));
+  reopened.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,7 +150,326 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+/** @return the number of latencies recorded in buckets */
+static auto CountLatencies(const LatencyHistogram::Buckets &buckets) -> uint64_t {
+  uint64_t count = 0;
+  for (auto bucket : buckets) {
+    count += bucket;
+  }
+  return count;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DurabilityModeTest) {
+  DurabilityMode mode;
+  EXPECT_TRUE(DurabilityModeFromString("FDataSync", &mode));
+  EXPECT_EQ(DurabilityMode::FDATASYNC, mode);
+  EXPECT_EQ("flush", DurabilityModeToString(DurabilityMode::FLUSH));
+  EXPECT_FALSE(DurabilityModeFromString("fsync", &mode));
+
+  const size_t num_pages = 6;
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+  }
+  for (auto durability_mode : {DurabilityMode::NONE, DurabilityMode::FLUSH, DurabilityMode::FDATASYNC}) {
+    remove("test.db");
+    remove("test.log");
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file);
+    dm.SetDurabilityMode(durability_mode);
+    bool syncs = durability_mode == DurabilityMode::FDATASYNC;
+
+    // Scenario: every single page write is followed by a sync, in fdatasync mode only.
+    dm.WritePage(0, data[0].data());
+    EXPECT_EQ(1, dm.GetNumWrites());
+    EXPECT_EQ(syncs ? 1 : 0, dm.GetNumSyncs());
+
+    // Scenario: a batch out of order is one write per run of consecutive pages and a single sync.
+    dm.WritePageBatch({{5, data[5].data()}, {2, data[2].data()}, {1, data[1].data()}, {4, data[4].data()}});
+    EXPECT_EQ(3, dm.GetNumWrites());
+    EXPECT_EQ(syncs ? 2 : 0, dm.GetNumSyncs());
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    for (size_t i : {0, 1, 2, 4, 5}) {
+      dm.ReadPage(static_cast<page_id_t>(i), buf);
+      EXPECT_EQ(0, std::memcmp(buf, data[i].data(), sizeof(buf)));
+    }
+
+    // Scenario: log buffers of a group commit are one flush, and read back in order.
+    std::string first = "first commit;";
+    std::string second = "second commit;";
+    dm.WriteLogBatch({{first.data(), static_cast<int>(first.size())}, {second.data(), 0},
+                      {second.data(), static_cast<int>(second.size())}});
+    EXPECT_EQ(1, dm.GetNumFlushes());
+    EXPECT_EQ(syncs ? 3 : 0, dm.GetNumSyncs());
+    char log[64] = {0};
+    EXPECT_TRUE(dm.ReadLog(log, static_cast<int>(first.size() + second.size()), 0));
+    EXPECT_EQ(first + second, std::string(log));
+    EXPECT_FALSE(dm.ReadLog(log, sizeof(log), static_cast<int>(first.size() + second.size())));
+
+    // Scenario: the flushes or syncs are timed, one latency per write call.
+    LatencyHistogram::Buckets db_latency{};
+    LatencyHistogram::Buckets log_latency{};
+    dm.GetDbSyncLatency(&db_latency);
+    dm.GetLogSyncLatency(&log_latency);
+    EXPECT_EQ(durability_mode == DurabilityMode::NONE ? 0 : 2, CountLatencies(db_latency));
+    EXPECT_EQ(durability_mode == DurabilityMode::NONE ? 0 : 1, CountLatencies(log_latency));
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_DurabilityBenchmark) {
+  const size_t num_pages = 256;
+  const size_t batch_size = 16;
+  std::vector<char> data(num_pages * BUSTUB_PAGE_SIZE, 'x');
+
+  // Write the same pages once per mode, page by page and then in batches, and report writes and syncs per second.
+  for (auto durability_mode : {DurabilityMode::NONE, DurabilityMode::FLUSH, DurabilityMode::FDATASYNC}) {
+    for (bool batched : {false, true}) {
+      remove("test.db");
+      std::string db_file("test.db");
+      auto dm = DiskManager(db_file);
+      dm.SetDurabilityMode(durability_mode);
+      auto clock_start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_pages; i += batched ? batch_size : 1) {
+        if (!batched) {
+          dm.WritePage(static_cast<page_id_t>(i), data.data() + i * BUSTUB_PAGE_SIZE);
+          continue;
+        }
+        std::vector<std::pair<page_id_t, const char *>> batch;
+        for (size_t j = i; j < i + batch_size; j++) {
+          batch.emplace_back(static_cast<page_id_t>(j), data.data() + j * BUSTUB_PAGE_SIZE);
+        }
+        dm.WritePageBatch(std::move(batch));
+      }
+      auto clock_end = std::chrono::steady_clock::now();
+      auto seconds = std::chrono::duration<double>(clock_end - clock_start).count();
+      LatencyHistogram::Buckets latency{};
+      dm.GetDbSyncLatency(&latency);
+      std::cout << DurabilityModeToString(durability_mode) << (batched ? ", batched: " : ", page by page: ")
+                << num_pages / seconds << " pages/s, " << dm.GetNumWrites() / seconds << " writes/s, "
+                << dm.GetNumSyncs() / seconds << " syncs/s, p50 sync latency <= "
+                << LatencyHistogram::Quantile(latency, 0.5) / 1000.0 << " us" << std::endl;
+      dm.ShutDown();
+    }
+  }
+}
+
+/** Overwrite part of a page in the file behind the disk manager's back, the way a torn write or a bad sector does. */
+static void OverwriteOnDisk(page_id_t page_id, size_t offset, const char *data, size_t size) {
+  std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+  // page 0 comes right after the header page of the file
+  file.seekp(static_cast<std::streamoff>((page_id + 1) * BUSTUB_PAGE_SIZE + offset));
+  file.write(data, static_cast<std::streamsize>(size));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  ChecksumMode mode;
+  EXPECT_TRUE(ChecksumModeFromString("Repair", &mode));
+  EXPECT_EQ(ChecksumMode::REPAIR, mode);
+  EXPECT_EQ("verify", ChecksumModeToString(ChecksumMode::VERIFY));
+  EXPECT_FALSE(ChecksumModeFromString("crc", &mode));
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  const size_t offset_checksum = 8;
+  std::strncpy(data + 16, "A checksummed page.", sizeof(data) - 16);
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  dm.SetChecksumMode(ChecksumMode::VERIFY);
+
+  // Scenario: the page reads back as written, with its checksum set in the header. The caller's copy is untouched.
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf + 12, data + 12, sizeof(buf) - 12));
+  uint32_t checksum;
+  std::memcpy(&checksum, buf + offset_checksum, sizeof(checksum));
+  EXPECT_EQ(DiskManager::ComputeChecksum(buf, sizeof(buf)), checksum);
+  EXPECT_EQ(0, *reinterpret_cast<uint32_t *>(data + offset_checksum));
+
+  // Scenario: a page never written reads as zeros, which is not a checksum failure.
+  EXPECT_NO_THROW(dm.ReadPage(1, buf));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: a single flipped bit on disk fails the read, until checksums are turned off.
+  char flipped = static_cast<char>('A' ^ 0x10);
+  OverwriteOnDisk(0, 16, &flipped, 1);
+  EXPECT_THROW(dm.ReadPage(0, buf), Exception);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  dm.SetChecksumMode(ChecksumMode::NONE);
+  EXPECT_NO_THROW(dm.ReadPage(0, buf));
+  EXPECT_EQ(flipped, buf[16]);
+  dm.ShutDown();
+
+  // Scenario: a file of the format before checksums, with no file header, is refused when opened rather than having
+  // its pages fail their checksums. So is a file of a later format version.
+  {
+    std::ofstream out(db_file, std::ios::binary | std::ios::trunc);
+    out.write(data, sizeof(data));
+  }
+  try {
+    DiskManager old_dm(db_file);
+    FAIL() << "opened a file without a file header";
+  } catch (Exception &e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("older version"));
+  }
+  const uint32_t header[] = {0x42445442, 2, BUSTUB_PAGE_SIZE};
+  OverwriteOnDisk(-1, 0, reinterpret_cast<const char *>(header), sizeof(header));
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TornWriteRepairTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::vector<char> old_data(BUSTUB_PAGE_SIZE, 'o');
+  std::vector<char> new_data(BUSTUB_PAGE_SIZE, 'n');
+  const size_t half = BUSTUB_PAGE_SIZE / 2;
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file);
+  dm->SetChecksumMode(ChecksumMode::REPAIR);
+
+  // Scenario: an update of the page is torn, only its first half reached the disk. The read puts back the logged
+  // image of the update, on disk too.
+  dm->WritePage(3, old_data.data());
+  dm->WritePage(3, new_data.data());
+  EXPECT_TRUE(std::filesystem::exists("test.fpi"));
+  OverwriteOnDisk(3, half, old_data.data() + half, half);
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(0, std::memcmp(buf + 12, new_data.data() + 12, BUSTUB_PAGE_SIZE - 12));
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+  EXPECT_EQ(1, dm->GetNumRepairedPages());
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(1, dm->GetNumChecksumFailures());
+
+  // Scenario: once a full ring of other pages has been written since, the image is gone and the page cannot be
+  // repaired anymore.
+  std::vector<std::pair<page_id_t, const char *>> batch;
+  for (size_t i = 0; i < PAGE_IMAGE_LOG_CAPACITY; i++) {
+    batch.emplace_back(static_cast<page_id_t>(100 + i), old_data.data());
+  }
+  dm->WritePageBatch(batch);
+  OverwriteOnDisk(3, half, old_data.data() + half, half);
+  EXPECT_THROW(dm->ReadPage(3, buf), Exception);
+
+  // Scenario: the process dies in the middle of a write. The page is put back when the file is opened again, and the
+  // page image log is dropped.
+  dm->WritePage(4, new_data.data());
+  OverwriteOnDisk(4, half, old_data.data() + half, half);
+  auto *restarted = new DiskManager(db_file);
+  EXPECT_EQ(1, restarted->GetNumRepairedPages());
+  EXPECT_FALSE(std::filesystem::exists("test.fpi"));
+  restarted->SetChecksumMode(ChecksumMode::VERIFY);
+  restarted->ReadPage(4, buf);
+  EXPECT_EQ(0, std::memcmp(buf + 12, new_data.data() + 12, BUSTUB_PAGE_SIZE - 12));
+  restarted->ShutDown();
+  delete restarted;
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumBenchmark) {
+  const size_t num_pages = 2048;
+  const size_t num_rounds = 8;
+  std::vector<char> data(num_pages * BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 131 + i / BUSTUB_PAGE_SIZE);
+  }
+
+  // The checksum alone, over every page a few times.
+  for (bool hardware : {true, false}) {
+    if (hardware && !Crc32c::IsHardwareAccelerated()) {
+      continue;
+    }
+    uint32_t crc = 0;
+    auto clock_start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (size_t i = 0; i < num_pages; i++) {
+        const char *page = data.data() + i * BUSTUB_PAGE_SIZE;
+        crc += hardware ? Crc32c::Compute(page, BUSTUB_PAGE_SIZE) : Crc32c::ComputeSoftware(page, BUSTUB_PAGE_SIZE);
+      }
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+    std::cout << (hardware ? "crc32c sse4.2: " : "crc32c table: ")
+              << num_rounds * data.size() / seconds / (1024 * 1024 * 1024) << " GB/s, "
+              << seconds / (num_rounds * num_pages) * 1e9 << " ns per page (sum " << crc << ")" << std::endl;
+  }
+
+  // Write every page, then read every page, through a disk manager in each checksum mode.
+  for (auto checksum_mode : {ChecksumMode::NONE, ChecksumMode::VERIFY, ChecksumMode::REPAIR}) {
+    remove("test.db");
+    std::string db_file("test.db");
+    auto dm = DiskManager(db_file);
+    dm.SetChecksumMode(checksum_mode);
+    auto clock_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_pages; i++) {
+      dm.WritePage(static_cast<page_id_t>(i), data.data() + i * BUSTUB_PAGE_SIZE);
+    }
+    auto write_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+    char buf[BUSTUB_PAGE_SIZE];
+    clock_start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < num_rounds; round++) {
+      for (size_t i = 0; i < num_pages; i++) {
+        dm.ReadPage(static_cast<page_id_t>(i), buf);
+      }
+    }
+    auto read_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+    std::cout << ChecksumModeToString(checksum_mode) << ": " << num_pages / write_seconds << " page writes/s, "
+              << num_rounds * num_pages / read_seconds << " page reads/s" << std::endl;
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageSizeTest) {
+  EXPECT_TRUE(DiskManager::IsValidPageSize(BUSTUB_PAGE_SIZE));
+  EXPECT_TRUE(DiskManager::IsValidPageSize(BUSTUB_MAX_PAGE_SIZE));
+  EXPECT_FALSE(DiskManager::IsValidPageSize(BUSTUB_PAGE_SIZE / 2));
+  EXPECT_FALSE(DiskManager::IsValidPageSize(BUSTUB_PAGE_SIZE * 3));
+  EXPECT_FALSE(DiskManager::IsValidPageSize(BUSTUB_MAX_PAGE_SIZE * 2));
+  EXPECT_THROW(DiskManager("test.db", 12345), Exception);
+
+  // Scenario: with 16 KB pages, page i lives at offset (i + 1) * 16 KB of the file, after its header page.
+  const size_t page_size = 16 * 1024;
+  std::vector<char> buf(page_size);
+  std::vector<char> data(page_size, 'x');
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, page_size);
+  EXPECT_EQ(page_size, dm.GetPageSize());
+
+  dm.WritePage(2, data.data());
+  dm.ReadPage(2, buf.data());
+  EXPECT_EQ(buf, data);
+  dm.ShutDown();
+
+  FILE *file = fopen("test.db", "rb");
+  ASSERT_NE(nullptr, file);
+  fseek(file, 0, SEEK_END);
+  EXPECT_EQ(4 * page_size, static_cast<size_t>(ftell(file)));
+  fclose(file);
+
+  // Scenario: the file remembers its page size. Opening it with another one throws instead of reading the pages at
+  // the wrong offsets, and leaves the file as it was.
+  EXPECT_THROW(DiskManager(db_file, BUSTUB_PAGE_SIZE), Exception);
+  EXPECT_THROW(DiskManager(db_file, page_size * 2), Exception);
+  auto reopened = DiskManager(db_file, page_size);
+  std::fill(buf.begin(), buf.end(), 0);
+  reopened.ReadPage(2, buf.data());
+  EXPECT_EQ(buf, data);
+  EXPECT_EQ(3, reopened.GetNumPages());
+  reopened.ShutDown();
+
+  // Scenario: a file that is not a database file is refused.
+  {
+    std::ofstream out(db_file, std::ios::binary | std::ios::trunc);
+    out << std::string(page_size, 'x');
+  }
+  EXPECT_THROW(DiskManager(db_file, page_size), Exception);
+}
+
 }  // namespace bustub
@@ -0,0 +1,256 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map_test.cpp
+//
+// Identification: test/storage/free_page_map_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class FreePageMapTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("free_page_map_test.db");
+    remove("free_page_map_test.log");
+    remove("free_page_map_test.fpm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("free_page_map_test.db");
+    remove("free_page_map_test.log");
+    remove("free_page_map_test.fpm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, AllocateTest) {
+  FreePageMap map;
+  EXPECT_EQ(INVALID_PAGE_ID, map.Allocate(1, 0));
+  for (page_id_t page_id : {3, 8, 70, 71, 200, 8}) {
+    map.Deallocate(page_id);
+  }
+  EXPECT_EQ(5, map.GetNumFreePages());
+  EXPECT_EQ(201, map.GetEnd());
+  EXPECT_TRUE(map.IsFree(70));
+  EXPECT_FALSE(map.IsFree(69));
+
+  // Scenario: without a hint the lowest free page is taken, with one the closest.
+  EXPECT_EQ(3, map.Allocate(1, 0));
+  EXPECT_FALSE(map.IsFree(3));
+  EXPECT_EQ(71, map.Allocate(1, 0, 90));
+  EXPECT_EQ(200, map.Allocate(1, 0, 150));
+
+  // Scenario: an instance of a parallel buffer pool only takes the pages it owns.
+  EXPECT_EQ(INVALID_PAGE_ID, map.Allocate(4, 1));
+  EXPECT_EQ(70, map.Allocate(4, 2));
+  EXPECT_EQ(8, map.Allocate(4, 0, 100));
+  EXPECT_EQ(0, map.GetNumFreePages());
+  EXPECT_EQ(0, map.GetEnd());
+
+  // Scenario: the map survives a save and a load, and a truncated file is rejected.
+  map.Deallocate(5);
+  map.Deallocate(130);
+  EXPECT_EQ("free_page_map_test.fpm", FreePageMap::FileNameFor("free_page_map_test.db"));
+  ASSERT_TRUE(map.Save("free_page_map_test.fpm"));
+  FreePageMap loaded;
+  ASSERT_TRUE(loaded.Load("free_page_map_test.fpm"));
+  EXPECT_EQ(2, loaded.GetNumFreePages());
+  EXPECT_TRUE(loaded.IsFree(5));
+  EXPECT_TRUE(loaded.IsFree(130));
+  std::filesystem::resize_file("free_page_map_test.fpm", std::filesystem::file_size("free_page_map_test.fpm") - 1);
+  EXPECT_FALSE(loaded.Load("free_page_map_test.fpm"));
+  EXPECT_EQ(0, loaded.GetNumFreePages());
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, BoundedFileSizeTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t pages_per_round = 32;
+  const size_t num_rounds = 20;
+  const std::string db_file = "free_page_map_test.db";
+  auto *disk_manager = new DiskManager(db_file);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: build up and tear down an index's worth of pages over and over, the way the B+ tree delete tests do.
+  // Without page reuse the file would grow by a round's worth every time.
+  std::set<page_id_t> seen;
+  for (size_t round = 0; round < num_rounds; round++) {
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < pages_per_round; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "round %zu", round);
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+      seen.insert(page_id);
+    }
+    for (auto page_id : page_ids) {
+      EXPECT_TRUE(bpm->DeletePage(page_id));
+    }
+  }
+  EXPECT_EQ(pages_per_round, seen.size());
+  EXPECT_LE(std::filesystem::file_size(db_file), (pages_per_round + 1) * BUSTUB_PAGE_SIZE);
+  std::cout << "file size after " << num_rounds << " rounds of " << pages_per_round
+            << " pages: " << std::filesystem::file_size(db_file) / BUSTUB_PAGE_SIZE << " pages" << std::endl;
+
+  // Scenario: keep a few pages, then restart. The free pages are reused first, and new pages never land on a page
+  // still in use.
+  std::vector<page_id_t> kept;
+  for (size_t i = 0; i < 4; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "kept %d", page_id);
+    bpm->UnpinPage(page_id, true);
+    kept.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // The unused rest of the extent the pages were allocated from is free as well.
+  disk_manager = new DiskManager(db_file);
+  EXPECT_EQ(EXTENT_SIZE - kept.size(), disk_manager->GetNumFreePages());
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::set<page_id_t> reused;
+  for (size_t i = 0; i < pages_per_round; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    reused.insert(page_id);
+  }
+  for (auto page_id : kept) {
+    EXPECT_EQ(0, reused.count(page_id));
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("kept " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(EXTENT_SIZE - kept.size() - pages_per_round, disk_manager->GetNumFreePages());
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, ExtentRestartTest) {
+  const size_t buffer_pool_size = 8;
+  const std::string db_file = "free_page_map_test.db";
+  auto *disk_manager = new DiskManager(db_file);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetExtentSize(8);
+  auto new_page = [&bpm](page_id_t near_page_id) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id, AccessType::Unknown, near_page_id));
+    bpm->UnpinPage(page_id, true);
+    return page_id;
+  };
+
+  // Scenario: an object started in the shared extent [0, 8) grows in an extent of its own, [8, 16).
+  EXPECT_EQ(0, new_page(INVALID_PAGE_ID));
+  EXPECT_EQ(8, new_page(0));
+  EXPECT_EQ(9, new_page(8));
+  EXPECT_EQ(1, new_page(INVALID_PAGE_ID));
+
+  // Scenario: a deallocated page outside the object's extent is left alone, rather than taken and given back.
+  EXPECT_TRUE(bpm->DeletePage(1));
+  EXPECT_EQ(10, new_page(9));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: after a restart the unused pages of both extents are free, and the object keeps growing in its extent.
+  disk_manager = new DiskManager(db_file);
+  EXPECT_EQ(1 + 6 + 5, disk_manager->GetNumFreePages());
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetExtentSize(8);
+  EXPECT_EQ(11, new_page(10));
+  EXPECT_EQ(1, new_page(INVALID_PAGE_ID));
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreePageMapTest, CrashAfterReuseTest) {
+  const size_t buffer_pool_size = 8;
+  const std::string db_file = "free_page_map_test.db";
+  const std::string free_page_map_file = FreePageMap::FileNameFor(db_file);
+  auto *disk_manager = new DiskManager(db_file);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+  for (size_t i = 0; i < buffer_pool_size; i += 2) {
+    EXPECT_TRUE(bpm->DeletePage(page_ids[i]));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  ASSERT_TRUE(std::filesystem::exists(free_page_map_file));
+
+  // Scenario: the saved map is gone once loaded, so reusing a free page leaves nothing stale behind.
+  disk_manager = new DiskManager(db_file);
+  EXPECT_EQ(EXTENT_SIZE - buffer_pool_size / 2, disk_manager->GetNumFreePages());
+  EXPECT_FALSE(std::filesystem::exists(free_page_map_file));
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t reused_page_id;
+  auto *page = bpm->NewPage(&reused_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, reused_page_id % 2);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "reused");
+  bpm->UnpinPage(reused_page_id, true);
+  bpm->FlushAllPages();
+  delete bpm;
+  // Crash: no ShutDown, so the map is not saved again.
+  delete disk_manager;
+
+  // Scenario: after the crash the remaining free pages are leaked, and the reused page is not handed out again.
+  disk_manager = new DiskManager(db_file);
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_GE(page_id, static_cast<page_id_t>(buffer_pool_size));
+    bpm->UnpinPage(page_id, false);
+  }
+  page = bpm->FetchPage(reused_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("reused", std::string(page->GetData()));
+  bpm->UnpinPage(reused_page_id, false);
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto *page0 = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page0);
+
+  // Scenario: a guard holds its own pin and gives it back when dropped, exactly once.
+  auto guarded_page = bpm->FetchPageBasic(page_id);
+  EXPECT_EQ(page0->GetData(), guarded_page.GetData());
+  EXPECT_EQ(page_id, guarded_page.PageId());
+  EXPECT_EQ(2, page0->GetPinCount());
+  guarded_page.Drop();
+  EXPECT_EQ(1, page0->GetPinCount());
+  guarded_page.Drop();
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_FALSE(guarded_page.IsValid());
+
+  // Scenario: moving a guard moves the pin, it is not duplicated or lost.
+  {
+    auto guard1 = bpm->FetchPageBasic(page_id);
+    auto guard2 = std::move(guard1);
+    EXPECT_FALSE(guard1.IsValid());  // NOLINT
+    EXPECT_TRUE(guard2.IsValid());
+    EXPECT_EQ(2, page0->GetPinCount());
+    BasicPageGuard guard3;
+    guard3 = std::move(guard2);
+    EXPECT_EQ(2, page0->GetPinCount());
+  }
+  EXPECT_EQ(1, page0->GetPinCount());
+
+  // Scenario: only writes through the guard mark the page dirty.
+  bpm->UnpinPage(page_id, false);
+  bpm->FlushPage(page_id);
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_STREQ("", guard.GetData());
+  }
+  EXPECT_FALSE(page0->IsDirty());
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    std::strcpy(guard.GetDataMut(), "Hello");  // NOLINT
+  }
+  EXPECT_TRUE(page0->IsDirty());
+  EXPECT_EQ(0, page0->GetPinCount());
+
+  // Scenario: a failed fetch gives an empty guard, and dropping it is harmless.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t new_page_id;
+    guards.push_back(bpm->NewPageGuarded(&new_page_id));
+    ASSERT_TRUE(guards.back().IsValid());
+  }
+  auto failed_guard = bpm->FetchPageRead(page_id);
+  EXPECT_FALSE(failed_guard.IsValid());
+  guards.clear();
+  EXPECT_STREQ("Hello", bpm->FetchPageRead(page_id).GetData());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, LatchTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->UnpinPage(page_id, false);
+
+  // Scenario: readers share the latch, and a writer waits until every read guard is gone.
+  auto reader1 = bpm->FetchPageRead(page_id);
+  auto reader2 = bpm->FetchPageRead(page_id);
+  std::atomic<bool> written{false};
+  std::thread writer([&] {
+    auto guard = bpm->FetchPageWrite(page_id);
+    written = true;
+    guard.AsMut<int>()[0] = 42;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(written);
+  reader1.Drop();
+  reader2 = ReadPageGuard();
+  writer.join();
+  EXPECT_TRUE(written);
+  EXPECT_EQ(42, bpm->FetchPageRead(page_id).As<int>()[0]);
+
+  // Scenario: a basic guard upgrades to a latched guard without taking a second pin.
+  auto basic = bpm->FetchPageBasic(page_id);
+  auto write_guard = basic.UpgradeWrite();
+  EXPECT_FALSE(basic.IsValid());  // NOLINT
+  EXPECT_EQ(1, write_guard.GetPage()->GetPinCount());
+  write_guard.Drop();
+  EXPECT_EQ(0, bpm->GetPages()[0].GetPinCount());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/table/free_space_map_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, FindPageTest) {
+  const uint32_t page_size = 4096;
+  FreeSpaceMap map(page_size);
+  EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(1));
+  EXPECT_EQ(INVALID_PAGE_ID, map.GetLastPageId());
+
+  // Scenario: the first page with room is found, in the order the pages were added, not in page id order.
+  for (page_id_t page_id = 99; page_id >= 0; page_id--) {
+    map.AddPage(page_id, 100);
+  }
+  EXPECT_EQ(100, map.GetNumPages());
+  EXPECT_EQ(0, map.GetLastPageId());
+  map.Update(50, 2000);
+  map.Update(20, 1000);
+  EXPECT_EQ(99, map.FindPage(50));
+  EXPECT_EQ(50, map.FindPage(1500));
+  EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(2100));
+
+  // Scenario: free space is rounded down to a 256th of a page when stored, and up when looked for, so a page found
+  // always has the room asked for.
+  EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(2001));
+  EXPECT_EQ(50, map.FindPage(2000));
+  EXPECT_EQ(50, map.FindPage(990));
+
+  // Scenario: pages filled up or removed are no longer found, and unknown pages are ignored.
+  map.Update(50, 0);
+  map.Update(1000, 4000);
+  EXPECT_EQ(20, map.FindPage(900));
+  map.RemovePage(20);
+  EXPECT_EQ(INVALID_PAGE_ID, map.FindPage(900));
+  EXPECT_EQ(99, map.GetNumPages());
+  map.RemovePage(0);
+  EXPECT_EQ(1, map.GetLastPageId());
+  map.AddPage(500, page_size);
+  EXPECT_EQ(500, map.FindPage(3000));
+  EXPECT_EQ(500, map.GetLastPageId());
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, TableHeapTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+  size_t num_tuples = 0;
+  auto insert = [&](int i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))};
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(Tuple{values, &schema}, &rid, transaction));
+    num_tuples++;
+    return rid;
+  };
+  // Scenario: an insert fetches the page it goes to, rather than every page before it.
+  BufferPoolStats before;
+  bpm->GetStats(&before);
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    rids.push_back(insert(i));
+  }
+  BufferPoolStats after;
+  bpm->GetStats(&after);
+  EXPECT_LT(after.hits_ + after.misses_ - before.hits_ - before.misses_, 2 * rids.size());
+  auto last_page_id = rids.back().GetPageId();
+
+  // Scenario: the space freed in a page in the middle of the table is where the next inserts go.
+  auto page_id = rids[500].GetPageId();
+  for (auto &rid : rids) {
+    if (rid.GetPageId() == page_id) {
+      table->ApplyDelete(rid, transaction);
+      num_tuples--;
+    }
+  }
+  EXPECT_EQ(page_id, insert(2000).GetPageId());
+  EXPECT_EQ(page_id, insert(2001).GetPageId());
+
+  // Scenario: the table is opened again, and its map rebuilt from its pages. The page with room, appended last, is
+  // where the next insert goes.
+  int next_id = 3000;
+  page_id_t new_page_id;
+  do {
+    new_page_id = insert(next_id++).GetPageId();
+  } while (new_page_id == page_id || new_page_id == last_page_id);
+  auto first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(bpm, lock_manager, nullptr, first_page_id);
+  EXPECT_EQ(new_page_id, insert(next_id++).GetPageId());
+  size_t count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  delete table;
+
+  delete transaction;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, DISABLED_InsertBenchmark) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::BIGINT};
+  Column col3{"c", TypeId::VARCHAR, 32};
+  std::vector<Column> cols{col1, col2, col3};
+  Schema schema{cols};
+  const int num_tuples = 100000;
+  const int report_every = 20000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, transaction);
+
+  // Scenario: the cost of an insert does not grow with the table.
+  BufferPoolStats before;
+  bpm->GetStats(&before);
+  auto clock_start = std::chrono::steady_clock::now();
+  auto round_start = clock_start;
+  for (int i = 0; i < num_tuples; i++) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(int64_t{i} * 1000),
+                              ValueFactory::GetVarcharValue("row " + std::to_string(i))};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(Tuple{values, &schema}, &rid, transaction));
+    transaction->GetWriteSet()->clear();
+    if ((i + 1) % report_every == 0) {
+      auto now = std::chrono::steady_clock::now();
+      std::cout << "rows " << i + 1 - report_every << "-" << i + 1 << ": "
+                << std::chrono::duration<double, std::micro>(now - round_start).count() / report_every
+                << " us/row, page " << rid.GetPageId() << std::endl;
+      round_start = now;
+    }
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+  BufferPoolStats after;
+  bpm->GetStats(&after);
+  auto fetches = after.hits_ + after.misses_ - before.hits_ - before.misses_;
+  std::cout << num_tuples << " rows in " << seconds << " s, " << num_tuples / seconds << " rows/s, "
+            << static_cast<double>(fetches) / num_tuples << " fetches/row" << std::endl;
+  EXPECT_LT(fetches, 2 * num_tuples);
+
+  delete table;
+  delete transaction;
+  delete lock_manager;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
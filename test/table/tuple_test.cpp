@@ -11,16 +11,29 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/disk/disk_manager_direct.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +84,828 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, SeqScanReadAheadTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+
+  // Scenario: build a table much larger than the pool, then flush it all to disk.
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(16, disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))};
+    Tuple tuple{values, &schema};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+
+  // Scenario: a cold scan through a fresh pool sees every tuple in order and reads most pages ahead of itself.
+  buffer_pool_manager = new BufferPoolManagerInstance(16, disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, first_page_id);
+  int count = 0;
+  size_t num_pages = 1;
+  page_id_t last_page_id = first_page_id;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    EXPECT_EQ(count, itr->GetValue(&schema, 0).GetAs<int32_t>());
+    if (itr->GetRid().GetPageId() != last_page_id) {
+      last_page_id = itr->GetRid().GetPageId();
+      num_pages++;
+    }
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  EXPECT_GT(num_pages, TABLE_SCAN_READ_AHEAD);
+  EXPECT_GT(buffer_pool_manager->GetPrefetchedPages(), 0);
+
+  delete table;
+  delete buffer_pool_manager;
+  delete transaction;
+  delete lock_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, OptimisticReadTest) {
+  Column col1{"a", TypeId::BIGINT};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(16, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 64; ++i) {
+    Tuple tuple{{ValueFactory::GetBigIntValue(i), ValueFactory::GetBigIntValue(i)}, &schema};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rids.push_back(rid);
+  }
+
+  // Scenario: readers never see a tuple half way through an in-place update, both columns always match.
+  std::atomic<bool> done{false};
+  std::atomic<int> torn_reads{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; ++i) {
+    readers.emplace_back([&, i] {
+      auto *txn = new Transaction(i + 1);
+      Tuple tuple;
+      for (size_t n = 0; !done; n++) {
+        ASSERT_TRUE(table->GetTuple(rids[n % rids.size()], &tuple, txn));
+        if (tuple.GetValue(&schema, 0).GetAs<int64_t>() != tuple.GetValue(&schema, 1).GetAs<int64_t>()) {
+          torn_reads++;
+        }
+      }
+      delete txn;
+    });
+  }
+  auto *writer_txn = new Transaction(4);
+  for (int64_t v = 0; v < 20000; ++v) {
+    Tuple tuple{{ValueFactory::GetBigIntValue(v), ValueFactory::GetBigIntValue(v)}, &schema};
+    ASSERT_TRUE(table->UpdateTuple(tuple, rids[v % rids.size()], writer_txn));
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, torn_reads);
+
+  delete writer_txn;
+  delete table;
+  delete transaction;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, PageSizeTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  const int num_tuples = 2000;
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+
+  // Scenario: the same table is loaded with 4 KB and 16 KB pages, then scanned cold through a pool of a few frames.
+  // Every tuple is seen at both page sizes, and the larger pages hold the table in about a quarter as many pages.
+  std::vector<size_t> num_pages;
+  for (size_t page_size : {BUSTUB_PAGE_SIZE, 4 * BUSTUB_PAGE_SIZE}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory(page_size);
+    auto *buffer_pool_manager = new BufferPoolManagerInstance(64, disk_manager);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+    std::set<page_id_t> page_ids;
+    for (int i = 0; i < num_tuples; ++i) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+      RID rid;
+      ASSERT_TRUE(table->InsertTuple(Tuple{values, &schema}, &rid, transaction));
+      page_ids.insert(rid.GetPageId());
+    }
+    num_pages.push_back(page_ids.size());
+    page_id_t first_page_id = table->GetFirstPageId();
+    buffer_pool_manager->FlushAllPages();
+    delete table;
+    delete buffer_pool_manager;
+
+    buffer_pool_manager = new BufferPoolManagerInstance(4, disk_manager);
+    table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, first_page_id);
+    int count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      EXPECT_EQ(count, (*itr).GetValue(&schema, 0).GetAs<int32_t>());
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+    delete table;
+    delete buffer_pool_manager;
+    delete disk_manager;
+  }
+  EXPECT_LT(num_pages[1] * 3, num_pages[0]);
+  EXPECT_GT(LeafPage::MaxSizeFor(4 * BUSTUB_PAGE_SIZE), 3 * LeafPage::MaxSizeFor(BUSTUB_PAGE_SIZE));
+
+  delete transaction;
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_PageSizeBenchmark) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+  // The table is loaded through a pool that holds all of it, then every page size is scanned with the same 1 MB of
+  // buffer pool memory, a fraction of the table.
+  const size_t load_pool_bytes = 16 * 1024 * 1024;
+  const size_t scan_pool_bytes = 1024 * 1024;
+  const int num_tuples = 20000;
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+
+  for (size_t page_size : {4096, 8192, 16384, 32768}) {
+    remove("page_size_test.db");
+    auto *disk_manager = new DiskManager("page_size_test.db", page_size);
+    auto *buffer_pool_manager = new BufferPoolManagerInstance(load_pool_bytes / page_size, disk_manager);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+    for (int i = 0; i < num_tuples; ++i) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+      Tuple tuple{values, &schema};
+      RID rid;
+      ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    }
+    page_id_t first_page_id = table->GetFirstPageId();
+    buffer_pool_manager->FlushAllPages();
+    delete table;
+    delete buffer_pool_manager;
+
+    // Scenario: a cold scan sees every tuple at every page size.
+    buffer_pool_manager = new BufferPoolManagerInstance(scan_pool_bytes / page_size, disk_manager);
+    table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, first_page_id);
+    auto clock_start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      count++;
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_tuples, count);
+
+    // A 1B key index on 8 byte keys needs ceil(log_f(leaves)) internal levels above its leaves.
+    int leaf_fanout = LeafPage::MaxSizeFor(page_size);
+    int internal_fanout = InternalPage::MaxSizeFor(page_size);
+    double leaves = std::ceil(1e9 / leaf_fanout);
+    auto height = static_cast<int>(std::ceil(std::log(leaves) / std::log(internal_fanout))) + 1;
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+    std::cout << "page size " << page_size << ": scan " << static_cast<double>(num_tuples) / time_us << " tuples/us, "
+              << "leaf fanout " << leaf_fanout << ", internal fanout " << internal_fanout << ", height " << height
+              << std::endl;
+
+    delete table;
+    delete buffer_pool_manager;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  remove("page_size_test.db");
+  remove("page_size_test.log");
+  delete transaction;
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, ExtentTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_tuples = 500;
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+
+  // Scenario: tables loaded at once have their pages interleaved one by one without extents, and mostly consecutive
+  // with them, in a single buffer pool instance and in a parallel pool alike. The pages of an instance of a parallel
+  // pool are num_instances page ids apart, and each of its instances is shared by two tables.
+  for (size_t num_instances : {static_cast<size_t>(1), static_cast<size_t>(4)}) {
+    const size_t num_tables = std::max<size_t>(4, 2 * num_instances);
+    size_t jumps[2];
+    for (size_t extent_size : {static_cast<size_t>(1), EXTENT_SIZE}) {
+      auto *disk_manager = new DiskManagerUnlimitedMemory();
+      BufferPoolManager *buffer_pool_manager;
+      if (num_instances == 1) {
+        auto *instance = new BufferPoolManagerInstance(64, disk_manager);
+        instance->SetExtentSize(extent_size);
+        buffer_pool_manager = instance;
+      } else {
+        auto *parallel = new ParallelBufferPoolManager(num_instances, 16, disk_manager);
+        parallel->SetExtentSize(extent_size);
+        buffer_pool_manager = parallel;
+      }
+      std::vector<TableHeap *> tables;
+      for (size_t t = 0; t < num_tables; t++) {
+        tables.push_back(new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction));
+      }
+      // In a random order, so that the tables do not take turns in step with the instances creating their pages.
+      std::vector<size_t> order;
+      for (int i = 0; i < num_tuples * static_cast<int>(num_tables); ++i) {
+        order.push_back(i % num_tables);
+      }
+      std::shuffle(order.begin(), order.end(), std::mt19937(15445));
+      for (size_t i = 0; i < order.size(); ++i) {
+        std::vector<Value> values{ValueFactory::GetIntegerValue(static_cast<int>(i)),
+                                  ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+        RID rid;
+        ASSERT_TRUE(tables[order[i]]->InsertTuple(Tuple{values, &schema}, &rid, transaction));
+      }
+      int count = 0;
+      size_t num_jumps = 0;
+      const auto stride = static_cast<page_id_t>(num_instances);
+      page_id_t last_page_id = tables[0]->GetFirstPageId();
+      for (auto itr = tables[0]->Begin(transaction); itr != tables[0]->End(); ++itr) {
+        auto page_id = itr->GetRid().GetPageId();
+        num_jumps += page_id != last_page_id && page_id != last_page_id + stride ? 1 : 0;
+        last_page_id = page_id;
+        count++;
+      }
+      EXPECT_EQ(num_tuples, count);
+      jumps[extent_size == 1 ? 0 : 1] = num_jumps;
+      for (auto *table : tables) {
+        delete table;
+      }
+      delete buffer_pool_manager;
+      delete disk_manager;
+    }
+    EXPECT_LT(jumps[1] * 10, jumps[0]) << num_instances << " instances";
+  }
+
+  delete transaction;
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_ExtentBenchmark) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 200};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const size_t num_tables = 4;
+  const int num_tuples = 2000;
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+
+  // Load several tables at once, a tuple to each in turn, then scan one of them cold with direct I/O so every page
+  // comes from the disk rather than the OS page cache.
+  size_t seeks[2];
+  for (size_t extent_size : {static_cast<size_t>(1), EXTENT_SIZE}) {
+    remove("extent_test.db");
+    auto *disk_manager = new DiskManager("extent_test.db");
+    auto *buffer_pool_manager = new BufferPoolManagerInstance(1024, disk_manager);
+    buffer_pool_manager->SetExtentSize(extent_size);
+    std::vector<TableHeap *> tables;
+    for (size_t t = 0; t < num_tables; t++) {
+      tables.push_back(new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction));
+    }
+    for (int i = 0; i < num_tuples * static_cast<int>(num_tables); ++i) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(200, 'x'))};
+      Tuple tuple{values, &schema};
+      RID rid;
+      ASSERT_TRUE(tables[i % num_tables]->InsertTuple(tuple, &rid, transaction));
+    }
+    page_id_t first_page_id = tables[0]->GetFirstPageId();
+    buffer_pool_manager->FlushAllPages();
+    for (auto *table : tables) {
+      delete table;
+    }
+    delete buffer_pool_manager;
+    disk_manager->ShutDown();
+    delete disk_manager;
+
+    // Scenario: the scan sees every tuple of its table, and with extents its pages are mostly consecutive on disk.
+    auto *direct_disk_manager = new DiskManagerDirect("extent_test.db");
+    buffer_pool_manager = new BufferPoolManagerInstance(16, direct_disk_manager);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, first_page_id);
+    auto clock_start = std::chrono::steady_clock::now();
+    int count = 0;
+    size_t num_pages = 1;
+    size_t num_seeks = 0;
+    page_id_t last_page_id = first_page_id;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      if (itr->GetRid().GetPageId() != last_page_id) {
+        num_seeks += itr->GetRid().GetPageId() != last_page_id + 1 ? 1 : 0;
+        last_page_id = itr->GetRid().GetPageId();
+        num_pages++;
+      }
+      count++;
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_tuples, count);
+    seeks[extent_size == 1 ? 0 : 1] = num_seeks;
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(clock_end - clock_start).count();
+    std::cout << "extent size " << extent_size << ": " << num_pages << " pages, " << num_seeks << " seeks, scan "
+              << static_cast<double>(num_pages) * 1e6 / static_cast<double>(std::max<int64_t>(time_us, 1))
+              << " pages/s" << std::endl;
+
+    delete table;
+    delete buffer_pool_manager;
+    direct_disk_manager->ShutDown();
+    delete direct_disk_manager;
+  }
+  EXPECT_LT(seeks[1] * 10, seeks[0]);
+
+  remove("extent_test.db");
+  remove("extent_test.log");
+  delete transaction;
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, PageCompactionTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 400};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  auto make_tuple = [&schema](int i, size_t length) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(length, 'x'))};
+    return Tuple{values, &schema};
+  };
+  auto *transaction = new Transaction(0);
+  Page page;
+  auto *table_page = reinterpret_cast<TablePage *>(&page);
+  table_page->Init(0, BUSTUB_PAGE_SIZE, INVALID_PAGE_ID, nullptr, transaction);
+
+  // Fill the page with tuples of 100 byte strings.
+  std::vector<RID> rids;
+  RID rid;
+  for (int i = 0; table_page->InsertTuple(make_tuple(i, 100), &rid, transaction, nullptr, nullptr); i++) {
+    EXPECT_EQ(i, rid.GetSlotNum());
+    rids.push_back(rid);
+  }
+  ASSERT_GT(rids.size(), 10);
+  EXPECT_EQ(0, table_page->GetFragmentedSpace());
+
+  // Scenario: deleting tuples in the middle of the page leaves holes, and their slots, rather than moving the others.
+  auto tuple_size = make_tuple(0, 100).GetLength();
+  for (size_t i = 1; i < 8; i += 2) {
+    ASSERT_TRUE(table_page->MarkDelete(rids[i], transaction, nullptr, nullptr));
+    table_page->ApplyDelete(rids[i], transaction, nullptr);
+  }
+  EXPECT_EQ(4 * tuple_size, table_page->GetFragmentedSpace());
+  EXPECT_EQ(rids.size(), table_page->GetTupleCount());
+
+  // Scenario: a tuple that only fits in the holes is inserted in the first empty slot, once the page is compacted.
+  ASSERT_TRUE(table_page->InsertTuple(make_tuple(1000, 300), &rid, transaction, nullptr, nullptr));
+  EXPECT_EQ(1, rid.GetSlotNum());
+  EXPECT_EQ(0, table_page->GetFragmentedSpace());
+  EXPECT_FALSE(table_page->Compact());
+
+  // Scenario: the tuples that were moved keep their rids and their values.
+  for (size_t i = 0; i < rids.size(); i++) {
+    Tuple tuple;
+    if (i == 3 || i == 5 || i == 7) {
+      EXPECT_FALSE(table_page->GetTuple(rids[i], &tuple, transaction, nullptr));
+      continue;
+    }
+    ASSERT_TRUE(table_page->GetTuple(rids[i], &tuple, transaction, nullptr));
+    EXPECT_EQ(i == 1 ? 1000 : static_cast<int>(i), tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(i == 1 ? 300 : 100, tuple.GetValue(&schema, 1).ToString().size());
+  }
+
+  // Scenario: an update that only fits in the holes compacts the page too, and a marked-deleted tuple survives it.
+  for (size_t i = 9; i < 12; i += 2) {
+    table_page->ApplyDelete(rids[i], transaction, nullptr);
+  }
+  EXPECT_EQ(2 * tuple_size, table_page->GetFragmentedSpace());
+  ASSERT_TRUE(table_page->MarkDelete(rids[0], transaction, nullptr, nullptr));
+  Tuple old_tuple;
+  ASSERT_TRUE(table_page->UpdateTuple(make_tuple(2000, 400), &old_tuple, rids[2], transaction, nullptr, nullptr));
+  EXPECT_EQ(0, table_page->GetFragmentedSpace());
+  table_page->RollbackDelete(rids[0], transaction, nullptr);
+  Tuple tuple;
+  ASSERT_TRUE(table_page->GetTuple(rids[0], &tuple, transaction, nullptr));
+  EXPECT_EQ(0, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  ASSERT_TRUE(table_page->GetTuple(rids[2], &tuple, transaction, nullptr));
+  EXPECT_EQ(2000, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+
+  // Scenario: deleting the tuples at the end of the slot array gives their slots back.
+  for (size_t i = rids.size() - 3; i < rids.size(); i++) {
+    table_page->ApplyDelete(rids[i], transaction, nullptr);
+  }
+  EXPECT_EQ(rids.size() - 3, table_page->GetTupleCount());
+  ASSERT_TRUE(table_page->InsertTuple(make_tuple(3000, 100), &rid, transaction, nullptr, nullptr));
+  EXPECT_EQ(3, rid.GetSlotNum());
+
+  // Scenario: once every tuple is deleted, the page has no slots left and all of its space is free.
+  for (size_t i = 0; i < rids.size() - 3; i++) {
+    if (i == 5 || i == 7 || i == 9 || i == 11) {
+      continue;
+    }
+    table_page->ApplyDelete(rids[i], transaction, nullptr);
+  }
+  EXPECT_EQ(0, table_page->GetTupleCount());
+  EXPECT_EQ(0, table_page->GetFragmentedSpace());
+  EXPECT_FALSE(table_page->GetFirstTupleRid(&rid));
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, ChurnTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 300};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_live = 1000;
+  const int num_churn = 200;
+  const int num_rounds = 5;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(256, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+  auto count_pages = [&] {
+    size_t num_pages = 0;
+    for (auto page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      page_id = buffer_pool_manager->FetchPageRead(page_id).GetPage<TablePage>()->GetNextPageId();
+    }
+    return num_pages;
+  };
+  auto count_tuples = [&] {
+    size_t count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      count++;
+    }
+    return count;
+  };
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<size_t> length(20, 300);
+  std::vector<RID> live;
+  auto insert = [&](int i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(length(rng), 'x'))};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(Tuple{values, &schema}, &rid, transaction));
+    live.push_back(rid);
+  };
+  for (int i = 0; i < num_live; i++) {
+    insert(i);
+  }
+  transaction->GetWriteSet()->clear();
+  auto initial_pages = count_pages();
+
+  // Scenario: deleting and inserting the same number of tuples of random sizes round after round keeps the table the
+  // same size.
+  int next_id = num_live;
+  for (int round = 0; round < num_rounds; round++) {
+    for (int i = 0; i < num_churn; i++) {
+      auto index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+      ASSERT_TRUE(table->MarkDelete(live[index], transaction));
+      table->ApplyDelete(live[index], transaction);
+      live[index] = live.back();
+      live.pop_back();
+    }
+    for (int i = 0; i < num_churn; i++) {
+      insert(next_id++);
+    }
+    transaction->GetWriteSet()->clear();
+  }
+  EXPECT_LE(count_pages(), initial_pages * 11 / 10);
+  EXPECT_EQ(live.size(), count_tuples());
+
+  // Scenario: after all but the first tenth of the table is deleted, vacuum frees the pages left empty, the rest still
+  // scans, and the table takes inserts again.
+  std::sort(live.begin(), live.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+  live.erase(live.begin() + live.size() / 10, live.end());
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    if (!std::binary_search(live.begin(), live.end(), itr->GetRid(),
+                            [](const RID &a, const RID &b) { return a.Get() < b.Get(); })) {
+      ASSERT_TRUE(table->MarkDelete(itr->GetRid(), transaction));
+    }
+  }
+  for (auto &record : *transaction->GetWriteSet()) {
+    table->ApplyDelete(record.rid_, transaction);
+  }
+  transaction->GetWriteSet()->clear();
+  auto before_vacuum = count_pages();
+  auto num_deleted = table->Vacuum(transaction);
+  EXPECT_GT(num_deleted, 0);
+  EXPECT_EQ(before_vacuum - num_deleted, count_pages());
+  EXPECT_EQ(live.size(), count_tuples());
+  for (int i = 0; i < num_churn; i++) {
+    insert(next_id++);
+  }
+  EXPECT_EQ(live.size(), count_tuples());
+
+  delete table;
+  delete transaction;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_ChurnBenchmark) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 300};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_live = 5000;
+  const int num_churn = 1000;
+  const int num_rounds = 10;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(4096, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *transaction = new Transaction(0);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+  auto count_pages = [&] {
+    size_t num_pages = 0;
+    for (auto page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      page_id = buffer_pool_manager->FetchPageRead(page_id).GetPage<TablePage>()->GetNextPageId();
+    }
+    return num_pages;
+  };
+
+  // Tuples of random sizes, so that a hole left by a delete rarely fits the next insert as it is.
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<size_t> length(20, 300);
+  std::vector<RID> live;
+  auto insert = [&](int i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(length(rng), 'x'))};
+    Tuple tuple{values, &schema};
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    live.push_back(rid);
+  };
+  auto remove_random = [&] {
+    auto index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+    ASSERT_TRUE(table->MarkDelete(live[index], transaction));
+    table->ApplyDelete(live[index], transaction);
+    live[index] = live.back();
+    live.pop_back();
+  };
+  for (int i = 0; i < num_live; i++) {
+    insert(i);
+  }
+  transaction->GetWriteSet()->clear();
+  auto initial_pages = count_pages();
+
+  // Scenario: deleting and inserting the same number of tuples round after round keeps the table the same size.
+  std::cout << "initial: " << initial_pages << " pages" << std::endl;
+  int next_id = num_live;
+  size_t num_pages = initial_pages;
+  for (int round = 0; round < num_rounds; round++) {
+    auto clock_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_churn; i++) {
+      remove_random();
+    }
+    auto clock_mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_churn; i++) {
+      insert(next_id++);
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    transaction->GetWriteSet()->clear();
+    num_pages = count_pages();
+    std::cout << "round " << round << ": " << num_pages << " pages, delete "
+              << std::chrono::duration<double, std::micro>(clock_mid - clock_start).count() / num_churn
+              << " us/tuple, insert "
+              << std::chrono::duration<double, std::micro>(clock_end - clock_mid).count() / num_churn << " us/tuple"
+              << std::endl;
+  }
+  EXPECT_LE(num_pages, initial_pages * 11 / 10);
+
+  // Scenario: after all but the first tenth of the table is deleted, vacuum frees the pages left empty and the rest
+  // still scans.
+  std::sort(live.begin(), live.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+  live.erase(live.begin() + live.size() / 10, live.end());
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    if (!std::binary_search(live.begin(), live.end(), itr->GetRid(),
+                            [](const RID &a, const RID &b) { return a.Get() < b.Get(); })) {
+      ASSERT_TRUE(table->MarkDelete(itr->GetRid(), transaction));
+    }
+  }
+  for (auto &record : *transaction->GetWriteSet()) {
+    table->ApplyDelete(record.rid_, transaction);
+  }
+  transaction->GetWriteSet()->clear();
+  auto before_vacuum = count_pages();
+  auto clock_start = std::chrono::steady_clock::now();
+  auto num_deleted = table->Vacuum(transaction);
+  auto clock_end = std::chrono::steady_clock::now();
+  auto after_vacuum = count_pages();
+  std::cout << "vacuum after deleting all but the first 10%: " << before_vacuum << " -> " << after_vacuum
+            << " pages in "
+            << std::chrono::duration<double, std::milli>(clock_end - clock_start).count() << " ms" << std::endl;
+  EXPECT_EQ(before_vacuum - num_deleted, after_vacuum);
+  EXPECT_GT(num_deleted, 0);
+  size_t count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(live.size(), count);
+
+  // Scenario: the table takes inserts again once vacuumed.
+  for (int i = 0; i < num_churn; i++) {
+    insert(next_id++);
+  }
+  count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(live.size(), count);
+
+  delete table;
+  delete transaction;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, BulkInsertTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"terrier", TypeId::INTEGER};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_tuples = 3000;
+  auto *lock_manager = new LockManager();
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_tuples; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)},
+                        &schema);
+  }
+
+  std::vector<RID> expected;
+  for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(128), static_cast<size_t>(num_tuples)}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *buffer_pool_manager = new BufferPoolManagerInstance(64, disk_manager);
+    auto *transaction = new Transaction(0);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+    BufferPoolStats before;
+    buffer_pool_manager->GetStats(&before);
+    std::vector<RID> rids;
+    for (size_t begin = 0; begin < tuples.size(); begin += batch_size) {
+      std::vector<Tuple> batch(tuples.begin() + begin, tuples.begin() + std::min(begin + batch_size, tuples.size()));
+      if (batch_size == 1) {
+        RID rid;
+        ASSERT_TRUE(table->InsertTuple(batch[0], &rid, transaction));
+        rids.push_back(rid);
+      } else {
+        ASSERT_TRUE(table->InsertTuples(batch, &rids, transaction));
+      }
+    }
+    BufferPoolStats after;
+    buffer_pool_manager->GetStats(&after);
+    auto fetches = after.hits_ + after.misses_ - before.hits_ - before.misses_;
+
+    // Scenario: every batch size lays the table out the same, with one write record per row, and batches fetch each
+    // page about once rather than once per row.
+    ASSERT_EQ(tuples.size(), rids.size());
+    if (expected.empty()) {
+      expected = rids;
+    } else {
+      EXPECT_EQ(expected, rids);
+      EXPECT_GT(static_cast<uint64_t>(num_tuples / 10), fetches);
+    }
+    EXPECT_EQ(tuples.size(), transaction->GetWriteSet()->size());
+    int count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      EXPECT_EQ(count, itr->GetValue(&schema, 0).GetAs<int32_t>());
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+
+    // Scenario: a batch with a tuple too large for a page inserts nothing and aborts the transaction.
+    std::vector<Column> wide_cols{Column{"wide", TypeId::VARCHAR, BUSTUB_PAGE_SIZE}};
+    Schema wide_schema{wide_cols};
+    std::vector<Tuple> batch{tuples[0], Tuple{{ValueFactory::GetVarcharValue(std::string(BUSTUB_PAGE_SIZE, 'x'))},
+                                              &wide_schema}};
+    std::vector<RID> none;
+    EXPECT_FALSE(table->InsertTuples(batch, &none, transaction));
+    EXPECT_TRUE(none.empty());
+    EXPECT_EQ(TransactionState::ABORTED, transaction->GetState());
+
+    delete table;
+    delete transaction;
+    delete buffer_pool_manager;
+    delete disk_manager;
+  }
+  delete lock_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_BulkLoadBenchmark) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"terrier", TypeId::INTEGER};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_tuples = 30000;
+  auto *lock_manager = new LockManager();
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_tuples; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)},
+                        &schema);
+  }
+
+  // Load the rows of a large INSERT ... VALUES one by one, then in batches of the size TableGenerator uses, then all
+  // at once.
+  std::vector<RID> expected;
+  for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(128), static_cast<size_t>(num_tuples)}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *buffer_pool_manager = new BufferPoolManagerInstance(1024, disk_manager);
+    auto *transaction = new Transaction(0);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+    BufferPoolStats before;
+    buffer_pool_manager->GetStats(&before);
+    std::vector<std::vector<Tuple>> batches;
+    for (size_t begin = 0; begin < tuples.size(); begin += batch_size) {
+      batches.emplace_back(tuples.begin() + begin, tuples.begin() + std::min(begin + batch_size, tuples.size()));
+    }
+    std::vector<RID> rids;
+    auto clock_start = std::chrono::steady_clock::now();
+    for (const auto &batch : batches) {
+      if (batch_size == 1) {
+        RID rid;
+        ASSERT_TRUE(table->InsertTuple(batch[0], &rid, transaction));
+        rids.push_back(rid);
+      } else {
+        ASSERT_TRUE(table->InsertTuples(batch, &rids, transaction));
+      }
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    BufferPoolStats after;
+    buffer_pool_manager->GetStats(&after);
+    auto fetches = after.hits_ + after.misses_ - before.hits_ - before.misses_;
+    auto time_us = std::chrono::duration<double, std::micro>(clock_end - clock_start).count();
+    std::cout << "batch size " << batch_size << ": " << time_us / 1000 << " ms, " << num_tuples * 1e6 / time_us
+              << " rows/s, " << fetches << " fetches" << std::endl;
+
+    // Scenario: every batch size lays the table out the same, with one write record per row.
+    ASSERT_EQ(tuples.size(), rids.size());
+    if (expected.empty()) {
+      expected = rids;
+    } else {
+      EXPECT_EQ(expected, rids);
+      EXPECT_GT(static_cast<uint64_t>(num_tuples / 10), fetches);
+    }
+    EXPECT_EQ(tuples.size(), transaction->GetWriteSet()->size());
+    int count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      EXPECT_EQ(count, itr->GetValue(&schema, 0).GetAs<int32_t>());
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+
+    // Scenario: a batch with a tuple too large for a page inserts nothing and aborts the transaction.
+    std::vector<Column> wide_cols{Column{"wide", TypeId::VARCHAR, BUSTUB_PAGE_SIZE}};
+    Schema wide_schema{wide_cols};
+    std::vector<Tuple> batch{tuples[0], Tuple{{ValueFactory::GetVarcharValue(std::string(BUSTUB_PAGE_SIZE, 'x'))},
+                                              &wide_schema}};
+    std::vector<RID> none;
+    EXPECT_FALSE(table->InsertTuples(batch, &none, transaction));
+    EXPECT_TRUE(none.empty());
+    EXPECT_EQ(TransactionState::ABORTED, transaction->GetState());
+
+    delete table;
+    delete transaction;
+    delete buffer_pool_manager;
+    delete disk_manager;
+  }
+  delete lock_manager;
+}
+
 }  // namespace bustub
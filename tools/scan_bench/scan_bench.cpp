@@ -0,0 +1,190 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_manager_mmap.h"
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/page/table_page.h"
+#include "type/value_factory.h"
+
+/**
+ * Scans a table of several GB through the regular buffer pool, which copies every page into a frame and evicts it
+ * again, and through the read only mmap mode, which hands out views of the mapped file, and reports the throughput of
+ * each. Every mode is scanned once cold, with the file dropped from the OS page cache, then warm.
+ *
+ * The table is generated, as full table pages chained like the pages of a TableHeap, unless the database file already
+ * has the size asked for.
+ */
+
+namespace {
+
+using bustub::BUSTUB_PAGE_SIZE;
+using bustub::page_id_t;
+
+/** Pages written to the database file at a time while generating it. */
+constexpr size_t GENERATE_BATCH_PAGES = 256;
+
+auto MakeSchema() -> bustub::Schema {
+  return bustub::Schema({bustub::Column("id", bustub::TypeId::INTEGER),
+                         bustub::Column("amount", bustub::TypeId::BIGINT),
+                         bustub::Column("note", bustub::TypeId::VARCHAR, 32)});
+}
+
+/** Write num_pages table pages, full of tuples, to db_file. */
+void Generate(const std::string &db_file, size_t num_pages, const bustub::Schema &schema) {
+  // building a tuple costs more than inserting it, so a few are built and inserted over and over
+  std::vector<bustub::Tuple> tuples;
+  for (int i = 0; i < 1024; i++) {
+    tuples.emplace_back(std::vector<bustub::Value>{bustub::ValueFactory::GetIntegerValue(i),
+                                                   bustub::ValueFactory::GetBigIntValue(int64_t{i} * 1000),
+                                                   bustub::ValueFactory::GetVarcharValue(fmt::format("note {}", i))},
+                        &schema);
+  }
+  bustub::DiskManager disk_manager(db_file);
+  bustub::Page page;
+  auto *table_page = reinterpret_cast<bustub::TablePage *>(&page);
+  std::vector<char> batch(GENERATE_BATCH_PAGES * BUSTUB_PAGE_SIZE);
+  size_t next_tuple = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    memset(page.GetData(), 0, BUSTUB_PAGE_SIZE);
+    table_page->Init(page_id, BUSTUB_PAGE_SIZE, i == 0 ? bustub::INVALID_PAGE_ID : page_id - 1, nullptr, nullptr);
+    table_page->SetNextPageId(i + 1 < num_pages ? page_id + 1 : bustub::INVALID_PAGE_ID);
+    bustub::RID rid;
+    while (table_page->InsertTuple(tuples[next_tuple % tuples.size()], &rid, nullptr, nullptr, nullptr)) {
+      next_tuple++;
+    }
+    auto slot = i % GENERATE_BATCH_PAGES;
+    memcpy(batch.data() + slot * BUSTUB_PAGE_SIZE, page.GetData(), BUSTUB_PAGE_SIZE);
+    if (slot + 1 == GENERATE_BATCH_PAGES || i + 1 == num_pages) {
+      disk_manager.WritePages(static_cast<page_id_t>(i - slot), batch.data(), slot + 1);
+    }
+  }
+  disk_manager.ShutDown();
+  std::remove((db_file.substr(0, db_file.rfind('.')) + ".log").c_str());
+}
+
+/** Drop the pages of a file from the OS page cache, so that the next scan reads it from the device. */
+void DropFromPageCache(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+/** @return the number of tuples in the first num_pages pages, and the sum of their ids */
+auto Scan(bustub::BufferPoolManager *bpm, size_t num_pages, const bustub::Schema &schema)
+    -> std::pair<size_t, int64_t> {
+  size_t num_tuples = 0;
+  int64_t sum = 0;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto page_id = static_cast<page_id_t>(i);
+    auto *page = bpm->FetchPage(page_id, bustub::AccessType::Scan);
+    if (page == nullptr) {
+      throw bustub::Exception(fmt::format("cannot fetch page {}", page_id));
+    }
+    page->RLatch();
+    auto *table_page = reinterpret_cast<bustub::TablePage *>(page);
+    bustub::RID rid;
+    for (bool found = table_page->GetFirstTupleRid(&rid); found; found = table_page->GetNextTupleRid(rid, &rid)) {
+      bustub::Tuple tuple;
+      table_page->GetTuple(rid, &tuple, nullptr, nullptr);
+      sum += tuple.GetValue(&schema, 0).GetAs<int32_t>();
+      num_tuples++;
+    }
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+  }
+  return {num_tuples, sum};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-scan-bench");
+  program.add_argument("--db").help("database file to scan, generated if it does not have the size asked for")
+      .default_value(std::string("scan_bench.db"));
+  program.add_argument("--size-mb").help("size of the table in MB").default_value(std::string("2048"));
+  program.add_argument("--pool-size").help("frames in the regular buffer pool").default_value(std::string("1024"));
+  program.add_argument("--passes").help("warm scans of each mode").default_value(std::string("3"));
+  program.add_argument("--keep").help("keep the database file for the next run").default_value(false).implicit_value(
+      true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get("--db");
+  auto num_pages = std::stoul(program.get("--size-mb")) * 1024 * 1024 / BUSTUB_PAGE_SIZE;
+  auto pool_size = std::stoul(program.get("--pool-size"));
+  auto num_passes = std::stoul(program.get("--passes"));
+  auto schema = MakeSchema();
+  std::error_code error;
+  // the pages and the header page of the file
+  if (std::filesystem::file_size(db_file, error) != (num_pages + 1) * BUSTUB_PAGE_SIZE) {
+    std::cerr << "generating " << num_pages << " pages in " << db_file << std::endl;
+    std::remove(db_file.c_str());
+    Generate(db_file, num_pages, schema);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("pages={} size_mb={} pool_size={}\n", num_pages, num_pages * BUSTUB_PAGE_SIZE / (1024 * 1024), pool_size);
+  std::pair<size_t, int64_t> expected{0, 0};
+  for (bool use_mmap : {false, true}) {
+    for (size_t pass = 0; pass <= num_passes; pass++) {
+      if (pass == 0) {
+        DropFromPageCache(db_file);
+      }
+      // a new buffer pool every pass, so that the regular one starts empty like the cold OS page cache
+      auto clock_start = std::chrono::steady_clock::now();
+      std::pair<size_t, int64_t> result;
+      if (use_mmap) {
+        bustub::DiskManagerMmap disk_manager(db_file);
+        bustub::BufferPoolManagerMmap bpm(&disk_manager);
+        result = Scan(&bpm, num_pages, schema);
+      } else {
+        bustub::DiskManager disk_manager(db_file);
+        bustub::BufferPoolManagerInstance bpm(pool_size, &disk_manager);
+        result = Scan(&bpm, num_pages, schema);
+        disk_manager.ShutDown();
+      }
+      auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+      if (expected.first == 0) {
+        expected = result;
+      } else if (result != expected) {
+        throw bustub::Exception("scans disagree on the contents of the table");
+      }
+      fmt::print("mode={:<11} pass={:<5} tuples={} seconds={:.3f} mb_per_s={:.1f} tuples_per_s={:.0f}\n",
+                 use_mmap ? "mmap" : "buffer_pool", pass == 0 ? "cold" : std::to_string(pass), result.first, seconds,
+                 static_cast<double>(num_pages * BUSTUB_PAGE_SIZE) / (1024 * 1024) / seconds,
+                 static_cast<double>(result.first) / seconds);
+    }
+  }
+  fmt::print(">>> END\n");
+  if (!program.get<bool>("--keep")) {
+    std::remove(db_file.c_str());
+  }
+  std::remove((db_file.substr(0, db_file.rfind('.')) + ".log").c_str());
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_replacer.h"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_simulated.h"
+
+/**
+ * Replays a page access trace against a buffer pool once per replacement policy and reports the hit ratio of each.
+ *
+ * A trace file has one access per line: a page id, optionally followed by the access type, one of U (unknown,
+ * the default), L (lookup), S (scan) or I (index). Empty lines and lines starting with '#' are ignored. Without a
+ * trace file, a synthetic trace mixing zipfian point lookups with full scans is replayed instead.
+ *
+ * With a simulated device, the time the device would take over the misses is reported too.
+ */
+
+namespace {
+
+using bustub::AccessType;
+using bustub::page_id_t;
+
+using Trace = std::vector<std::pair<page_id_t, AccessType>>;
+
+auto ParseAccessType(const std::string &str) -> AccessType {
+  if (str.empty() || str == "U") {
+    return AccessType::Unknown;
+  }
+  if (str == "L") {
+    return AccessType::Lookup;
+  }
+  if (str == "S") {
+    return AccessType::Scan;
+  }
+  if (str == "I") {
+    return AccessType::Index;
+  }
+  throw bustub::Exception(fmt::format("unexpected access type: {}", str));
+}
+
+auto LoadTrace(const std::string &path) -> Trace {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    throw bustub::Exception(fmt::format("cannot open trace: {}", path));
+  }
+  Trace trace;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    page_id_t page_id;
+    std::string access_type;
+    fields >> page_id >> access_type;
+    trace.emplace_back(page_id, ParseAccessType(access_type));
+  }
+  return trace;
+}
+
+/** Zipfian lookups over num_hot_pages pages, with a full scan of num_scan_pages pages every scan_interval lookups. */
+auto SyntheticTrace(size_t length, size_t num_hot_pages, size_t num_scan_pages, size_t scan_interval,
+                    uint64_t seed) -> Trace {
+  std::vector<double> weights(num_hot_pages);
+  for (size_t i = 0; i < num_hot_pages; i++) {
+    weights[i] = 1.0 / static_cast<double>(i + 1);
+  }
+  std::mt19937_64 rng(seed);
+  std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+  Trace trace;
+  trace.reserve(length);
+  while (trace.size() < length) {
+    for (size_t i = 0; i < scan_interval && trace.size() < length; i++) {
+      trace.emplace_back(static_cast<page_id_t>(zipf(rng)), AccessType::Lookup);
+    }
+    for (size_t i = 0; i < num_scan_pages && trace.size() < length; i++) {
+      trace.emplace_back(static_cast<page_id_t>(num_hot_pages + i), AccessType::Scan);
+    }
+  }
+  return trace;
+}
+
+/**
+ * @return the number of accesses in the trace that missed the buffer pool, and the time the device spent reading and
+ * writing for them
+ */
+auto Replay(const Trace &trace, page_id_t max_page_id, size_t pool_size, bustub::ReplacerPolicy policy,
+            bool use_hints, const bustub::DeviceProfile &device) -> std::pair<size_t, std::chrono::nanoseconds> {
+  // the virtual clock, so that the device time of every policy is the same on every run
+  bustub::DiskManagerSimulated disk_manager(device, true);
+  {
+    // Materialize every page the trace touches, so that misses read real pages.
+    bustub::BufferPoolManagerInstance loader(1, &disk_manager);
+    page_id_t page_id;
+    do {
+      loader.NewPage(&page_id);
+      loader.UnpinPage(page_id, true);
+    } while (page_id < max_page_id);
+    loader.FlushAllPages();
+  }
+
+  bustub::BufferPoolManagerInstance bpm(pool_size, &disk_manager, bustub::LRUK_REPLACER_K, nullptr, policy);
+  auto num_reads = disk_manager.GetNumReads();
+  auto device_time = disk_manager.GetDeviceTime();
+  for (const auto &[page_id, access_type] : trace) {
+    if (bpm.FetchPage(page_id, use_hints ? access_type : AccessType::Unknown) == nullptr) {
+      throw bustub::Exception("buffer pool is full of pinned pages");
+    }
+    bpm.UnpinPage(page_id, false);
+  }
+  return {disk_manager.GetNumReads() - num_reads, disk_manager.GetDeviceTime() - device_time};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-trace-replay");
+  program.add_argument("--trace").help("trace file to replay; a synthetic scan + lookup trace is used if omitted");
+  program.add_argument("--pool-size").help("number of frames in the buffer pool").default_value(std::string("128"));
+  program.add_argument("--length").help("accesses in the synthetic trace").default_value(std::string("200000"));
+  program.add_argument("--seed").help("seed of the synthetic trace").default_value(std::string("0"));
+  program.add_argument("--device").help("simulated device to report the I/O time on: hdd, sata_ssd or nvme");
+  program.add_argument("--no-hints").help("ignore the access types in the trace").default_value(false).implicit_value(
+      true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto pool_size = std::stoul(program.get("--pool-size"));
+  Trace trace;
+  if (program.present("--trace")) {
+    trace = LoadTrace(program.get("--trace"));
+  } else {
+    trace = SyntheticTrace(std::stoul(program.get("--length")), 4 * pool_size, 16 * pool_size, 8 * pool_size,
+                           std::stoull(program.get("--seed")));
+  }
+  if (trace.empty()) {
+    std::cerr << "empty trace" << std::endl;
+    return 1;
+  }
+  page_id_t max_page_id = 0;
+  for (const auto &access : trace) {
+    if (access.first < 0) {
+      std::cerr << "invalid page id in trace: " << access.first << std::endl;
+      return 1;
+    }
+    max_page_id = std::max(max_page_id, access.first);
+  }
+  bool use_hints = !program.get<bool>("--no-hints");
+  bustub::DeviceProfile device;
+  if (program.present("--device")) {
+    bustub::SimulatedDevice simulated_device;
+    if (!bustub::SimulatedDeviceFromString(program.get("--device"), &simulated_device)) {
+      std::cerr << "unknown device: " << program.get("--device") << std::endl;
+      return 1;
+    }
+    device = bustub::DeviceProfile::Of(simulated_device);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("accesses={} pages={} pool_size={} hints={}\n", trace.size(), max_page_id + 1, pool_size, use_hints);
+  for (auto policy : {bustub::ReplacerPolicy::LRU_K, bustub::ReplacerPolicy::LRU, bustub::ReplacerPolicy::ARC,
+                      bustub::ReplacerPolicy::TWO_Q}) {
+    auto [misses, device_time] = Replay(trace, max_page_id, pool_size, policy, use_hints, device);
+    fmt::print("policy={:<6} misses={:<8} hit_ratio={:.4f}", bustub::ReplacerPolicyToString(policy), misses,
+               1.0 - static_cast<double>(misses) / static_cast<double>(trace.size()));
+    if (program.present("--device")) {
+      fmt::print(" io_ms={:.1f}", std::chrono::duration<double, std::milli>(device_time).count());
+    }
+    fmt::print("\n");
+  }
+  fmt::print(">>> END\n");
+  return 0;
+}